@@ -1,3 +1,4 @@
 "glslc.exe" Shader.vert -o Vert.spv
 "glslc.exe" Shader.frag -o Frag.spv
+"glslc.exe" Cull.comp -o Cull.spv
 pause
\ No newline at end of file
@@ -1,2 +1,3 @@
 ./glslc Shader.vert -o Vert.spv
 ./glslc Shader.frag -o Frag.spv
+./glslc Cull.comp -o Cull.spv
@@ -24,7 +24,10 @@ void main()
 	float metallic = metallicRoughness.b * factorsUBO.metallicRoughness.b;
 	float roughness = metallicRoughness.g * factorsUBO.metallicRoughness.g;
 
-	vec3 normal = texture(normalSampler, fragNormalTexCoord).rgb;
+	// Normal maps may be stored as two channels, so Z is always rebuilt from X and Y
+	vec3 normal;
+	normal.xy = texture(normalSampler, fragNormalTexCoord).rg * 2.0 - 1.0;
+	normal.z = sqrt(max(1.0 - dot(normal.xy, normal.xy), 0.0));
 	
 	vec3 gammaCorrected = pow(baseColor.rgb, vec3(1.0 / 2.2));
 	outColor = vec4(gammaCorrected, baseColor.a);
@@ -6,10 +6,24 @@ layout(set = 0, binding = 0) uniform CameraUBO
 	mat4 proj;
 } camUBO;
 
-layout(set = 1, binding = 0) uniform MeshUBO
+// World matrices of every mesh instance
+layout(std430, set = 1, binding = 0) readonly buffer InstanceBuffer
 {
-	mat4 model;
-} meshUBO;
+	mat4 models[];
+} instances;
+
+// Which mesh instance each instance of each draw is, instanced draws start at their own offset
+layout(std430, set = 1, binding = 1) readonly buffer DrawInstances
+{
+	uint indices[];
+} drawInstances;
+
+// Quantized positions are unorm within the primitive bounds, float positions use an identity transform
+layout(push_constant) uniform Dequantization
+{
+	vec4 positionOffset;
+	vec4 positionScale;
+} dequantization;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec2 inBaseColorTexCoord;
@@ -22,7 +36,8 @@ layout(location = 2) out vec2 fragNormalTexCoord;
 
 void main()
 {
-	gl_Position = camUBO.proj * camUBO.view * meshUBO.model * vec4(inPosition, 1.0);
+	vec3 position = dequantization.positionOffset.xyz + inPosition * dequantization.positionScale.xyz;
+	gl_Position = camUBO.proj * camUBO.view * instances.models[drawInstances.indices[gl_InstanceIndex]] * vec4(position, 1.0);
 	fragBaseColorTexCoord = inBaseColorTexCoord;
 	fragMetallicRoughnessTexCoord = inMetallicRoughnessTexCoord;
 	fragNormalTexCoord = inNormalTexCoord;
@@ -1,7 +1,56 @@
+#include <iostream>
+#include <string>
+
 #include <Core/Engine.h>
+#include <Core/EngineSettings.h>
+#include <Core/ModelManager.h>
+#include <Core/Scene.h>
+#include <Core/Camera.h>
+#include <Core/Transform.h>
 
 int main(int argc, char** argv)
 {
-	VulkanRenderer::Engine engine;
+	VulkanRenderer::EngineSettings settings;
+	std::string modelPath;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--headless")
+			settings.headless = true;
+		else if (arg == "--frames" && hasValue)
+			settings.frameCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (arg == "--width" && hasValue)
+			settings.width = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (arg == "--height" && hasValue)
+			settings.height = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (arg == "--output" && hasValue)
+			settings.outputPath = argv[++i];
+		else if (arg == "--sequence")
+			settings.writeImageSequence = true;
+		else if (arg == "--model" && hasValue)
+			modelPath = argv[++i];
+		else if (arg == "--cpu-culling")
+			settings.gpuCulling = false;
+		else
+			std::cerr << "Unknown argument: " << arg << std::endl;
+	}
+
+	VulkanRenderer::Engine engine(settings);
+
+	// Headless runs have no UI to build a scene with, so optionally load one from the command line
+	if (!modelPath.empty())
+	{
+		VulkanRenderer::Scene* scene = engine.GetScene();
+
+		if (engine.GetModelManager()->LoadModel("Model", modelPath))
+			scene->InstantiateModel("Model", VulkanRenderer::Transform());
+
+		VulkanRenderer::Camera* camera = scene->CreateCamera("Camera", glm::vec3(0.0f, 1.0f, 5.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(1.0f), nullptr);
+		scene->SetMainCamera(camera);
+	}
+
 	engine.Run();
-}
\ No newline at end of file
+}
@@ -0,0 +1,252 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include <Core/Engine.h>
+#include <Core/EngineSettings.h>
+#include <Core/FrameTimings.h>
+#include <Core/ModelManager.h>
+#include <Core/Scene.h>
+#include <Core/Camera.h>
+#include <Vulkan/GpuProfiler.h>
+
+#include <StressScene.h>
+
+namespace
+{
+	struct BenchmarkOptions
+	{
+		uint32_t warmupFrames = 30;
+		uint32_t measuredFrames = 300;
+		uint32_t width = 1280;
+		uint32_t height = 720;
+		uint32_t seed = 1;
+
+		std::vector<uint32_t> instanceCounts = {1000, 10000, 100000};
+		std::vector<float> transparentRatios = {0.0f, 0.1f, 0.5f};
+
+		std::string modelPath;
+		std::string outputPath;
+
+		// Cleared by --cpu-culling to measure the CPU culling path on devices that support both
+		bool gpuCulling = true;
+	};
+
+	// One CSV row per phase; GPU phases are only sampled on frames with resolved timestamps
+	struct PhaseSource
+	{
+		const char* name;
+		double (*read)(const VulkanRenderer::FrameTimings& cpu, const VulkanRenderer::GpuTimings* gpu);
+		bool gpu;
+	};
+
+	using VulkanRenderer::FrameTimings;
+	using VulkanRenderer::GpuTimings;
+	using VulkanRenderer::GpuPass;
+
+	const PhaseSource PhaseSources[] =
+	{
+		{"sceneIteration", [](const FrameTimings& cpu, const GpuTimings*) { return cpu.sceneIteration; }, false},
+		{"uniformUpdates", [](const FrameTimings& cpu, const GpuTimings*) { return cpu.uniformUpdates; }, false},
+		{"sorting", [](const FrameTimings& cpu, const GpuTimings*) { return cpu.sorting; }, false},
+		{"commandRecording", [](const FrameTimings& cpu, const GpuTimings*) { return cpu.commandRecording; }, false},
+		{"submitPresent", [](const FrameTimings& cpu, const GpuTimings*) { return cpu.submitPresent; }, false},
+		{"total", [](const FrameTimings& cpu, const GpuTimings*) { return cpu.total; }, false},
+		{"gpuCull", [](const FrameTimings&, const GpuTimings* gpu) { return gpu->passes[static_cast<size_t>(GpuPass::Cull)]; }, true},
+		{"gpuOpaque", [](const FrameTimings&, const GpuTimings* gpu) { return gpu->passes[static_cast<size_t>(GpuPass::Opaque)]; }, true},
+		{"gpuTransparent", [](const FrameTimings&, const GpuTimings* gpu) { return gpu->passes[static_cast<size_t>(GpuPass::Transparent)]; }, true},
+		{"gpuTotal", [](const FrameTimings&, const GpuTimings* gpu) { return gpu->total; }, true}
+	};
+
+	struct PhaseSamples
+	{
+		const PhaseSource* source;
+		std::vector<double> samples;
+	};
+
+	struct FrameSamples
+	{
+		std::vector<PhaseSamples> phases;
+
+		FrameSamples()
+		{
+			for (const PhaseSource& source : PhaseSources)
+				phases.push_back(PhaseSamples{&source, {}});
+		}
+
+		void Add(const FrameTimings& cpu, const GpuTimings* gpu)
+		{
+			// GPU results arrive a few frames late and are missing when timestamps are unsupported
+			bool gpuValid = gpu && gpu->valid;
+
+			for (PhaseSamples& phase : phases)
+			{
+				if (phase.source->gpu && !gpuValid)
+					continue;
+
+				phase.samples.push_back(phase.source->read(cpu, gpu));
+			}
+		}
+	};
+
+	template<typename T>
+	std::vector<T> ParseList(const std::string& list)
+	{
+		std::vector<T> values;
+		std::stringstream stream(list);
+		std::string item;
+		while (std::getline(stream, item, ','))
+		{
+			if (!item.empty())
+				values.push_back(static_cast<T>(std::stod(item)));
+		}
+		return values;
+	}
+
+	// Nearest-rank percentile of an already sorted sample
+	double Percentile(const std::vector<double>& sorted, double percentile)
+	{
+		if (sorted.empty())
+			return 0.0;
+
+		size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * sorted.size()));
+		return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+	}
+
+	void WriteRows(std::ostream& out, const std::string& sceneName, size_t instances, float transparentRatio, FrameSamples& frames)
+	{
+		for (PhaseSamples& phase : frames.phases)
+		{
+			if (phase.samples.empty())
+				continue;
+
+			std::vector<double>& samples = phase.samples;
+
+			double sum = 0.0;
+			for (double sample : samples)
+				sum += sample;
+			std::sort(samples.begin(), samples.end());
+
+			double mean = sum / samples.size();
+			double max = samples.back();
+
+			out << sceneName << ',' << instances << ',' << transparentRatio << ',' << phase.source->name << ','
+				<< Percentile(samples, 50.0) << ',' << Percentile(samples, 95.0) << ',' << Percentile(samples, 99.0) << ','
+				<< max << ',' << mean << '\n';
+		}
+		out.flush();
+	}
+
+	void RunConfiguration(std::ostream& out, const BenchmarkOptions& options, uint32_t instanceCount, float transparentRatio, bool useModel)
+	{
+		VulkanRenderer::EngineSettings settings;
+		settings.headless = true;
+		settings.width = options.width;
+		settings.height = options.height;
+		// Instances share their primitives' descriptor sets, leave headroom for model materials and the camera
+		settings.maxMeshCount = 10000;
+		settings.gpuCulling = options.gpuCulling;
+
+		VulkanRenderer::Engine engine(settings);
+		VulkanRenderer::Scene* scene = engine.GetScene();
+
+		Benchmark::StressSceneSettings sceneSettings;
+		sceneSettings.instanceCount = instanceCount;
+		sceneSettings.transparentRatio = transparentRatio;
+		sceneSettings.seed = options.seed;
+
+		if (useModel)
+		{
+			if (!engine.GetModelManager()->LoadModel("Model", options.modelPath))
+			{
+				std::cerr << "Failed to load benchmark model: " << options.modelPath << std::endl;
+				return;
+			}
+			sceneSettings.modelName = "Model";
+		}
+
+		Benchmark::StressSceneGenerator generator(scene, engine.GetModelManager());
+		size_t instances = generator.Generate(sceneSettings);
+
+		VulkanRenderer::Camera* camera = scene->CreateCamera("BenchmarkCamera", glm::vec3(0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(1.0f), nullptr);
+		scene->SetMainCamera(camera);
+
+		std::cerr << "Running " << (useModel ? "model" : "cubes") << " with " << instances << " instances, transparent ratio " << transparentRatio << std::endl;
+
+		engine.RunFrames(options.warmupFrames);
+
+		VulkanRenderer::VulkanGpuProfiler* gpuProfiler = engine.GetGpuProfiler();
+
+		FrameSamples frames;
+		for (uint32_t i = 0; i < options.measuredFrames; ++i)
+		{
+			engine.RunFrames(1);
+			frames.Add(engine.GetLastFrameTimings(), gpuProfiler ? &gpuProfiler->GetLastTimings() : nullptr);
+		}
+
+		WriteRows(out, useModel ? "model" : "cubes", instances, useModel ? 0.0f : transparentRatio, frames);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	BenchmarkOptions options;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--frames" && hasValue)
+			options.measuredFrames = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (arg == "--warmup" && hasValue)
+			options.warmupFrames = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (arg == "--width" && hasValue)
+			options.width = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (arg == "--height" && hasValue)
+			options.height = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (arg == "--seed" && hasValue)
+			options.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (arg == "--instances" && hasValue)
+			options.instanceCounts = ParseList<uint32_t>(argv[++i]);
+		else if (arg == "--transparency" && hasValue)
+			options.transparentRatios = ParseList<float>(argv[++i]);
+		else if (arg == "--model" && hasValue)
+			options.modelPath = argv[++i];
+		else if (arg == "--output" && hasValue)
+			options.outputPath = argv[++i];
+		else if (arg == "--cpu-culling")
+			options.gpuCulling = false;
+		else
+			std::cerr << "Unknown argument: " << arg << std::endl;
+	}
+
+	std::ofstream file;
+	if (!options.outputPath.empty())
+	{
+		file.open(options.outputPath);
+		if (!file.is_open())
+		{
+			std::cerr << "Failed to open benchmark output: " << options.outputPath << std::endl;
+			return 1;
+		}
+	}
+	std::ostream& out = file.is_open() ? static_cast<std::ostream&>(file) : std::cout;
+
+	out << "scene,instances,transparentRatio,phase,p50Ms,p95Ms,p99Ms,maxMs,meanMs\n";
+
+	for (uint32_t instanceCount : options.instanceCounts)
+	{
+		for (float transparentRatio : options.transparentRatios)
+			RunConfiguration(out, options, instanceCount, transparentRatio, false);
+
+		if (!options.modelPath.empty())
+			RunConfiguration(out, options, instanceCount, 0.0f, true);
+	}
+
+	return 0;
+}
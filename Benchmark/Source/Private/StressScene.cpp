@@ -0,0 +1,129 @@
+#include <StressScene.h>
+
+#include <vector>
+#include <string>
+
+#include <Core/Scene.h>
+#include <Core/ModelManager.h>
+#include <Core/Mesh.h>
+#include <Core/MeshPrimitive.h>
+#include <Core/Vertex.h>
+#include <Core/Transform.h>
+
+using namespace Benchmark;
+using namespace VulkanRenderer;
+
+StressSceneGenerator::StressSceneGenerator(Scene* scene, ModelManager* modelManager)
+	: scene(scene), modelManager(modelManager)
+{
+
+}
+
+size_t StressSceneGenerator::Generate(const StressSceneSettings& settings)
+{
+	// Xorshift never leaves zero, so keep the state non-zero
+	randomState = settings.seed != 0 ? settings.seed : 1;
+
+	size_t created = 0;
+
+	if (!settings.modelName.empty())
+	{
+		size_t firstInstance = scene->GetMeshInstances().size();
+		while (created < settings.instanceCount)
+		{
+			Transform transform(RandomPosition(), RandomRotation(), glm::vec3(1.0f));
+			if (!scene->InstantiateModel(settings.modelName, transform))
+				break;
+
+			size_t previouslyCreated = created;
+			created = scene->GetMeshInstances().size() - firstInstance;
+
+			// Models without meshes would never reach the target
+			if (created == previouslyCreated)
+				break;
+		}
+		return created;
+	}
+
+	std::shared_ptr<Mesh> opaqueMesh = CreateCubeMesh(false);
+	std::shared_ptr<Mesh> transparentMesh = CreateCubeMesh(true);
+
+	for (uint32_t i = 0; i < settings.instanceCount; ++i)
+	{
+		bool transparent = RandomRange(0.0f, 1.0f) < settings.transparentRatio;
+		float scale = RandomRange(0.25f, 1.0f);
+
+		// Unique names keep Scene from probing for a free suffix on every instance
+		scene->CreateMeshInstance("Cube" + std::to_string(i), RandomPosition(), RandomRotation(), glm::vec3(scale), nullptr, transparent ? transparentMesh : opaqueMesh);
+		++created;
+	}
+
+	return created;
+}
+
+uint32_t StressSceneGenerator::NextRandom()
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+float StressSceneGenerator::RandomRange(float min, float max)
+{
+	float unit = static_cast<float>(NextRandom() >> 8) / static_cast<float>(1 << 24);
+	return min + (max - min) * unit;
+}
+
+glm::vec3 StressSceneGenerator::RandomPosition()
+{
+	// Spread everything through the view volume of a camera at the origin looking down -Z
+	return glm::vec3(RandomRange(-40.0f, 40.0f), RandomRange(-20.0f, 20.0f), RandomRange(-90.0f, -5.0f));
+}
+
+glm::quat StressSceneGenerator::RandomRotation()
+{
+	return glm::angleAxis(RandomRange(0.0f, glm::two_pi<float>()), glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+std::shared_ptr<Mesh> StressSceneGenerator::CreateCubeMesh(bool transparent)
+{
+	const glm::vec3 normals[6] =
+	{
+		{1.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f},
+		{0.0f, 1.0f, 0.0f}, {0.0f, -1.0f, 0.0f},
+		{0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}
+	};
+
+	MeshPrimitiveInfo info{};
+
+	for (const glm::vec3& normal : normals)
+	{
+		glm::vec3 up = glm::abs(normal.y) > 0.5f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		glm::vec3 right = glm::cross(up, normal);
+
+		uint32_t firstVertex = static_cast<uint32_t>(info.vertices.size());
+		const glm::vec2 corners[4] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}};
+
+		for (const glm::vec2& corner : corners)
+		{
+			Vertex vertex{};
+			vertex.position = (normal + right * corner.x + up * corner.y) * 0.5f;
+			vertex.baseColorTexCoord = corner * 0.5f + 0.5f;
+			vertex.metallicRoughnessTexCoord = vertex.baseColorTexCoord;
+			vertex.normalTexCoord = vertex.baseColorTexCoord;
+			info.vertices.push_back(vertex);
+		}
+
+		const uint32_t faceIndices[6] = {0, 1, 2, 2, 3, 0};
+		for (uint32_t index : faceIndices)
+			info.indices.push_back(firstVertex + index);
+	}
+
+	info.baseColorFactor = transparent ? glm::vec4(0.2f, 0.6f, 1.0f, 0.5f) : glm::vec4(0.8f, 0.8f, 0.8f, 1.0f);
+	info.metallicFactor = 0.0f;
+	info.roughnessFactor = 1.0f;
+	info.enableTransparency = transparent;
+
+	return modelManager->CreateMesh({info});
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace VulkanRenderer
+{
+	class Scene;
+	class ModelManager;
+	class Mesh;
+}
+
+namespace Benchmark
+{
+	struct StressSceneSettings
+	{
+		uint32_t instanceCount = 1000;
+
+		// Fraction of generated instances that use the transparent pipeline
+		float transparentRatio = 0.0f;
+
+		// Instantiate this loaded model instead of generated cubes when set
+		std::string modelName;
+
+		uint32_t seed = 1;
+	};
+
+	// Builds the same scene for the same settings on every run and platform
+	class StressSceneGenerator
+	{
+	public:
+		StressSceneGenerator(VulkanRenderer::Scene* scene, VulkanRenderer::ModelManager* modelManager);
+
+		// Returns the number of mesh instances created
+		size_t Generate(const StressSceneSettings& settings);
+
+	private:
+		VulkanRenderer::Scene* scene;
+		VulkanRenderer::ModelManager* modelManager;
+
+		uint32_t randomState = 1;
+
+		uint32_t NextRandom();
+		float RandomRange(float min, float max);
+
+		glm::vec3 RandomPosition();
+		glm::quat RandomRotation();
+
+		std::shared_ptr<VulkanRenderer::Mesh> CreateCubeMesh(bool transparent);
+	};
+}
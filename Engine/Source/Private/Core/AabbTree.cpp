@@ -0,0 +1,451 @@
+#include <Core/AabbTree.h>
+
+#include <algorithm>
+
+#include <Core/Frustum.h>
+
+using namespace VulkanRenderer;
+
+// World units leaves are grown by, so objects jittering in place never touch the tree
+static constexpr float LeafMargin = 0.1f;
+
+namespace
+{
+	BoundingBox Union(const BoundingBox& a, const BoundingBox& b)
+	{
+		BoundingBox box = a;
+		box.Expand(b);
+		return box;
+	}
+}
+
+AabbTree::AabbTree()
+{
+
+}
+
+AabbTree::~AabbTree()
+{
+
+}
+
+int32_t AabbTree::CreateProxy(const BoundingBox& box, uint32_t item)
+{
+	int32_t proxy = AllocateNode();
+
+	nodes[proxy].box.min = box.min - glm::vec3(LeafMargin);
+	nodes[proxy].box.max = box.max + glm::vec3(LeafMargin);
+	nodes[proxy].item = item;
+	nodes[proxy].height = 0;
+
+	InsertLeaf(proxy);
+	++proxyCount;
+
+	return proxy;
+}
+
+void AabbTree::DestroyProxy(int32_t proxy)
+{
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+	--proxyCount;
+}
+
+bool AabbTree::MoveProxy(int32_t proxy, const BoundingBox& box)
+{
+	if (nodes[proxy].box.Contains(box))
+		return false;
+
+	RemoveLeaf(proxy);
+
+	nodes[proxy].box.min = box.min - glm::vec3(LeafMargin);
+	nodes[proxy].box.max = box.max + glm::vec3(LeafMargin);
+
+	InsertLeaf(proxy);
+	return true;
+}
+
+uint32_t AabbTree::GetItem(int32_t proxy) const
+{
+	return nodes[proxy].item;
+}
+
+const BoundingBox& AabbTree::GetFatBox(int32_t proxy) const
+{
+	return nodes[proxy].box;
+}
+
+void AabbTree::QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& outItems) const
+{
+	if (root == InvalidProxy)
+		return;
+
+	stack.clear();
+	stack.push_back(root);
+
+	while (!stack.empty())
+	{
+		int32_t index = stack.back();
+		stack.pop_back();
+
+		const Node& node = nodes[index];
+
+		FrustumTest test = frustum.ClassifyBox(node.box);
+		if (test == FrustumTest::Outside)
+			continue;
+
+		// Everything below a contained node is visible, no more plane tests needed
+		if (test == FrustumTest::Inside || node.IsLeaf())
+		{
+			CollectItems(index, outItems);
+			continue;
+		}
+
+		stack.push_back(node.child1);
+		stack.push_back(node.child2);
+	}
+}
+
+void AabbTree::QuerySphere(const glm::vec3& center, float radius, std::vector<uint32_t>& outItems) const
+{
+	if (root == InvalidProxy)
+		return;
+
+	stack.clear();
+	stack.push_back(root);
+
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+
+		if (!node.box.IntersectsSphere(center, radius))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			outItems.push_back(node.item);
+			continue;
+		}
+
+		stack.push_back(node.child1);
+		stack.push_back(node.child2);
+	}
+}
+
+void AabbTree::QueryBox(const BoundingBox& box, std::vector<uint32_t>& outItems) const
+{
+	if (root == InvalidProxy)
+		return;
+
+	stack.clear();
+	stack.push_back(root);
+
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+
+		if (!node.box.Intersects(box))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			outItems.push_back(node.item);
+			continue;
+		}
+
+		stack.push_back(node.child1);
+		stack.push_back(node.child2);
+	}
+}
+
+bool AabbTree::RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, const std::function<float(uint32_t item)>& hitTest, uint32_t& outItem, float& outDistance) const
+{
+	if (root == InvalidProxy)
+		return false;
+
+	glm::vec3 inverseDirection = 1.0f / direction;
+
+	float closest = maxDistance;
+	bool hit = false;
+
+	float entry;
+	if (!nodes[root].box.IntersectsRay(origin, inverseDirection, closest, entry))
+		return false;
+
+	stack.clear();
+	stack.push_back(root);
+
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+
+		// A hit found since this node was pushed may already be nearer than the whole node
+		if (!node.box.IntersectsRay(origin, inverseDirection, closest, entry))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			float distance = hitTest(node.item);
+			if (distance >= 0.0f && distance <= closest)
+			{
+				closest = distance;
+				outItem = node.item;
+				hit = true;
+			}
+			continue;
+		}
+
+		float entry1, entry2;
+		bool hit1 = nodes[node.child1].box.IntersectsRay(origin, inverseDirection, closest, entry1);
+		bool hit2 = nodes[node.child2].box.IntersectsRay(origin, inverseDirection, closest, entry2);
+
+		// The nearer child goes on top so its hits can prune the farther one
+		if (hit1 && hit2)
+		{
+			stack.push_back(entry1 <= entry2 ? node.child2 : node.child1);
+			stack.push_back(entry1 <= entry2 ? node.child1 : node.child2);
+		}
+		else if (hit1)
+		{
+			stack.push_back(node.child1);
+		}
+		else if (hit2)
+		{
+			stack.push_back(node.child2);
+		}
+	}
+
+	if (hit)
+		outDistance = closest;
+
+	return hit;
+}
+
+size_t AabbTree::GetProxyCount() const
+{
+	return proxyCount;
+}
+
+int32_t AabbTree::GetHeight() const
+{
+	return root == InvalidProxy ? 0 : nodes[root].height;
+}
+
+void AabbTree::CollectItems(int32_t node, std::vector<uint32_t>& outItems) const
+{
+	if (nodes[node].IsLeaf())
+	{
+		outItems.push_back(nodes[node].item);
+		return;
+	}
+
+	CollectItems(nodes[node].child1, outItems);
+	CollectItems(nodes[node].child2, outItems);
+}
+
+int32_t AabbTree::AllocateNode()
+{
+	if (freeList == InvalidProxy)
+	{
+		nodes.emplace_back();
+		return static_cast<int32_t>(nodes.size() - 1);
+	}
+
+	int32_t node = freeList;
+	freeList = nodes[node].parent;
+
+	nodes[node] = Node();
+	return node;
+}
+
+void AabbTree::FreeNode(int32_t node)
+{
+	nodes[node].parent = freeList;
+	nodes[node].height = -1;
+	freeList = node;
+}
+
+void AabbTree::InsertLeaf(int32_t leaf)
+{
+	if (root == InvalidProxy)
+	{
+		root = leaf;
+		nodes[root].parent = InvalidProxy;
+		return;
+	}
+
+	// Walk down towards the sibling with the lowest surface area heuristic cost
+	BoundingBox leafBox = nodes[leaf].box;
+	int32_t index = root;
+
+	while (!nodes[index].IsLeaf())
+	{
+		const Node& node = nodes[index];
+
+		float area = node.box.GetSurfaceArea();
+		float combinedArea = Union(node.box, leafBox).GetSurfaceArea();
+
+		// Pairing with this node makes a new parent, descending means every node on the way grows
+		float cost = 2.0f * combinedArea;
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		auto descendCost = [&](int32_t child)
+			{
+				float childArea = Union(nodes[child].box, leafBox).GetSurfaceArea();
+				if (!nodes[child].IsLeaf())
+					childArea -= nodes[child].box.GetSurfaceArea();
+
+				return childArea + inheritanceCost;
+			};
+
+		float cost1 = descendCost(node.child1);
+		float cost2 = descendCost(node.child2);
+
+		if (cost < cost1 && cost < cost2)
+			break;
+
+		index = cost1 < cost2 ? node.child1 : node.child2;
+	}
+
+	int32_t sibling = index;
+	int32_t oldParent = nodes[sibling].parent;
+
+	int32_t newParent = AllocateNode();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].box = Union(leafBox, nodes[sibling].box);
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].child1 = sibling;
+	nodes[newParent].child2 = leaf;
+
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent == InvalidProxy)
+	{
+		root = newParent;
+	}
+	else if (nodes[oldParent].child1 == sibling)
+	{
+		nodes[oldParent].child1 = newParent;
+	}
+	else
+	{
+		nodes[oldParent].child2 = newParent;
+	}
+
+	// Refit and rebalance back up to the root
+	for (index = nodes[leaf].parent; index != InvalidProxy; index = nodes[index].parent)
+	{
+		index = Balance(index);
+
+		Node& node = nodes[index];
+		node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+		node.box = Union(nodes[node.child1].box, nodes[node.child2].box);
+	}
+}
+
+void AabbTree::RemoveLeaf(int32_t leaf)
+{
+	if (leaf == root)
+	{
+		root = InvalidProxy;
+		return;
+	}
+
+	int32_t parent = nodes[leaf].parent;
+	int32_t grandParent = nodes[parent].parent;
+	int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+	FreeNode(parent);
+
+	if (grandParent == InvalidProxy)
+	{
+		root = sibling;
+		nodes[sibling].parent = InvalidProxy;
+		return;
+	}
+
+	// The sibling takes the parent's place
+	if (nodes[grandParent].child1 == parent)
+		nodes[grandParent].child1 = sibling;
+	else
+		nodes[grandParent].child2 = sibling;
+
+	nodes[sibling].parent = grandParent;
+
+	for (int32_t index = grandParent; index != InvalidProxy; index = nodes[index].parent)
+	{
+		index = Balance(index);
+
+		Node& node = nodes[index];
+		node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+		node.box = Union(nodes[node.child1].box, nodes[node.child2].box);
+	}
+}
+
+int32_t AabbTree::Balance(int32_t indexA)
+{
+	Node& a = nodes[indexA];
+	if (a.IsLeaf() || a.height < 2)
+		return indexA;
+
+	int32_t indexB = a.child1;
+	int32_t indexC = a.child2;
+	Node& b = nodes[indexB];
+	Node& c = nodes[indexC];
+
+	int32_t balance = c.height - b.height;
+
+	// Promote the taller child, A becomes its first child and keeps the shorter of its grandchildren
+	auto rotate = [&](int32_t indexUp, Node& up, Node& other, bool upIsChild1)
+		{
+			int32_t indexF = up.child1;
+			int32_t indexG = up.child2;
+			Node& f = nodes[indexF];
+			Node& g = nodes[indexG];
+
+			up.child1 = indexA;
+			up.parent = a.parent;
+			a.parent = indexUp;
+
+			if (up.parent == InvalidProxy)
+				root = indexUp;
+			else if (nodes[up.parent].child1 == indexA)
+				nodes[up.parent].child1 = indexUp;
+			else
+				nodes[up.parent].child2 = indexUp;
+
+			int32_t indexKeep = f.height > g.height ? indexF : indexG;
+			int32_t indexMove = f.height > g.height ? indexG : indexF;
+
+			up.child2 = indexKeep;
+			if (upIsChild1)
+				a.child1 = indexMove;
+			else
+				a.child2 = indexMove;
+			nodes[indexMove].parent = indexA;
+
+			a.box = Union(other.box, nodes[indexMove].box);
+			up.box = Union(a.box, nodes[indexKeep].box);
+
+			a.height = 1 + std::max(other.height, nodes[indexMove].height);
+			up.height = 1 + std::max(a.height, nodes[indexKeep].height);
+		};
+
+	if (balance > 1)
+	{
+		rotate(indexC, c, b, false);
+		return indexC;
+	}
+
+	if (balance < -1)
+	{
+		rotate(indexB, b, c, true);
+		return indexB;
+	}
+
+	return indexA;
+}
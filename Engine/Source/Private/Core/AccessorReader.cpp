@@ -0,0 +1,415 @@
+#include <Core/AccessorReader.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+#include <fastgltf/tools.hpp>
+
+#include <Core/GltfFile.h>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define ACCESSOR_READER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+using namespace VulkanRenderer;
+
+namespace
+{
+	// Vertices converted per step, small enough for every attribute's scratch to stay in L1
+	constexpr size_t BlockSize = 256;
+
+	// Bytes of an accessor read straight out of its buffer view
+	struct AccessorView
+	{
+		const uint8_t* data = nullptr;
+		size_t stride = 0;
+		size_t elementSize = 0;
+	};
+
+	// Fails for sparse accessors and ones without a buffer view, those go through fastgltf instead
+	bool GetAccessorView(const GltfFile& file, const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, AccessorView& outView)
+	{
+		if (accessor.sparse.has_value() || !accessor.bufferViewIndex.has_value() || accessor.count == 0)
+			return false;
+
+		fastgltf::span<const std::byte> viewData = file.GetBufferViewData(asset, accessor.bufferViewIndex.value());
+		const fastgltf::BufferView& bufferView = asset.bufferViews[accessor.bufferViewIndex.value()];
+
+		outView.elementSize = fastgltf::getElementByteSize(accessor.type, accessor.componentType);
+		outView.stride = bufferView.byteStride.value_or(outView.elementSize);
+
+		if (accessor.byteOffset + (accessor.count - 1) * outView.stride + outView.elementSize > viewData.size())
+			return false;
+
+		outView.data = reinterpret_cast<const uint8_t*>(viewData.data()) + accessor.byteOffset;
+		return true;
+	}
+
+	float GetComponentScale(fastgltf::ComponentType componentType, bool normalized)
+	{
+		if (!normalized)
+			return 1.0f;
+
+		switch (componentType)
+		{
+		case fastgltf::ComponentType::Byte:
+			return 1.0f / 127.0f;
+		case fastgltf::ComponentType::UnsignedByte:
+			return 1.0f / 255.0f;
+		case fastgltf::ComponentType::Short:
+			return 1.0f / 32767.0f;
+		case fastgltf::ComponentType::UnsignedShort:
+			return 1.0f / 65535.0f;
+		default:
+			return 1.0f;
+		}
+	}
+
+	template<typename T>
+	void ConvertScalar(const uint8_t* src, size_t count, float scale, float minimum, float* dst)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			T value;
+			memcpy(&value, src + i * sizeof(T), sizeof(T));
+			dst[i] = std::max(static_cast<float>(value) * scale, minimum);
+		}
+	}
+
+#ifdef ACCESSOR_READER_SSE2
+	void Store(__m128i values, __m128 scale, __m128 minimum, float* dst)
+	{
+		_mm_storeu_ps(dst, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(values), scale), minimum));
+	}
+
+	// Each kernel widens a register of components to 32-bit lanes, converts and returns how many it consumed
+	size_t ConvertUnsignedBytes(const uint8_t* src, size_t count, __m128 scale, __m128 minimum, float* dst)
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16)
+		{
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			__m128i low = _mm_unpacklo_epi8(bytes, zero);
+			__m128i high = _mm_unpackhi_epi8(bytes, zero);
+
+			Store(_mm_unpacklo_epi16(low, zero), scale, minimum, dst + i);
+			Store(_mm_unpackhi_epi16(low, zero), scale, minimum, dst + i + 4);
+			Store(_mm_unpacklo_epi16(high, zero), scale, minimum, dst + i + 8);
+			Store(_mm_unpackhi_epi16(high, zero), scale, minimum, dst + i + 12);
+		}
+
+		return i;
+	}
+
+	size_t ConvertBytes(const uint8_t* src, size_t count, __m128 scale, __m128 minimum, float* dst)
+	{
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16)
+		{
+			// Duplicating each byte into both halves of a lane and shifting back down sign extends it
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			__m128i low = _mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8);
+			__m128i high = _mm_srai_epi16(_mm_unpackhi_epi8(bytes, bytes), 8);
+
+			Store(_mm_srai_epi32(_mm_unpacklo_epi16(low, low), 16), scale, minimum, dst + i);
+			Store(_mm_srai_epi32(_mm_unpackhi_epi16(low, low), 16), scale, minimum, dst + i + 4);
+			Store(_mm_srai_epi32(_mm_unpacklo_epi16(high, high), 16), scale, minimum, dst + i + 8);
+			Store(_mm_srai_epi32(_mm_unpackhi_epi16(high, high), 16), scale, minimum, dst + i + 12);
+		}
+
+		return i;
+	}
+
+	size_t ConvertUnsignedShorts(const uint8_t* src, size_t count, __m128 scale, __m128 minimum, float* dst)
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i shorts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+
+			Store(_mm_unpacklo_epi16(shorts, zero), scale, minimum, dst + i);
+			Store(_mm_unpackhi_epi16(shorts, zero), scale, minimum, dst + i + 4);
+		}
+
+		return i;
+	}
+
+	size_t ConvertShorts(const uint8_t* src, size_t count, __m128 scale, __m128 minimum, float* dst)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i shorts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+
+			Store(_mm_srai_epi32(_mm_unpacklo_epi16(shorts, shorts), 16), scale, minimum, dst + i);
+			Store(_mm_srai_epi32(_mm_unpackhi_epi16(shorts, shorts), 16), scale, minimum, dst + i + 4);
+		}
+
+		return i;
+	}
+
+	size_t WidenUnsignedShorts(const uint8_t* src, size_t count, uint32_t* dst)
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i shorts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(shorts, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(shorts, zero));
+		}
+
+		return i;
+	}
+
+	size_t WidenUnsignedBytes(const uint8_t* src, size_t count, uint32_t* dst)
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16)
+		{
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			__m128i low = _mm_unpacklo_epi8(bytes, zero);
+			__m128i high = _mm_unpackhi_epi8(bytes, zero);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(low, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(low, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpacklo_epi16(high, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 12), _mm_unpackhi_epi16(high, zero));
+		}
+
+		return i;
+	}
+#endif
+
+	// Per element reads through fastgltf for accessors GetAccessorView can't map
+	template<typename ElementType>
+	void ReadWithFastgltf(const GltfFile& file, const fastgltf::Asset& asset, const VertexAttributeTarget& target, size_t count, uint8_t* outData, size_t stride)
+	{
+		fastgltf::iterateAccessorWithIndex<ElementType>(asset, *target.accessor, [&](const ElementType& element, std::size_t index)
+			{
+				if (index < count)
+					memcpy(outData + index * stride + target.offset, element.data(), target.componentCount * sizeof(float));
+			}, file.GetBufferDataAdapter());
+	}
+}
+
+void VulkanRenderer::ConvertComponents(const void* src, fastgltf::ComponentType componentType, bool normalized, size_t count, float* dst)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(src);
+
+	float scale = GetComponentScale(componentType, normalized);
+
+	// Signed normalized values have two encodings of -1, the spec clamps the lower one
+	float minimum = normalized && (componentType == fastgltf::ComponentType::Byte || componentType == fastgltf::ComponentType::Short) ? -1.0f : -FLT_MAX;
+
+	size_t converted = 0;
+
+#ifdef ACCESSOR_READER_SSE2
+	__m128 scaleVector = _mm_set1_ps(scale);
+	__m128 minimumVector = _mm_set1_ps(minimum);
+
+	switch (componentType)
+	{
+	case fastgltf::ComponentType::UnsignedByte:
+		converted = ConvertUnsignedBytes(bytes, count, scaleVector, minimumVector, dst);
+		break;
+	case fastgltf::ComponentType::Byte:
+		converted = ConvertBytes(bytes, count, scaleVector, minimumVector, dst);
+		break;
+	case fastgltf::ComponentType::UnsignedShort:
+		converted = ConvertUnsignedShorts(bytes, count, scaleVector, minimumVector, dst);
+		break;
+	case fastgltf::ComponentType::Short:
+		converted = ConvertShorts(bytes, count, scaleVector, minimumVector, dst);
+		break;
+	default:
+		break;
+	}
+#endif
+
+	size_t componentSize = fastgltf::getComponentByteSize(componentType);
+	const uint8_t* tail = bytes + converted * componentSize;
+	size_t remaining = count - converted;
+	float* tailDst = dst + converted;
+
+	switch (componentType)
+	{
+	case fastgltf::ComponentType::Float:
+		memcpy(tailDst, tail, remaining * sizeof(float));
+		break;
+	case fastgltf::ComponentType::UnsignedByte:
+		ConvertScalar<uint8_t>(tail, remaining, scale, minimum, tailDst);
+		break;
+	case fastgltf::ComponentType::Byte:
+		ConvertScalar<int8_t>(tail, remaining, scale, minimum, tailDst);
+		break;
+	case fastgltf::ComponentType::UnsignedShort:
+		ConvertScalar<uint16_t>(tail, remaining, scale, minimum, tailDst);
+		break;
+	case fastgltf::ComponentType::Short:
+		ConvertScalar<int16_t>(tail, remaining, scale, minimum, tailDst);
+		break;
+	case fastgltf::ComponentType::UnsignedInt:
+		ConvertScalar<uint32_t>(tail, remaining, scale, minimum, tailDst);
+		break;
+	case fastgltf::ComponentType::Int:
+		ConvertScalar<int32_t>(tail, remaining, scale, minimum, tailDst);
+		break;
+	default:
+		std::fill(tailDst, tailDst + remaining, 0.0f);
+		break;
+	}
+}
+
+void VulkanRenderer::ReadVertexAttributes(const GltfFile& file, const fastgltf::Asset& asset, const std::vector<VertexAttributeTarget>& targets, size_t count, void* outData, size_t stride)
+{
+	uint8_t* output = static_cast<uint8_t*>(outData);
+
+	struct Stream
+	{
+		const VertexAttributeTarget* target = nullptr;
+		AccessorView view;
+		size_t count = 0;
+
+		// Whole blocks convert in one call when components are packed back to back and all of them are used
+		bool packed = false;
+		// Float components are copied straight from the source without a scratch pass
+		bool direct = false;
+
+		std::vector<float> scratch;
+	};
+
+	std::vector<Stream> streams;
+	streams.reserve(targets.size());
+
+	for (const VertexAttributeTarget& target : targets)
+	{
+		const fastgltf::Accessor& accessor = *target.accessor;
+		size_t accessorComponents = fastgltf::getNumComponents(accessor.type);
+
+		AccessorView view;
+		if (accessorComponents >= target.componentCount && GetAccessorView(file, asset, accessor, view))
+		{
+			Stream stream;
+			stream.target = &target;
+			stream.view = view;
+			stream.count = std::min(count, accessor.count);
+			stream.direct = accessor.componentType == fastgltf::ComponentType::Float;
+			stream.packed = view.stride == view.elementSize && accessorComponents == target.componentCount;
+			if (!stream.direct)
+				stream.scratch.resize(BlockSize * target.componentCount);
+
+			streams.push_back(std::move(stream));
+			continue;
+		}
+
+		switch (target.componentCount)
+		{
+		case 2:
+			ReadWithFastgltf<fastgltf::math::fvec2>(file, asset, target, count, output, stride);
+			break;
+		case 3:
+			ReadWithFastgltf<fastgltf::math::fvec3>(file, asset, target, count, output, stride);
+			break;
+		case 4:
+			ReadWithFastgltf<fastgltf::math::fvec4>(file, asset, target, count, output, stride);
+			break;
+		default:
+			break;
+		}
+	}
+
+	for (size_t blockStart = 0; blockStart < count; blockStart += BlockSize)
+	{
+		size_t blockCount = std::min(BlockSize, count - blockStart);
+
+		for (Stream& stream : streams)
+		{
+			if (stream.direct || blockStart >= stream.count)
+				continue;
+
+			const fastgltf::Accessor& accessor = *stream.target->accessor;
+			uint32_t components = stream.target->componentCount;
+			size_t streamCount = std::min(blockCount, stream.count - blockStart);
+			const uint8_t* source = stream.view.data + blockStart * stream.view.stride;
+
+			if (stream.packed)
+			{
+				ConvertComponents(source, accessor.componentType, accessor.normalized, streamCount * components, stream.scratch.data());
+			}
+			else
+			{
+				for (size_t i = 0; i < streamCount; i++)
+					ConvertComponents(source + i * stream.view.stride, accessor.componentType, accessor.normalized, components, stream.scratch.data() + i * components);
+			}
+		}
+
+		// Every attribute of a vertex is written before moving on, so each destination line is touched once
+		for (size_t i = 0; i < blockCount; i++)
+		{
+			size_t index = blockStart + i;
+			uint8_t* element = output + index * stride;
+
+			for (const Stream& stream : streams)
+			{
+				if (index >= stream.count)
+					continue;
+
+				size_t size = stream.target->componentCount * sizeof(float);
+				const void* source = stream.direct ? static_cast<const void*>(stream.view.data + index * stream.view.stride) : static_cast<const void*>(stream.scratch.data() + i * stream.target->componentCount);
+
+				memcpy(element + stream.target->offset, source, size);
+			}
+		}
+	}
+}
+
+void VulkanRenderer::ReadIndices(const GltfFile& file, const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, uint32_t* outIndices)
+{
+	AccessorView view;
+	if (!GetAccessorView(file, asset, accessor, view) || view.stride != view.elementSize)
+	{
+		fastgltf::copyFromAccessor<std::uint32_t>(asset, accessor, outIndices, file.GetBufferDataAdapter());
+		return;
+	}
+
+	size_t widened = 0;
+
+	switch (accessor.componentType)
+	{
+	case fastgltf::ComponentType::UnsignedInt:
+		memcpy(outIndices, view.data, accessor.count * sizeof(uint32_t));
+		return;
+	case fastgltf::ComponentType::UnsignedShort:
+#ifdef ACCESSOR_READER_SSE2
+		widened = WidenUnsignedShorts(view.data, accessor.count, outIndices);
+#endif
+		for (size_t i = widened; i < accessor.count; i++)
+		{
+			uint16_t index;
+			memcpy(&index, view.data + i * sizeof(uint16_t), sizeof(index));
+			outIndices[i] = index;
+		}
+		return;
+	case fastgltf::ComponentType::UnsignedByte:
+#ifdef ACCESSOR_READER_SSE2
+		widened = WidenUnsignedBytes(view.data, accessor.count, outIndices);
+#endif
+		for (size_t i = widened; i < accessor.count; i++)
+			outIndices[i] = view.data[i];
+		return;
+	default:
+		fastgltf::copyFromAccessor<std::uint32_t>(asset, accessor, outIndices, file.GetBufferDataAdapter());
+		return;
+	}
+}
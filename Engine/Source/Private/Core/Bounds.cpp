@@ -0,0 +1,142 @@
+#include <Core/Bounds.h>
+
+#include <cmath>
+#include <algorithm>
+
+using namespace VulkanRenderer;
+
+bool BoundingBox::IsValid() const
+{
+	return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+}
+
+void BoundingBox::Expand(const glm::vec3& point)
+{
+	min = glm::min(min, point);
+	max = glm::max(max, point);
+}
+
+void BoundingBox::Expand(const BoundingBox& box)
+{
+	min = glm::min(min, box.min);
+	max = glm::max(max, box.max);
+}
+
+glm::vec3 BoundingBox::GetCenter() const
+{
+	return (min + max) * 0.5f;
+}
+
+glm::vec3 BoundingBox::GetExtents() const
+{
+	return (max - min) * 0.5f;
+}
+
+float BoundingBox::GetSurfaceArea() const
+{
+	glm::vec3 size = max - min;
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+bool BoundingBox::Contains(const BoundingBox& box) const
+{
+	return min.x <= box.min.x && min.y <= box.min.y && min.z <= box.min.z && max.x >= box.max.x && max.y >= box.max.y && max.z >= box.max.z;
+}
+
+bool BoundingBox::Intersects(const BoundingBox& box) const
+{
+	return min.x <= box.max.x && min.y <= box.max.y && min.z <= box.max.z && max.x >= box.min.x && max.y >= box.min.y && max.z >= box.min.z;
+}
+
+bool BoundingBox::IntersectsSphere(const glm::vec3& center, float radius) const
+{
+	glm::vec3 offset = center - glm::clamp(center, min, max);
+	return glm::dot(offset, offset) <= radius * radius;
+}
+
+bool BoundingBox::IntersectsRay(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, float& outDistance) const
+{
+	glm::vec3 t0 = (min - origin) * inverseDirection;
+	glm::vec3 t1 = (max - origin) * inverseDirection;
+
+	glm::vec3 tNear = glm::min(t0, t1);
+	glm::vec3 tFar = glm::max(t0, t1);
+
+	float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+	float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+
+	if (enter > exit)
+		return false;
+
+	outDistance = enter;
+	return true;
+}
+
+BoundingBox BoundingBox::Transformed(const glm::mat4& matrix) const
+{
+	if (!IsValid())
+		return *this;
+
+	// Transforming center and extents avoids touching all eight corners
+	glm::vec3 center = glm::vec3(matrix * glm::vec4(GetCenter(), 1.0f));
+	glm::vec3 extents = GetExtents();
+
+	glm::vec3 transformedExtents;
+	for (int row = 0; row < 3; row++)
+	{
+		transformedExtents[row] = std::abs(matrix[0][row]) * extents.x + std::abs(matrix[1][row]) * extents.y + std::abs(matrix[2][row]) * extents.z;
+	}
+
+	BoundingBox box;
+	box.min = center - transformedExtents;
+	box.max = center + transformedExtents;
+	return box;
+}
+
+bool BoundingSphere::IsValid() const
+{
+	return radius >= 0.0f;
+}
+
+BoundingSphere BoundingSphere::Transformed(const glm::mat4& matrix) const
+{
+	if (!IsValid())
+		return *this;
+
+	float scaleX = glm::dot(glm::vec3(matrix[0]), glm::vec3(matrix[0]));
+	float scaleY = glm::dot(glm::vec3(matrix[1]), glm::vec3(matrix[1]));
+	float scaleZ = glm::dot(glm::vec3(matrix[2]), glm::vec3(matrix[2]));
+
+	BoundingSphere sphere;
+	sphere.center = glm::vec3(matrix * glm::vec4(center, 1.0f));
+	sphere.radius = radius * std::sqrt(std::max(scaleX, std::max(scaleY, scaleZ)));
+	return sphere;
+}
+
+BoundingBox VulkanRenderer::ComputeBounds(const std::vector<Vertex>& vertices)
+{
+	BoundingBox bounds;
+	for (const Vertex& vertex : vertices)
+		bounds.Expand(vertex.position);
+
+	return bounds;
+}
+
+BoundingSphere VulkanRenderer::ComputeBoundingSphere(const std::vector<Vertex>& vertices, const BoundingBox& bounds)
+{
+	BoundingSphere sphere;
+	if (!bounds.IsValid())
+		return sphere;
+
+	sphere.center = bounds.GetCenter();
+
+	float radiusSquared = 0.0f;
+	for (const Vertex& vertex : vertices)
+	{
+		glm::vec3 offset = vertex.position - sphere.center;
+		radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+	}
+
+	sphere.radius = std::sqrt(radiusSquared);
+	return sphere;
+}
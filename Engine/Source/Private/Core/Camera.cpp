@@ -75,13 +75,30 @@ void Camera::UpdateUniformBuffer(uint32_t currentImage, VkExtent2D swapChainExte
 {
 	CameraUBO ubo{};
 
-	glm::mat4 translation = glm::translate(glm::mat4(1.0f), transform.position);
-	glm::mat4 rotation = glm::mat4_cast(transform.rotation);
-	glm::mat4 world = translation * rotation;
-
-	ubo.view = glm::inverse(world);
-	ubo.proj = glm::perspective(glm::radians(fov), (float)swapChainExtent.width / (float)swapChainExtent.height, 0.01f, 100.0f);
-	ubo.proj[1][1] *= -1;
+	ubo.view = GetViewMatrix();
+	ubo.proj = GetProjectionMatrix(swapChainExtent);
 	
 	memcpy(uniformBuffers[currentImage].GetMappedData(), &ubo, sizeof(ubo));
+}
+
+glm::mat4 Camera::GetViewMatrix() const
+{
+	glm::mat4 translation = glm::translate(glm::mat4(1.0f), transform.GetPosition());
+	glm::mat4 rotation = glm::mat4_cast(transform.GetRotation());
+	glm::mat4 world = translation * rotation;
+
+	return glm::inverse(world);
+}
+
+glm::mat4 Camera::GetProjectionMatrix(VkExtent2D swapChainExtent) const
+{
+	glm::mat4 proj = glm::perspective(glm::radians(fov), (float)swapChainExtent.width / (float)swapChainExtent.height, 0.01f, 100.0f);
+	proj[1][1] *= -1;
+
+	return proj;
+}
+
+Frustum Camera::GetFrustum(VkExtent2D swapChainExtent) const
+{
+	return Frustum::FromMatrix(GetProjectionMatrix(swapChainExtent) * GetViewMatrix());
 }
\ No newline at end of file
@@ -2,6 +2,9 @@
 
 #include <iostream>
 #include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
 
 #include <volk.h>
 
@@ -10,23 +13,38 @@
 #include <Core/GlfwWindow.h>
 #include <Vulkan/Instance.h>
 #include <Vulkan/SwapChain.h>
+#include <Vulkan/OffscreenTarget.h>
 #include <Vulkan/RenderPass.h>
 #include <Vulkan/DescriptorSetLayoutManager.h>
 #include <Vulkan/Pipeline.h>
 #include <Vulkan/DescriptorPool.h>
+#include <Vulkan/GeometryArena.h>
 #include <Vulkan/Sync.h>
+#include <Vulkan/GpuProfiler.h>
+#include <Vulkan/GpuCulling.h>
+#include <Vulkan/InstanceBuffer.h>
 #include <Core/ModelManager.h>
+#include <Core/TextureStreamer.h>
 #include <Core/MeshInstance.h>
 #include <Core/MeshPrimitive.h>
 #include <Core/Mesh.h>
 #include <Core/Camera.h>
+#include <Core/Frustum.h>
 #include <Core/Scene.h>
 #include <Core/Vertex.h>
 #include <Core/Transform.h>
+#include <Core/ImageWriter.h>
 #include <Vulkan/ImGuiOverlay.h>
 
 using namespace VulkanRenderer;
 
+using FrameClock = std::chrono::steady_clock;
+
+inline double ElapsedMilliseconds(FrameClock::time_point start, FrameClock::time_point end)
+{
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
 inline float Wrap180(float angle)
 {
 	angle = std::fmod(angle + 180.0f, 360.0f);
@@ -51,35 +69,60 @@ inline glm::vec3 RoundEulerDP(const glm::vec3& angles, int dp)
 	return glm::vec3(RoundDP(angles.x, dp), RoundDP(angles.y, dp), RoundDP(angles.z, dp));
 }
 
-Engine::Engine()
+Engine::Engine(const EngineSettings& settings)
+	: settings(settings)
 {
 	if (volkInitialize() != VK_SUCCESS)
 	{
 		std::cerr << "Failed to initialize Volk" << std::endl;
 	}
 
-	glfwWindow = std::make_unique<GlfwWindow>(this);
-	instance = std::make_unique<VulkanInstance>(glfwWindow->Get());
-	device = std::make_unique<VulkanDevice>(instance->Get(), instance->GetSurface());
-	swapChain = std::make_unique<VulkanSwapChain>(device.get(), instance->GetSurface(), glfwWindow->Get());
-	renderPass = std::make_unique<VulkanRenderPass>(device.get(), swapChain.get());
-	swapChain->CreateFramebuffers(renderPass->Get());
+	if (settings.headless)
+	{
+		instance = std::make_unique<VulkanInstance>(nullptr);
+		device = std::make_unique<VulkanDevice>(instance->Get(), VK_NULL_HANDLE);
+		offscreenTarget = std::make_unique<VulkanOffscreenTarget>(device.get(), VkExtent2D{settings.width, settings.height});
+		renderPass = std::make_unique<VulkanRenderPass>(device.get(), offscreenTarget->imageFormat, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+		offscreenTarget->CreateFramebuffer(renderPass->Get());
+	}
+	else
+	{
+		glfwWindow = std::make_unique<GlfwWindow>(this, static_cast<int>(settings.width), static_cast<int>(settings.height));
+		instance = std::make_unique<VulkanInstance>(glfwWindow->Get());
+		device = std::make_unique<VulkanDevice>(instance->Get(), instance->GetSurface());
+		swapChain = std::make_unique<VulkanSwapChain>(device.get(), instance->GetSurface(), glfwWindow->Get());
+		renderPass = std::make_unique<VulkanRenderPass>(device.get(), swapChain->imageFormat, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		swapChain->CreateFramebuffers(renderPass->Get());
+	}
+
 	descriptorSetLayoutManager = std::make_unique<VulkanDescriptorSetLayoutManager>(device.get());
 	opaquePipeline = std::make_unique<VulkanPipeline>(device.get(), renderPass.get(), descriptorSetLayoutManager.get(), PipelineType::Opaque);
 	transparentPipeline = std::make_unique<VulkanPipeline>(device.get(), renderPass.get(), descriptorSetLayoutManager.get(), PipelineType::Transparent);
 
-	descriptorPool = std::make_unique<VulkanDescriptorPool>(device.get(), 1000);
+	descriptorPool = std::make_unique<VulkanDescriptorPool>(device.get(), settings.maxMeshCount);
 
-	modelManager = std::make_unique<ModelManager>(device.get(), descriptorSetLayoutManager->GetMeshDescriptorSetLayout(), descriptorSetLayoutManager->GetMaterialDescriptorSetLayout(), descriptorPool->Get());
+	geometryArena = std::make_unique<VulkanGeometryArena>(device.get());
+
+	modelManager = std::make_unique<ModelManager>(device.get(), geometryArena.get(), descriptorSetLayoutManager->GetMaterialDescriptorSetLayout(), descriptorPool->Get());
+	modelManager->SetCacheDirectory(settings.modelCacheDirectory);
+	modelManager->SetTextureCompression(settings.compressTextures);
+	modelManager->SetTextureStreaming(settings.streamTextures, settings.textureStreamingBudget);
 
 	opaquePipeline->SetDescriptorPool(descriptorPool->Get());
 	transparentPipeline->SetDescriptorPool(descriptorPool->Get());
 	
 	sync = std::make_unique<VulkanSync>(device->GetLogical());
+
+	gpuProfiler = std::make_unique<VulkanGpuProfiler>(device.get());
+
+	if (settings.gpuCulling && device->SupportsDrawIndirectFirstInstance())
+		gpuCulling = std::make_unique<VulkanGpuCulling>(device.get(), descriptorSetLayoutManager->GetInstanceDescriptorSetLayout(), descriptorPool->Get());
 	
-	scene = std::make_unique<Scene>(device.get(), modelManager.get(), descriptorSetLayoutManager->GetCameraDescriptorSetLayout(), descriptorPool->Get());
+	scene = std::make_unique<Scene>(device.get(), modelManager.get(), descriptorSetLayoutManager->GetCameraDescriptorSetLayout(), descriptorSetLayoutManager->GetInstanceDescriptorSetLayout(), descriptorPool->Get());
 	
-	imGuiOverlay = std::make_unique<VulkanImGuiOverlay>(instance.get(), device.get(), swapChain.get(), renderPass.get(), glfwWindow->Get(), scene.get(), modelManager.get());
+	// The overlay needs a window for input, so headless runs draw the scene only
+	if (!settings.headless)
+		imGuiOverlay = std::make_unique<VulkanImGuiOverlay>(instance.get(), device.get(), swapChain.get(), renderPass.get(), glfwWindow->Get(), scene.get(), modelManager.get(), gpuProfiler.get());
 }
 
 Engine::~Engine()
@@ -94,6 +137,12 @@ void Engine::FramebufferResized()
 
 void Engine::Run()
 {
+	if (settings.headless)
+	{
+		RunFrames(settings.frameCount);
+		return;
+	}
+
 	while (!glfwWindowShouldClose(glfwWindow->Get()))
 	{
 		glfwPollEvents();
@@ -102,63 +151,79 @@ void Engine::Run()
 	vkDeviceWaitIdle(device->GetLogical());
 }
 
-void Engine::DrawFrame()
+void Engine::RunFrames(uint32_t frameCount)
 {
-	vkWaitForFences(device->GetLogical(), 1, &sync->inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
-
-	uint32_t imageIndex;
-	VkResult result = vkAcquireNextImageKHR(device->GetLogical(), swapChain->Get(), UINT64_MAX, sync->imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
-	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized)
-	{
-		framebufferResized = false;
-		RecreateSwapChain();
-		return;
-	}
-	else if (result != VK_SUCCESS)
+	for (uint32_t i = 0; i < frameCount; ++i)
 	{
-		std::cerr << "Failed to acquire swap chain image" << std::endl;
-		return;
+		if (glfwWindow)
+			glfwPollEvents();
+
+		DrawFrame();
+
+		if (offscreenTarget && settings.writeImageSequence && !settings.outputPath.empty())
+		{
+			vkDeviceWaitIdle(device->GetLogical());
+			WriteHeadlessImage(headlessFrameIndex);
+		}
+
+		++headlessFrameIndex;
 	}
-	
-	renderPass->Begin(device->commandBuffers[currentFrame], imageIndex);
+	vkDeviceWaitIdle(device->GetLogical());
 
-	if (scene->GetMainCamera())
-	{
-		scene->UpdateUniformBuffers(currentFrame, swapChain->extent);
+	if (offscreenTarget && frameCount > 0 && !settings.writeImageSequence && !settings.outputPath.empty())
+		WriteHeadlessImage(headlessFrameIndex - 1);
+}
 
-		std::vector<MeshInstance*> opaqueMeshInstances;
-		std::vector<MeshInstance*> transparentMeshInstances;
+Scene* Engine::GetScene() const
+{
+	return scene.get();
+}
 
-		for (const auto& object : scene->GetObjects())
+ModelManager* Engine::GetModelManager() const
+{
+	return modelManager.get();
+}
+
+const FrameTimings& Engine::GetLastFrameTimings() const
+{
+	return lastFrameTimings;
+}
+
+VulkanGpuProfiler* Engine::GetGpuProfiler() const
+{
+	return gpuProfiler.get();
+}
+
+void Engine::DrawFrame()
+{
+	FrameClock::time_point frameStart = FrameClock::now();
+	lastFrameTimings = FrameTimings{};
+
+	modelManager->Update();
+
+	vkWaitForFences(device->GetLogical(), 1, &sync->inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+
+	uint32_t imageIndex = 0;
+	if (swapChain)
+	{
+		VkResult result = vkAcquireNextImageKHR(device->GetLogical(), swapChain->Get(), UINT64_MAX, sync->imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized)
 		{
-			if (auto* meshInstance = dynamic_cast<MeshInstance*>(object.get()))
-			{
-				for (size_t i = 0; i < meshInstance->GetMesh()->GetPrimitiveCount(); ++i)
-				{
-					if (meshInstance->GetMesh()->GetPrimitive(i)->GetTransparencyEnabled())
-						transparentMeshInstances.push_back(meshInstance);
-					else
-						opaqueMeshInstances.push_back(meshInstance);
-				}
-			}
+			framebufferResized = false;
+			RecreateSwapChain();
+			return;
+		}
+		else if (result != VK_SUCCESS)
+		{
+			std::cerr << "Failed to acquire swap chain image" << std::endl;
+			return;
 		}
-
-		std::sort(transparentMeshInstances.begin(), transparentMeshInstances.end(),
-			[&](MeshInstance* a, MeshInstance* b)
-			{
-				const glm::vec3& cameraPosition = scene->GetMainCamera()->transform.position;
-				float distA = glm::length(cameraPosition - a->transform.position);
-				float distB = glm::length(cameraPosition - b->transform.position);
-				return distA > distB;
-			});
-		
-		opaquePipeline->Render(device->commandBuffers[currentFrame], currentFrame, opaqueMeshInstances, scene->GetMainCamera());
-		transparentPipeline->Render(device->commandBuffers[currentFrame], currentFrame, transparentMeshInstances, scene->GetMainCamera());
 	}
-	
-	imGuiOverlay->Render(device->commandBuffers[currentFrame]);
-	
-	renderPass->End(device->commandBuffers[currentFrame]);
+
+	if (swapChain)
+		RecordCommandBuffer(device->commandBuffers[currentFrame], swapChain->framebuffers[imageIndex], swapChain->extent);
+	else
+		RecordCommandBuffer(device->commandBuffers[currentFrame], offscreenTarget->GetFramebuffer(), offscreenTarget->extent);
 	
 	vkResetFences(device->GetLogical(), 1, &sync->inFlightFences[currentFrame]);
 
@@ -167,15 +232,22 @@ void Engine::DrawFrame()
 
 	VkSemaphore waitSemaphores[] = {sync->imageAvailableSemaphores[currentFrame]};
 	VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-	submitInfo.waitSemaphoreCount = 1;
-	submitInfo.pWaitSemaphores = waitSemaphores;
-	submitInfo.pWaitDstStageMask = waitStages;
+	VkSemaphore signalSemaphores[] = {sync->renderFinishedSemaphores[currentFrame]};
+
+	// Offscreen frames have no acquire to wait on and no present to signal
+	if (swapChain)
+	{
+		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.pWaitSemaphores = waitSemaphores;
+		submitInfo.pWaitDstStageMask = waitStages;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = signalSemaphores;
+	}
+
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &device->commandBuffers[currentFrame];
 
-	VkSemaphore signalSemaphores[] = {sync->renderFinishedSemaphores[currentFrame]};
-	submitInfo.signalSemaphoreCount = 1;
-	submitInfo.pSignalSemaphores = signalSemaphores;
+	FrameClock::time_point submitStart = FrameClock::now();
 
 	if (vkQueueSubmit(device->graphicsQueue, 1, &submitInfo, sync->inFlightFences[currentFrame]) != VK_SUCCESS)
 	{
@@ -183,29 +255,133 @@ void Engine::DrawFrame()
 		return;
 	}
 
-	VkPresentInfoKHR presentInfo{};
-	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-	presentInfo.waitSemaphoreCount = 1;
-	presentInfo.pWaitSemaphores = signalSemaphores;
+	if (swapChain)
+	{
+		VkPresentInfoKHR presentInfo{};
+		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+		presentInfo.waitSemaphoreCount = 1;
+		presentInfo.pWaitSemaphores = signalSemaphores;
+
+		VkSwapchainKHR swapChains[] = {swapChain->Get()};
+		presentInfo.swapchainCount = 1;
+		presentInfo.pSwapchains = swapChains;
+		presentInfo.pImageIndices = &imageIndex;
+		presentInfo.pResults = nullptr;
+
+		VkResult result = vkQueuePresentKHR(device->presentQueue, &presentInfo);
+		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized)
+		{
+			framebufferResized = false;
+			RecreateSwapChain();
+		}
+		else if (result != VK_SUCCESS)
+		{
+			std::cerr << "Failed to present swap chain image" << std::endl;
+		}
+	}
 
-	VkSwapchainKHR swapChains[] = {swapChain->Get()};
-	presentInfo.swapchainCount = 1;
-	presentInfo.pSwapchains = swapChains;
-	presentInfo.pImageIndices = &imageIndex;
-	presentInfo.pResults = nullptr;
+	FrameClock::time_point frameEnd = FrameClock::now();
+	lastFrameTimings.submitPresent = ElapsedMilliseconds(submitStart, frameEnd);
+	lastFrameTimings.total = ElapsedMilliseconds(frameStart, frameEnd);
+
+	currentFrame = (currentFrame + 1) % VulkanConfig::MAX_FRAMES_IN_FLIGHT;
+}
 
-	result = vkQueuePresentKHR(device->presentQueue, &presentInfo);
-	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized)
+void Engine::RecordCommandBuffer(VkCommandBuffer commandBuffer, VkFramebuffer framebuffer, VkExtent2D extent)
+{
+	FrameClock::time_point recordStart = FrameClock::now();
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	beginInfo.pInheritanceInfo = nullptr;
+
+	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
 	{
-		framebufferResized = false;
-		RecreateSwapChain();
+		std::cerr << "Failed to begin recording command buffer" << std::endl;
+		return;
 	}
-	else if (result != VK_SUCCESS)
+
+	// Query resets are not allowed inside a render pass
+	gpuProfiler->BeginFrame(commandBuffer, currentFrame);
+
+	Camera* camera = scene->GetMainCamera();
+
+	// Scene updates come before the render pass, the culling dispatch has to be recorded outside of it
+	if (camera)
 	{
-		std::cerr << "Failed to present swap chain image" << std::endl;
+		FrameClock::time_point uniformsStart = FrameClock::now();
+
+		scene->UpdateTransforms();
+		scene->UpdateUniformBuffers(currentFrame, extent);
+
+		FrameClock::time_point iterationStart = FrameClock::now();
+
+		Frustum frustum = camera->GetFrustum(extent);
+
+		// Render lists are maintained by the scene as instances are created, only visibility and the transparent order change per frame.
+		// Opaque items are culled on the GPU when it can, transparent ones still need their CPU sort.
+		scene->CullRenderItems(frustum, !gpuCulling);
+
+		if (gpuCulling)
+		{
+			gpuCulling->SetRenderItems(scene->GetOpaqueRenderItems());
+
+			gpuProfiler->BeginPass(commandBuffer, GpuPass::Cull);
+			gpuCulling->Dispatch(commandBuffer, currentFrame, frustum, scene->GetInstanceBuffer());
+			gpuProfiler->EndPass(commandBuffer, GpuPass::Cull);
+		}
+
+		FrameClock::time_point sortStart = FrameClock::now();
+
+		scene->SortTransparentRenderItems(camera->transform.GetPosition());
+		scene->BuildInstancedDraws(currentFrame);
+
+		FrameClock::time_point sortEnd = FrameClock::now();
+
+		// Finished reads are swapped in before the draws below bind their textures
+		if (TextureStreamer* textureStreamer = modelManager->GetTextureStreamer())
+			textureStreamer->Update(scene->GetVisibleMeshInstances(), camera, extent);
+
+		lastFrameTimings.uniformUpdates = ElapsedMilliseconds(uniformsStart, iterationStart);
+		lastFrameTimings.sceneIteration = ElapsedMilliseconds(iterationStart, sortStart);
+		lastFrameTimings.sorting = ElapsedMilliseconds(sortStart, sortEnd);
 	}
 
-	currentFrame = (currentFrame + 1) % VulkanConfig::MAX_FRAMES_IN_FLIGHT;
+	renderPass->Begin(commandBuffer, framebuffer, extent);
+
+	if (camera)
+	{
+		VkDescriptorSet instanceDescriptorSet = scene->GetInstanceBuffer()->GetDescriptorSet(currentFrame);
+
+		gpuProfiler->BeginPass(commandBuffer, GpuPass::Opaque);
+		if (gpuCulling)
+			opaquePipeline->RenderIndirect(commandBuffer, currentFrame, gpuCulling.get(), camera, geometryArena.get(), gpuProfiler.get());
+		else
+			opaquePipeline->Render(commandBuffer, currentFrame, scene->GetOpaqueDraws(), camera, instanceDescriptorSet, geometryArena.get(), gpuProfiler.get());
+		gpuProfiler->EndPass(commandBuffer, GpuPass::Opaque);
+
+		gpuProfiler->BeginPass(commandBuffer, GpuPass::Transparent);
+		transparentPipeline->Render(commandBuffer, currentFrame, scene->GetTransparentDraws(), camera, instanceDescriptorSet, geometryArena.get(), gpuProfiler.get());
+		gpuProfiler->EndPass(commandBuffer, GpuPass::Transparent);
+	}
+	
+	if (imGuiOverlay)
+	{
+		gpuProfiler->BeginPass(commandBuffer, GpuPass::ImGui);
+		imGuiOverlay->Render(commandBuffer);
+		gpuProfiler->EndPass(commandBuffer, GpuPass::ImGui);
+	}
+	
+	renderPass->End(commandBuffer);
+
+	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+	{
+		std::cerr << "Failed to record command buffer" << std::endl;
+	}
+
+	// Recording covers everything in this function except the scene phases measured above
+	lastFrameTimings.commandRecording = ElapsedMilliseconds(recordStart, FrameClock::now()) - lastFrameTimings.uniformUpdates - lastFrameTimings.sceneIteration - lastFrameTimings.sorting;
 }
 
 void Engine::RecreateSwapChain()
@@ -228,4 +404,25 @@ void Engine::RecreateSwapChain()
 	swapChain->CreateDepthResources();
 	swapChain->CreateFramebuffers(renderPass->Get());
 	sync->CreateSyncObjects();
+}
+
+void Engine::WriteHeadlessImage(uint32_t frameIndex)
+{
+	std::vector<uint8_t> pixels;
+	if (!offscreenTarget->ReadPixels(pixels))
+	{
+		std::cerr << "Failed to read back offscreen image" << std::endl;
+		return;
+	}
+
+	std::filesystem::path outputPath = settings.outputPath;
+	if (settings.writeImageSequence)
+	{
+		std::ostringstream fileName;
+		fileName << outputPath.stem().string() << "_" << std::setw(4) << std::setfill('0') << frameIndex << outputPath.extension().string();
+		outputPath.replace_filename(fileName.str());
+	}
+
+	if (WriteImagePPM(outputPath, pixels, offscreenTarget->extent.width, offscreenTarget->extent.height))
+		std::cout << "Wrote " << outputPath.string() << std::endl;
 }
\ No newline at end of file
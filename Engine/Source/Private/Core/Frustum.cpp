@@ -0,0 +1,145 @@
+#include <Core/Frustum.h>
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define FRUSTUM_SSE2 1
+#include <emmintrin.h>
+#endif
+
+using namespace VulkanRenderer;
+
+Frustum Frustum::FromMatrix(const glm::mat4& viewProjection)
+{
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; ++row)
+		rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]);
+
+	// Left, right, bottom, top, near, far. Near uses the -w bound, which also holds for zero to one depth.
+	glm::vec4 planes[PlaneCount] =
+	{
+		rows[3] + rows[0],
+		rows[3] - rows[0],
+		rows[3] + rows[1],
+		rows[3] - rows[1],
+		rows[3] + rows[2],
+		rows[3] - rows[2],
+		glm::vec4(0.0f, 0.0f, 0.0f, 1.0f),
+		glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)
+	};
+
+	Frustum frustum;
+	for (int i = 0; i < PlaneCount; ++i)
+	{
+		// Normalized so distances are in world units and sphere radii can be compared against them
+		float length = glm::length(glm::vec3(planes[i]));
+		glm::vec4 plane = length > 0.0f ? planes[i] / length : planes[i];
+
+		frustum.planeX[i] = plane.x;
+		frustum.planeY[i] = plane.y;
+		frustum.planeZ[i] = plane.z;
+		frustum.planeW[i] = plane.w;
+	}
+
+	return frustum;
+}
+
+bool Frustum::IntersectsSphere(const BoundingSphere& sphere) const
+{
+	if (!sphere.IsValid())
+		return true;
+
+#ifdef FRUSTUM_SSE2
+	__m128 centerX = _mm_set1_ps(sphere.center.x);
+	__m128 centerY = _mm_set1_ps(sphere.center.y);
+	__m128 centerZ = _mm_set1_ps(sphere.center.z);
+	__m128 negativeRadius = _mm_set1_ps(-sphere.radius);
+
+	__m128 outside = _mm_setzero_ps();
+	for (int i = 0; i < PlaneCount; i += 4)
+	{
+		__m128 distance = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_load_ps(&planeX[i]), centerX),
+			_mm_mul_ps(_mm_load_ps(&planeY[i]), centerY)),
+			_mm_add_ps(_mm_mul_ps(_mm_load_ps(&planeZ[i]), centerZ), _mm_load_ps(&planeW[i])));
+
+		outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negativeRadius));
+	}
+
+	return _mm_movemask_ps(outside) == 0;
+#else
+	for (int i = 0; i < PlaneCount; ++i)
+	{
+		float distance = planeX[i] * sphere.center.x + planeY[i] * sphere.center.y + planeZ[i] * sphere.center.z + planeW[i];
+		if (distance < -sphere.radius)
+			return false;
+	}
+
+	return true;
+#endif
+}
+
+bool Frustum::IntersectsBox(const BoundingBox& box) const
+{
+	return ClassifyBox(box) != FrustumTest::Outside;
+}
+
+FrustumTest Frustum::ClassifyBox(const BoundingBox& box) const
+{
+	if (!box.IsValid())
+		return FrustumTest::Intersects;
+
+	glm::vec3 center = box.GetCenter();
+	glm::vec3 extents = box.GetExtents();
+
+#ifdef FRUSTUM_SSE2
+	__m128 centerX = _mm_set1_ps(center.x);
+	__m128 centerY = _mm_set1_ps(center.y);
+	__m128 centerZ = _mm_set1_ps(center.z);
+	__m128 extentX = _mm_set1_ps(extents.x);
+	__m128 extentY = _mm_set1_ps(extents.y);
+	__m128 extentZ = _mm_set1_ps(extents.z);
+
+	// Clearing the sign bit gives the absolute plane normal
+	__m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+	__m128 outside = _mm_setzero_ps();
+	__m128 crossing = _mm_setzero_ps();
+	for (int i = 0; i < PlaneCount; i += 4)
+	{
+		__m128 x = _mm_load_ps(&planeX[i]);
+		__m128 y = _mm_load_ps(&planeY[i]);
+		__m128 z = _mm_load_ps(&planeZ[i]);
+
+		__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, centerX), _mm_mul_ps(y, centerY)), _mm_add_ps(_mm_mul_ps(z, centerZ), _mm_load_ps(&planeW[i])));
+
+		// Projected half size of the box onto the plane normal
+		__m128 radius = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_and_ps(x, absMask), extentX),
+			_mm_mul_ps(_mm_and_ps(y, absMask), extentY)),
+			_mm_mul_ps(_mm_and_ps(z, absMask), extentZ));
+
+		outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+		crossing = _mm_or_ps(crossing, _mm_cmplt_ps(_mm_sub_ps(distance, radius), _mm_setzero_ps()));
+	}
+
+	if (_mm_movemask_ps(outside) != 0)
+		return FrustumTest::Outside;
+
+	return _mm_movemask_ps(crossing) != 0 ? FrustumTest::Intersects : FrustumTest::Inside;
+#else
+	FrustumTest result = FrustumTest::Inside;
+	for (int i = 0; i < PlaneCount; ++i)
+	{
+		float distance = planeX[i] * center.x + planeY[i] * center.y + planeZ[i] * center.z + planeW[i];
+		float radius = std::abs(planeX[i]) * extents.x + std::abs(planeY[i]) * extents.y + std::abs(planeZ[i]) * extents.z;
+		if (distance + radius < 0.0f)
+			return FrustumTest::Outside;
+
+		if (distance - radius < 0.0f)
+			result = FrustumTest::Intersects;
+	}
+
+	return result;
+#endif
+}
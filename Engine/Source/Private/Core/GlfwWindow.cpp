@@ -6,11 +6,11 @@
 
 using namespace VulkanRenderer;
 
-GlfwWindow::GlfwWindow(Engine* engine)
+GlfwWindow::GlfwWindow(Engine* engine, int width, int height)
 {
 	glfwInit();
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-	window = glfwCreateWindow(1280, 720, "Vulkan Renderer", nullptr, nullptr);
+	window = glfwCreateWindow(width, height, "Vulkan Renderer", nullptr, nullptr);
 	glfwSetWindowUserPointer(window, engine);
 	glfwSetFramebufferSizeCallback(window, FramebufferResizeCallback);
 }
@@ -0,0 +1,311 @@
+#include <Core/GltfFile.h>
+
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+
+#include <Core/MappedFile.h>
+
+using namespace VulkanRenderer;
+
+namespace
+{
+	constexpr uint32_t GlbMagic = 0x46546C67;
+	constexpr uint32_t GlbBinaryChunkType = 0x004E4942;
+
+	// Feeds the parser straight from a mapping, buffers the map callback points back into the mapping are never copied
+	class MappedGltfData : public fastgltf::GltfDataGetter
+	{
+	public:
+		MappedGltfData(const uint8_t* data, size_t size)
+			: data(data), size(size)
+		{
+		}
+
+		void read(void* ptr, std::size_t count) override
+		{
+			count = std::min(count, size - offset);
+
+			if (ptr != GetCurrent())
+				memcpy(ptr, data + offset, count);
+
+			offset += count;
+		}
+
+		// simdjson reads past the end of what it parses, so JSON is copied into a padded buffer instead of read from the mapping
+		fastgltf::span<std::byte> read(std::size_t count, std::size_t padding) override
+		{
+			count = std::min(count, size - offset);
+
+			paddedData.assign(count + padding, std::byte(0));
+			memcpy(paddedData.data(), data + offset, count);
+			offset += count;
+
+			return fastgltf::span<std::byte>(paddedData.data(), paddedData.size());
+		}
+
+		void reset() override
+		{
+			offset = 0;
+		}
+
+		std::size_t bytesRead() override
+		{
+			return offset;
+		}
+
+		std::size_t totalSize() override
+		{
+			return size;
+		}
+
+		const uint8_t* GetCurrent() const
+		{
+			return data + offset;
+		}
+
+	private:
+		const uint8_t* data;
+		size_t size;
+		size_t offset = 0;
+
+		std::vector<std::byte> paddedData;
+	};
+
+	struct LoadState
+	{
+		GltfFile* file = nullptr;
+		MappedGltfData* data = nullptr;
+
+		// Where the GLB binary chunk payload starts, zero for .gltf files and GLBs without one
+		size_t binaryChunkOffset = 0;
+		size_t binaryChunkSize = 0;
+	};
+
+	void FindBinaryChunk(const uint8_t* data, size_t size, LoadState& state)
+	{
+		auto readUint32 = [&](size_t offset)
+			{
+				uint32_t value = 0;
+				memcpy(&value, data + offset, sizeof(value));
+				return value;
+			};
+
+		if (size < 20 || readUint32(0) != GlbMagic)
+			return;
+
+		size_t binaryHeader = 20 + size_t(readUint32(12));
+		if (binaryHeader + 8 > size || readUint32(binaryHeader + 4) != GlbBinaryChunkType)
+			return;
+
+		state.binaryChunkOffset = binaryHeader + 8;
+		state.binaryChunkSize = std::min(size_t(readUint32(binaryHeader)), size - state.binaryChunkOffset);
+	}
+}
+
+GltfFile::GltfFile(const std::filesystem::path& path)
+	: directory(path.parent_path())
+{
+	file = std::make_unique<MappedFile>(path);
+}
+
+GltfFile::~GltfFile() = default;
+
+bool GltfFile::IsValid() const
+{
+	return file->IsValid();
+}
+
+const uint8_t* GltfFile::GetData() const
+{
+	return file->GetData();
+}
+
+size_t GltfFile::GetSize() const
+{
+	return file->GetSize();
+}
+
+fastgltf::Expected<fastgltf::Asset> GltfFile::Load(fastgltf::Parser& parser)
+{
+	MappedGltfData data(file->GetData(), file->GetSize());
+
+	LoadState state;
+	state.file = this;
+	state.data = &data;
+	FindBinaryChunk(file->GetData(), file->GetSize(), state);
+
+	parser.setUserPointer(&state);
+	parser.setBufferAllocationCallback(MapBuffer);
+
+	auto asset = parser.loadGltf(data, directory, fastgltf::Options::None);
+
+	parser.setBufferAllocationCallback(nullptr);
+	parser.setUserPointer(nullptr);
+
+	if (asset.error() != fastgltf::Error::None)
+		return asset;
+
+	// Referenced files are mapped up front so the decode jobs only ever read
+	const fastgltf::Asset& gltfAsset = asset.get();
+
+	bufferFiles.resize(gltfAsset.buffers.size());
+	for (size_t bufferIndex = 0; bufferIndex < gltfAsset.buffers.size(); ++bufferIndex)
+	{
+		if (const auto* uri = std::get_if<fastgltf::sources::URI>(&gltfAsset.buffers[bufferIndex].data))
+			bufferFiles[bufferIndex] = MapUri(uri->uri);
+	}
+
+	imageFiles.resize(gltfAsset.images.size());
+	for (size_t imageIndex = 0; imageIndex < gltfAsset.images.size(); ++imageIndex)
+	{
+		if (const auto* uri = std::get_if<fastgltf::sources::URI>(&gltfAsset.images[imageIndex].data))
+			imageFiles[imageIndex] = MapUri(uri->uri);
+	}
+
+	return asset;
+}
+
+fastgltf::span<const std::byte> GltfFile::GetBufferData(const fastgltf::Asset& asset, size_t bufferIndex) const
+{
+	if (bufferIndex >= asset.buffers.size())
+		return {};
+
+	return GetSourceData(asset.buffers[bufferIndex].data, bufferIndex < bufferFiles.size() ? bufferFiles[bufferIndex].get() : nullptr);
+}
+
+fastgltf::span<const std::byte> GltfFile::GetBufferViewData(const fastgltf::Asset& asset, size_t bufferViewIndex) const
+{
+	if (bufferViewIndex >= asset.bufferViews.size())
+		return {};
+
+	const fastgltf::BufferView& bufferView = asset.bufferViews[bufferViewIndex];
+
+	fastgltf::span<const std::byte> buffer = GetBufferData(asset, bufferView.bufferIndex);
+	if (bufferView.byteOffset + bufferView.byteLength > buffer.size())
+		return {};
+
+	return buffer.subspan(bufferView.byteOffset, bufferView.byteLength);
+}
+
+fastgltf::span<const std::byte> GltfFile::GetImageData(const fastgltf::Asset& asset, size_t imageIndex) const
+{
+	if (imageIndex >= asset.images.size())
+		return {};
+
+	const fastgltf::DataSource& source = asset.images[imageIndex].data;
+
+	if (const auto* view = std::get_if<fastgltf::sources::BufferView>(&source))
+		return GetBufferViewData(asset, view->bufferViewIndex);
+
+	return GetSourceData(source, imageIndex < imageFiles.size() ? imageFiles[imageIndex].get() : nullptr);
+}
+
+std::vector<GltfFile::ReferencedFile> GltfFile::GetReferencedFiles(const fastgltf::Asset& asset) const
+{
+	std::vector<ReferencedFile> referencedFiles;
+
+	auto addFile = [&](const fastgltf::DataSource& source, const std::unique_ptr<MappedFile>& mappedFile)
+		{
+			const auto* uri = std::get_if<fastgltf::sources::URI>(&source);
+			if (!uri || !mappedFile)
+				return;
+
+			std::filesystem::path path = uri->uri.fspath().lexically_normal();
+
+			bool seen = std::any_of(referencedFiles.begin(), referencedFiles.end(), [&](const ReferencedFile& file) { return file.path == path; });
+			if (!seen)
+				referencedFiles.push_back(ReferencedFile{path, mappedFile.get()});
+		};
+
+	for (size_t bufferIndex = 0; bufferIndex < asset.buffers.size() && bufferIndex < bufferFiles.size(); ++bufferIndex)
+		addFile(asset.buffers[bufferIndex].data, bufferFiles[bufferIndex]);
+
+	for (size_t imageIndex = 0; imageIndex < asset.images.size() && imageIndex < imageFiles.size(); ++imageIndex)
+		addFile(asset.images[imageIndex].data, imageFiles[imageIndex]);
+
+	return referencedFiles;
+}
+
+fastgltf::span<const std::byte> GltfFile::BufferDataAdapter::operator()(const fastgltf::Asset& asset, std::size_t bufferViewIndex) const
+{
+	return file->GetBufferViewData(asset, bufferViewIndex);
+}
+
+GltfFile::BufferDataAdapter GltfFile::GetBufferDataAdapter() const
+{
+	BufferDataAdapter adapter;
+	adapter.file = this;
+	return adapter;
+}
+
+fastgltf::span<const std::byte> GltfFile::GetSourceData(const fastgltf::DataSource& source, const MappedFile* sourceFile) const
+{
+	fastgltf::span<const std::byte> data;
+
+	std::visit(fastgltf::visitor
+		{
+			[&](const fastgltf::sources::URI& uri)
+			{
+				if (sourceFile && sourceFile->IsValid() && uri.fileByteOffset <= sourceFile->GetSize())
+					data = fastgltf::span<const std::byte>(reinterpret_cast<const std::byte*>(sourceFile->GetData()) + uri.fileByteOffset, sourceFile->GetSize() - uri.fileByteOffset);
+			},
+			[&](const fastgltf::sources::CustomBuffer& buffer)
+			{
+				if (buffer.id < customBuffers.size())
+					data = customBuffers[buffer.id];
+			},
+			[&](const fastgltf::sources::Array& array)
+			{
+				data = fastgltf::span<const std::byte>(array.bytes.data(), array.bytes.size());
+			},
+			[&](const fastgltf::sources::ByteView& view)
+			{
+				data = view.bytes;
+			},
+			[](auto&) {}
+		}, source);
+
+	return data;
+}
+
+std::unique_ptr<MappedFile> GltfFile::MapUri(const fastgltf::URI& uri) const
+{
+	if (!uri.isLocalPath())
+	{
+		std::cerr << "Failed to map non-local glTF URI: " << uri.string() << std::endl;
+		return nullptr;
+	}
+
+	auto mapped = std::make_unique<MappedFile>(directory / uri.fspath());
+	if (!mapped->IsValid())
+	{
+		std::cerr << "Failed to map glTF resource: " << (directory / uri.fspath()).string() << std::endl;
+		return nullptr;
+	}
+
+	return mapped;
+}
+
+fastgltf::BufferInfo GltfFile::MapBuffer(uint64_t size, void* userPointer)
+{
+	LoadState& state = *static_cast<LoadState*>(userPointer);
+	GltfFile& file = *state.file;
+
+	fastgltf::BufferInfo info{};
+	info.customId = file.customBuffers.size();
+
+	// The parser asks for the GLB binary chunk right before reading it, handing back the mapping itself makes that read a no-op
+	if (state.binaryChunkSize == size && state.data->bytesRead() == state.binaryChunkOffset)
+	{
+		info.mappedMemory = const_cast<uint8_t*>(state.data->GetCurrent());
+		file.customBuffers.push_back(fastgltf::span<const std::byte>(reinterpret_cast<const std::byte*>(state.data->GetCurrent()), static_cast<size_t>(size)));
+		return info;
+	}
+
+	// Everything else is a data URI the parser decodes into this memory
+	file.decodedData.push_back(std::make_unique<std::byte[]>(static_cast<size_t>(size)));
+	info.mappedMemory = file.decodedData.back().get();
+	file.customBuffers.push_back(fastgltf::span<const std::byte>(file.decodedData.back().get(), static_cast<size_t>(size)));
+	return info;
+}
@@ -0,0 +1,92 @@
+#include <Core/Hash.h>
+
+#include <cstring>
+
+using namespace VulkanRenderer;
+
+static constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+static constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+static constexpr uint64_t Prime3 = 0x165667B19E3779F9ull;
+static constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ull;
+static constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ull;
+
+static uint64_t RotateLeft(uint64_t value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+static uint64_t ReadWord(const uint8_t* bytes)
+{
+	uint64_t word;
+	std::memcpy(&word, bytes, sizeof(word));
+	return word;
+}
+
+static uint64_t Round(uint64_t accumulator, uint64_t word)
+{
+	accumulator += word * Prime2;
+	accumulator = RotateLeft(accumulator, 31);
+	return accumulator * Prime1;
+}
+
+static uint64_t MergeRound(uint64_t hash, uint64_t accumulator)
+{
+	hash ^= Round(0, accumulator);
+	return hash * Prime1 + Prime4;
+}
+
+uint64_t VulkanRenderer::HashBytes(const void* data, size_t size, uint64_t seed)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	const uint8_t* end = bytes + size;
+
+	uint64_t hash;
+
+	if (size >= 32)
+	{
+		// Four independent lanes keep the multiplier pipelines busy
+		uint64_t lanes[4] = {seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1};
+
+		for (; bytes + 32 <= end; bytes += 32)
+		{
+			for (int lane = 0; lane < 4; ++lane)
+				lanes[lane] = Round(lanes[lane], ReadWord(bytes + lane * 8));
+		}
+
+		hash = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18);
+		for (uint64_t lane : lanes)
+			hash = MergeRound(hash, lane);
+	}
+	else
+	{
+		hash = seed + Prime5;
+	}
+
+	hash += static_cast<uint64_t>(size);
+
+	for (; bytes + 8 <= end; bytes += 8)
+	{
+		hash ^= Round(0, ReadWord(bytes));
+		hash = RotateLeft(hash, 27) * Prime1 + Prime4;
+	}
+
+	for (; bytes < end; ++bytes)
+	{
+		hash ^= *bytes * Prime5;
+		hash = RotateLeft(hash, 11) * Prime1;
+	}
+
+	// Final avalanche
+	hash ^= hash >> 33;
+	hash *= Prime2;
+	hash ^= hash >> 29;
+	hash *= Prime3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
+
+uint64_t VulkanRenderer::HashString(const std::string& string, uint64_t seed)
+{
+	return HashBytes(string.data(), string.size(), seed);
+}
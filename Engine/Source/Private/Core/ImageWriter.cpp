@@ -0,0 +1,46 @@
+#include <Core/ImageWriter.h>
+
+#include <iostream>
+#include <fstream>
+
+namespace VulkanRenderer
+{
+	bool WriteImagePPM(const std::filesystem::path& path, const std::vector<uint8_t>& rgbaPixels, uint32_t width, uint32_t height)
+	{
+		if (rgbaPixels.size() < static_cast<size_t>(width) * height * 4)
+		{
+			std::cerr << "Not enough pixel data to write image: " << path.string() << std::endl;
+			return false;
+		}
+
+		if (path.has_parent_path())
+		{
+			std::error_code error;
+			std::filesystem::create_directories(path.parent_path(), error);
+		}
+
+		std::ofstream file(path, std::ios::binary);
+		if (!file.is_open())
+		{
+			std::cerr << "Failed to open file for writing: " << path.string() << std::endl;
+			return false;
+		}
+
+		file << "P6\n" << width << " " << height << "\n255\n";
+
+		std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			const uint8_t* src = rgbaPixels.data() + static_cast<size_t>(y) * width * 4;
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				row[x * 3 + 0] = src[x * 4 + 0];
+				row[x * 3 + 1] = src[x * 4 + 1];
+				row[x * 3 + 2] = src[x * 4 + 2];
+			}
+			file.write(reinterpret_cast<const char*>(row.data()), row.size());
+		}
+
+		return file.good();
+	}
+}
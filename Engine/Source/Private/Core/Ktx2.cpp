@@ -0,0 +1,147 @@
+#include <Core/Ktx2.h>
+
+#include <cstring>
+
+#include <volk.h>
+#include <zstd.h>
+
+using namespace VulkanRenderer;
+
+static constexpr uint8_t Ktx2Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+namespace
+{
+	struct Ktx2Header
+	{
+		uint8_t identifier[12];
+		uint32_t vkFormat;
+		uint32_t typeSize;
+		uint32_t pixelWidth;
+		uint32_t pixelHeight;
+		uint32_t pixelDepth;
+		uint32_t layerCount;
+		uint32_t faceCount;
+		uint32_t levelCount;
+		uint32_t supercompressionScheme;
+
+		uint32_t dfdByteOffset;
+		uint32_t dfdByteLength;
+		uint32_t kvdByteOffset;
+		uint32_t kvdByteLength;
+		uint64_t sgdByteOffset;
+		uint64_t sgdByteLength;
+	};
+
+	struct Ktx2LevelIndex
+	{
+		uint64_t byteOffset;
+		uint64_t byteLength;
+		uint64_t uncompressedByteLength;
+	};
+
+	static_assert(sizeof(Ktx2Header) == 80, "KTX2 header must match the file layout");
+}
+
+bool VulkanRenderer::IsKtx2(const uint8_t* data, size_t size)
+{
+	return size >= sizeof(Ktx2Identifier) && std::memcmp(data, Ktx2Identifier, sizeof(Ktx2Identifier)) == 0;
+}
+
+bool VulkanRenderer::ReadKtx2(const uint8_t* data, size_t size, Ktx2Image& outImage)
+{
+	if (!IsKtx2(data, size) || size < sizeof(Ktx2Header))
+		return false;
+
+	Ktx2Header header;
+	std::memcpy(&header, data, sizeof(header));
+
+	if (header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1)
+		return false;
+
+	// A level count of zero asks the loader to generate mips, only the base level is stored
+	uint32_t levelCount = header.levelCount == 0 ? 1 : header.levelCount;
+	if (levelCount > 32 || sizeof(Ktx2Header) + levelCount * sizeof(Ktx2LevelIndex) > size)
+		return false;
+
+	outImage.vkFormat = header.vkFormat;
+	outImage.width = header.pixelWidth;
+	outImage.height = header.pixelHeight;
+	outImage.supercompression = static_cast<Ktx2Supercompression>(header.supercompressionScheme);
+	outImage.levels.resize(levelCount);
+
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		Ktx2LevelIndex levelIndex;
+		std::memcpy(&levelIndex, data + sizeof(Ktx2Header) + level * sizeof(Ktx2LevelIndex), sizeof(levelIndex));
+
+		if (levelIndex.byteOffset > size || levelIndex.byteLength > size - levelIndex.byteOffset)
+			return false;
+
+		outImage.levels[level].data = data + levelIndex.byteOffset;
+		outImage.levels[level].size = static_cast<size_t>(levelIndex.byteLength);
+		outImage.levels[level].uncompressedSize = static_cast<size_t>(levelIndex.uncompressedByteLength);
+	}
+
+	return true;
+}
+
+bool VulkanRenderer::AppendKtx2Level(const Ktx2Image& image, uint32_t level, size_t levelSize, std::vector<uint8_t>& outBytes)
+{
+	if (level >= image.levels.size())
+		return false;
+
+	const Ktx2Level& source = image.levels[level];
+
+	switch (image.supercompression)
+	{
+	case Ktx2Supercompression::None:
+		if (source.size < levelSize)
+			return false;
+
+		outBytes.insert(outBytes.end(), source.data, source.data + levelSize);
+		return true;
+	case Ktx2Supercompression::Zstandard:
+	{
+		// The uncompressed length comes from the file, so it is never trusted to size the allocation
+		if (source.uncompressedSize != levelSize)
+			return false;
+
+		size_t offset = outBytes.size();
+		outBytes.resize(offset + levelSize);
+
+		size_t written = ZSTD_decompress(outBytes.data() + offset, levelSize, source.data, source.size);
+		if (ZSTD_isError(written) || written != levelSize)
+		{
+			outBytes.resize(offset);
+			return false;
+		}
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+bool VulkanRenderer::GetKtx2TextureFormat(uint32_t vkFormat, TextureFormat& outFormat)
+{
+	switch (static_cast<VkFormat>(vkFormat))
+	{
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB:
+		outFormat = TextureFormat::RGBA8;
+		return true;
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		outFormat = TextureFormat::BC1;
+		return true;
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+		outFormat = TextureFormat::BC5;
+		return true;
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		outFormat = TextureFormat::BC7;
+		return true;
+	default:
+		return false;
+	}
+}
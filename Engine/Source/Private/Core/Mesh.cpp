@@ -11,8 +11,8 @@
 
 using namespace VulkanRenderer;
 
-Mesh::Mesh(VulkanDevice* device, VkDescriptorSetLayout uniformDescriptorSetLayout)
-	: device(device), uniformDescriptorSetLayout(uniformDescriptorSetLayout)
+Mesh::Mesh(VulkanDevice* device)
+	: device(device)
 {
 
 }
@@ -34,11 +34,6 @@ MeshPrimitive* Mesh::GetPrimitive(size_t index) const
 	return nullptr;
 }
 
-VkDescriptorSetLayout Mesh::GetUniformDescriptorSetLayout() const
-{
-	return uniformDescriptorSetLayout;
-}
-
 void Mesh::AddPrimitive(std::unique_ptr<MeshPrimitive> meshPrimitive)
 {
 	primitives.push_back(std::move(meshPrimitive));
@@ -0,0 +1,357 @@
+#include <Core/MeshOptimizer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#include <glm/glm.hpp>
+
+#include <Core/Vertex.h>
+
+using namespace VulkanRenderer;
+
+// Modelled post-transform cache size for triangle ordering
+static constexpr uint32_t VertexCacheSize = 32;
+
+// FIFO cache size used to find cluster boundaries that cost nothing to reorder around
+static constexpr uint32_t ClusterCacheSize = 16;
+
+static uint32_t HashVertex(const Vertex& vertex)
+{
+	// FNV-1a over the raw bytes, the vertex is all floats so there is no padding
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&vertex);
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < sizeof(Vertex); ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static float ScoreVertex(int32_t cachePosition, uint32_t remainingTriangles)
+{
+	if (remainingTriangles == 0)
+		return -1.0f;
+
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		// The last triangle's vertices get a fixed score so the next triangle doesn't just reuse them
+		if (cachePosition < 3)
+		{
+			score = 0.75f;
+		}
+		else
+		{
+			float scaler = 1.0f - static_cast<float>(cachePosition - 3) / static_cast<float>(VertexCacheSize - 3);
+			score = std::pow(scaler, 1.5f);
+		}
+	}
+
+	// Boost vertices with few triangles left so they get finished off
+	score += 2.0f / std::sqrt(static_cast<float>(remainingTriangles));
+	return score;
+}
+
+void VulkanRenderer::WeldVertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+	if (vertices.empty())
+		return;
+
+	size_t tableSize = 1;
+	while (tableSize < vertices.size() * 2)
+		tableSize <<= 1;
+
+	// Open addressing table of indices into the welded vertex array
+	std::vector<uint32_t> table(tableSize, UINT32_MAX);
+	std::vector<uint32_t> remap(vertices.size());
+	std::vector<Vertex> welded;
+	welded.reserve(vertices.size());
+
+	for (size_t i = 0; i < vertices.size(); ++i)
+	{
+		const Vertex& vertex = vertices[i];
+		size_t slot = HashVertex(vertex) & (tableSize - 1);
+
+		while (table[slot] != UINT32_MAX && std::memcmp(&welded[table[slot]], &vertex, sizeof(Vertex)) != 0)
+			slot = (slot + 1) & (tableSize - 1);
+
+		if (table[slot] == UINT32_MAX)
+		{
+			table[slot] = static_cast<uint32_t>(welded.size());
+			welded.push_back(vertex);
+		}
+
+		remap[i] = table[slot];
+	}
+
+	for (uint32_t& index : indices)
+		index = remap[index];
+
+	vertices = std::move(welded);
+}
+
+void VulkanRenderer::OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+		return;
+
+	// Triangles adjacent to each vertex, packed by vertex
+	std::vector<uint32_t> remaining(vertexCount, 0);
+	for (uint32_t index : indices)
+		remaining[index]++;
+
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; ++v)
+		adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remaining[v];
+
+	std::vector<uint32_t> adjacency(indices.size());
+	std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+	for (size_t i = 0; i < indices.size(); ++i)
+		adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+	std::vector<int32_t> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t v = 0; v < vertexCount; ++v)
+		vertexScores[v] = ScoreVertex(-1, remaining[v]);
+
+	std::vector<float> triangleScores(triangleCount);
+	for (size_t t = 0; t < triangleCount; ++t)
+		triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> nextCache;
+	cache.reserve(VertexCacheSize + 3);
+	nextCache.reserve(VertexCacheSize + 3);
+
+	uint32_t bestTriangle = static_cast<uint32_t>(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+	size_t scanCursor = 0;
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+	{
+		if (bestTriangle == UINT32_MAX)
+		{
+			// Nothing in the cache has triangles left, restart from the next unemitted triangle
+			while (emitted[scanCursor])
+				scanCursor++;
+			bestTriangle = static_cast<uint32_t>(scanCursor);
+		}
+
+		const uint32_t* triangle = &indices[bestTriangle * 3];
+		emitted[bestTriangle] = true;
+		result.insert(result.end(), triangle, triangle + 3);
+
+		// Detach the triangle from its vertices
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			uint32_t v = triangle[k];
+			uint32_t* begin = &adjacency[adjacencyOffsets[v]];
+			uint32_t* end = begin + remaining[v];
+			uint32_t* it = std::find(begin, end, bestTriangle);
+			if (it != end)
+			{
+				*it = *(end - 1);
+				remaining[v]--;
+			}
+		}
+
+		// Emitted vertices move to the front of the LRU cache
+		nextCache.assign(triangle, triangle + 3);
+		for (uint32_t v : cache)
+		{
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+				nextCache.push_back(v);
+		}
+
+		for (size_t i = 0; i < nextCache.size(); ++i)
+			cachePosition[nextCache[i]] = i < VertexCacheSize ? static_cast<int32_t>(i) : -1;
+
+		// Rescore everything that was or is in the cache and pick the best triangle touching it
+		float bestScore = -1.0f;
+		bestTriangle = UINT32_MAX;
+
+		for (uint32_t v : nextCache)
+		{
+			float score = ScoreVertex(cachePosition[v], remaining[v]);
+			float delta = score - vertexScores[v];
+			vertexScores[v] = score;
+
+			for (uint32_t i = 0; i < remaining[v]; ++i)
+			{
+				uint32_t t = adjacency[adjacencyOffsets[v] + i];
+				triangleScores[t] += delta;
+
+				if (triangleScores[t] > bestScore)
+				{
+					bestScore = triangleScores[t];
+					bestTriangle = t;
+				}
+			}
+		}
+
+		if (nextCache.size() > VertexCacheSize)
+			nextCache.resize(VertexCacheSize);
+		std::swap(cache, nextCache);
+	}
+
+	indices = std::move(result);
+}
+
+void VulkanRenderer::OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount < 2)
+		return;
+
+	// Split the cache-ordered triangles wherever a triangle misses on all three vertices
+	std::vector<uint32_t> clusterStarts;
+	std::vector<uint32_t> cacheTimestamps(vertices.size(), 0);
+	uint32_t timestamp = ClusterCacheSize + 1;
+
+	for (size_t t = 0; t < triangleCount; ++t)
+	{
+		uint32_t misses = 0;
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			uint32_t v = indices[t * 3 + k];
+			if (timestamp - cacheTimestamps[v] > ClusterCacheSize)
+			{
+				cacheTimestamps[v] = timestamp++;
+				misses++;
+			}
+		}
+
+		if (t == 0 || misses == 3)
+			clusterStarts.push_back(static_cast<uint32_t>(t));
+	}
+
+	if (clusterStarts.size() < 2)
+		return;
+
+	struct Cluster
+	{
+		uint32_t start;
+		uint32_t count;
+		glm::vec3 centroid;
+		glm::vec3 normal;
+		float sortKey;
+	};
+
+	std::vector<Cluster> clusters(clusterStarts.size());
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+
+	for (size_t c = 0; c < clusters.size(); ++c)
+	{
+		Cluster& cluster = clusters[c];
+		cluster.start = clusterStarts[c];
+		cluster.count = (c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : static_cast<uint32_t>(triangleCount)) - cluster.start;
+
+		// Area weighted centroid and normal of the cluster
+		glm::vec3 centroid(0.0f);
+		glm::vec3 normal(0.0f);
+		float area = 0.0f;
+
+		for (uint32_t t = cluster.start; t < cluster.start + cluster.count; ++t)
+		{
+			const glm::vec3& p0 = vertices[indices[t * 3]].position;
+			const glm::vec3& p1 = vertices[indices[t * 3 + 1]].position;
+			const glm::vec3& p2 = vertices[indices[t * 3 + 2]].position;
+
+			glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+			float triangleArea = glm::length(cross);
+
+			centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+			normal += cross;
+			area += triangleArea;
+		}
+
+		cluster.centroid = area > 0.0f ? centroid / area : vertices[indices[cluster.start * 3]].position;
+		float normalLength = glm::length(normal);
+		cluster.normal = normalLength > 0.0f ? normal / normalLength : glm::vec3(0.0f);
+
+		meshCentroid += centroid;
+		meshArea += area;
+	}
+
+	if (meshArea > 0.0f)
+		meshCentroid /= meshArea;
+
+	// Clusters facing away from the middle of the mesh are likely in front and occlude the rest
+	for (Cluster& cluster : clusters)
+		cluster.sortKey = glm::dot(cluster.centroid - meshCentroid, cluster.normal);
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b)
+		{
+			return a.sortKey > b.sortKey;
+		});
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	for (const Cluster& cluster : clusters)
+		result.insert(result.end(), indices.begin() + cluster.start * 3, indices.begin() + (cluster.start + cluster.count) * 3);
+
+	indices = std::move(result);
+}
+
+void VulkanRenderer::OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+	std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+	std::vector<Vertex> reordered;
+	reordered.reserve(vertices.size());
+
+	for (uint32_t& index : indices)
+	{
+		if (remap[index] == UINT32_MAX)
+		{
+			remap[index] = static_cast<uint32_t>(reordered.size());
+			reordered.push_back(vertices[index]);
+		}
+
+		index = remap[index];
+	}
+
+	vertices = std::move(reordered);
+}
+
+void VulkanRenderer::OptimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+	// Drop incomplete triangles and ones referencing missing vertices
+	indices.resize(indices.size() / 3 * 3);
+
+	size_t writeIndex = 0;
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		if (indices[i] >= vertices.size() || indices[i + 1] >= vertices.size() || indices[i + 2] >= vertices.size())
+			continue;
+
+		std::copy(indices.begin() + i, indices.begin() + i + 3, indices.begin() + writeIndex);
+		writeIndex += 3;
+	}
+	indices.resize(writeIndex);
+
+	WeldVertices(vertices, indices);
+
+	// Welding can collapse triangles, they cover no pixels so drop them
+	writeIndex = 0;
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		if (indices[i] == indices[i + 1] || indices[i + 1] == indices[i + 2] || indices[i] == indices[i + 2])
+			continue;
+
+		std::copy(indices.begin() + i, indices.begin() + i + 3, indices.begin() + writeIndex);
+		writeIndex += 3;
+	}
+	indices.resize(writeIndex);
+
+	OptimizeVertexCache(indices, vertices.size());
+	OptimizeOverdraw(indices, vertices);
+	OptimizeVertexFetch(vertices, indices);
+}
@@ -8,14 +8,16 @@
 #include <Vulkan/Texture.h>
 #include <Vulkan/Buffer.h>
 #include <Vulkan/UniformBuffer.h>
+#include <Vulkan/UploadBatch.h>
 #include <Core/MaterialFactorsUBO.h>
 #include <Core/Vertex.h>
 
 using namespace VulkanRenderer;
 
-MeshPrimitive::MeshPrimitive(VulkanDevice* device, VkDescriptorSetLayout materialDescriptorSetLayout, VkDescriptorPool descriptorPool, const MeshPrimitiveInfo& info)
+MeshPrimitive::MeshPrimitive(VulkanDevice* device, VulkanGeometryArena* geometryArena, VkDescriptorSetLayout materialDescriptorSetLayout, VkDescriptorPool descriptorPool, const MeshPrimitiveInfo& info, VulkanUploadBatch* uploadBatch)
 	:
 	device(device),
+	geometryArena(geometryArena),
 	materialDescriptorSetLayout(materialDescriptorSetLayout),
 	baseColorFactor(info.baseColorFactor),
 	metallicFactor(info.metallicFactor),
@@ -25,8 +27,21 @@ MeshPrimitive::MeshPrimitive(VulkanDevice* device, VkDescriptorSetLayout materia
 	normalTexture(info.normalTexture),
 	transparencyEnabled(info.enableTransparency)
 {
-	CreateVertexBuffer(info.vertices);
-	CreateIndexBuffer(info.indices);
+	if (uploadBatch)
+	{
+		CreateGeometry(info, uploadBatch);
+	}
+	else
+	{
+		VkDeviceSize stagingSize = info.encodedGeometry
+			? GetVertexStride(info.encodedGeometry->vertexFormat) * info.encodedGeometry->vertexCount + sizeof(uint32_t) * info.encodedGeometry->indexCount
+			: sizeof(Vertex) * info.vertices.size() + sizeof(uint32_t) * info.indices.size();
+
+		VulkanUploadBatch localBatch(device, stagingSize + 16);
+		CreateGeometry(info, &localBatch);
+		localBatch.SubmitAndWait();
+	}
+
 	CreateMaterialFactorsUniformBuffer();
 	CreateMaterialDescriptorSets(descriptorPool);
 }
@@ -34,13 +49,37 @@ MeshPrimitive::MeshPrimitive(VulkanDevice* device, VkDescriptorSetLayout materia
 MeshPrimitive::~MeshPrimitive()
 {
 	delete materialFactorsUniformBuffer;
-	delete indexBuffer;
-	delete vertexBuffer;
+	geometryArena->Free(geometry);
 }
 
 const size_t MeshPrimitive::GetIndicesSize() const
 {
-	return indicesSize;
+	return geometry.indexCount;
+}
+
+const GeometryAllocation& MeshPrimitive::GetGeometry() const
+{
+	return geometry;
+}
+
+VertexFormat MeshPrimitive::GetVertexFormat() const
+{
+	return vertexFormat;
+}
+
+const VertexDequantization& MeshPrimitive::GetDequantization() const
+{
+	return dequantization;
+}
+
+const BoundingBox& MeshPrimitive::GetBounds() const
+{
+	return bounds;
+}
+
+const BoundingSphere& MeshPrimitive::GetBoundingSphere() const
+{
+	return boundingSphere;
 }
 
 VkDescriptorImageInfo MeshPrimitive::GetBaseColorDescriptorInfo() const
@@ -96,39 +135,60 @@ void MeshPrimitive::CreateMaterialFactorsUniformBuffer()
 	memcpy(materialFactorsUniformBuffer->GetMappedData(), &ubo, sizeof(ubo));
 }
 
-void MeshPrimitive::CreateVertexBuffer(const std::vector<Vertex>& vertices)
+VkIndexType VulkanRenderer::EncodeIndices(const std::vector<uint32_t>& indices, size_t vertexCount, std::vector<uint8_t>& outData)
 {
-	VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-	VulkanBuffer stagingBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	// Halve the index bandwidth whenever the primitive is small enough
+	if (vertexCount <= UINT16_MAX)
+	{
+		outData.resize(sizeof(uint16_t) * indices.size());
+		uint16_t* shortIndices = reinterpret_cast<uint16_t*>(outData.data());
+		for (size_t i = 0; i < indices.size(); ++i)
+			shortIndices[i] = static_cast<uint16_t>(indices[i]);
 
-	void* data = stagingBuffer.Map();
-	memcpy(data, vertices.data(), (size_t)bufferSize);
-	stagingBuffer.Unmap();
+		return VK_INDEX_TYPE_UINT16;
+	}
 
-	vertexBuffer = new VulkanBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	outData.resize(sizeof(uint32_t) * indices.size());
+	memcpy(outData.data(), indices.data(), outData.size());
 
-	CopyBuffer(device, stagingBuffer.Get(), vertexBuffer->Get(), bufferSize);
+	return VK_INDEX_TYPE_UINT32;
 }
 
-void MeshPrimitive::CreateIndexBuffer(const std::vector<uint16_t>& indices)
+void MeshPrimitive::CreateGeometry(const MeshPrimitiveInfo& info, VulkanUploadBatch* uploadBatch)
 {
-	VkDevice logicalDevice = device->GetLogical();
+	if (info.encodedGeometry)
+	{
+		UploadGeometry(*info.encodedGeometry, uploadBatch);
+		return;
+	}
 
-	VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
+	std::vector<uint8_t> vertexData;
+	std::vector<uint8_t> indexData;
 
-	VulkanBuffer stagingBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	EncodedGeometry encoded;
+	encoded.vertexFormat = EncodeVertices(info.vertices, vertexData, encoded.dequantization);
+	encoded.vertexData = vertexData.data();
+	encoded.vertexCount = static_cast<uint32_t>(info.vertices.size());
+	encoded.indexType = EncodeIndices(info.indices, info.vertices.size(), indexData);
+	encoded.indexData = indexData.data();
+	encoded.indexCount = static_cast<uint32_t>(info.indices.size());
+	encoded.bounds = ComputeBounds(info.vertices);
+	encoded.boundingSphere = ComputeBoundingSphere(info.vertices, encoded.bounds);
 
-	void* data = stagingBuffer.Map();
-	memcpy(data, indices.data(), (size_t)bufferSize);
-	stagingBuffer.Unmap();
+	UploadGeometry(encoded, uploadBatch);
+}
 
-	indexBuffer = new VulkanBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+void MeshPrimitive::UploadGeometry(const EncodedGeometry& encoded, VulkanUploadBatch* uploadBatch)
+{
+	vertexFormat = encoded.vertexFormat;
+	dequantization = encoded.dequantization;
+	bounds = encoded.bounds;
+	boundingSphere = encoded.boundingSphere;
 
-	CopyBuffer(device, stagingBuffer.Get(), indexBuffer->Get(), bufferSize);
+	geometry = geometryArena->Allocate(uploadBatch, encoded.vertexData, GetVertexStride(encoded.vertexFormat), encoded.vertexCount, encoded.indexData, encoded.indexType, encoded.indexCount);
 
-	// Cache indices size for indices draw call
-	indicesSize = indices.size();
+	if (!geometry.IsValid())
+		std::cerr << "Failed to allocate mesh primitive geometry" << std::endl;
 }
 
 void MeshPrimitive::CreateMaterialDescriptorSets(VkDescriptorPool descriptorPool)
@@ -151,48 +211,70 @@ void MeshPrimitive::CreateMaterialDescriptorSets(VkDescriptorPool descriptorPool
 		return;
 	}
 
+	materialTextureGenerations.resize(VulkanConfig::MAX_FRAMES_IN_FLIGHT);
+
 	// Update the descriptor set for each frame in flight
-	for (size_t i = 0; i < VulkanConfig::MAX_FRAMES_IN_FLIGHT; i++)
-	{
-		std::array<VkWriteDescriptorSet, 4> descriptorWrites{};
-		
-		VkDescriptorBufferInfo bufferInfo{};
-		bufferInfo.buffer = materialFactorsUniformBuffer->Get();
-		bufferInfo.offset = 0;
-		bufferInfo.range = sizeof(MaterialFactorsUBO);
-
-		descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		descriptorWrites[0].dstSet = materialDescriptorSets[i];
-		descriptorWrites[0].dstBinding = 0;
-		descriptorWrites[0].dstArrayElement = 0;
-		descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		descriptorWrites[0].descriptorCount = 1;
-		descriptorWrites[0].pBufferInfo = &bufferInfo;
-
-		descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		descriptorWrites[1].dstSet = materialDescriptorSets[i];
-		descriptorWrites[1].dstBinding = 1;
-		descriptorWrites[1].dstArrayElement = 0;
-		descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		descriptorWrites[1].descriptorCount = 1;
-		descriptorWrites[1].pImageInfo = &GetBaseColorDescriptorInfo();
-
-		descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		descriptorWrites[2].dstSet = materialDescriptorSets[i];
-		descriptorWrites[2].dstBinding = 2;
-		descriptorWrites[2].dstArrayElement = 0;
-		descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		descriptorWrites[2].descriptorCount = 1;
-		descriptorWrites[2].pImageInfo = &GetMetallicRoughnessDescriptorInfo();
-
-		descriptorWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		descriptorWrites[3].dstSet = materialDescriptorSets[i];
-		descriptorWrites[3].dstBinding = 3;
-		descriptorWrites[3].dstArrayElement = 0;
-		descriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		descriptorWrites[3].descriptorCount = 1;
-		descriptorWrites[3].pImageInfo = &GetNormalDescriptorInfo();
-
-		vkUpdateDescriptorSets(logicalDevice, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
-	}
+	for (uint32_t i = 0; i < VulkanConfig::MAX_FRAMES_IN_FLIGHT; i++)
+		WriteMaterialDescriptorSet(i);
+}
+
+void MeshPrimitive::RefreshMaterialDescriptorSet(uint32_t currentFrame)
+{
+	if (materialTextureGenerations[currentFrame] != GetTextureGenerations())
+		WriteMaterialDescriptorSet(currentFrame);
+}
+
+std::array<uint32_t, 3> MeshPrimitive::GetTextureGenerations() const
+{
+	return {baseColorTexture->GetGeneration(), metallicRoughnessTexture->GetGeneration(), normalTexture->GetGeneration()};
+}
+
+void MeshPrimitive::WriteMaterialDescriptorSet(uint32_t frame)
+{
+	std::array<VkWriteDescriptorSet, 4> descriptorWrites{};
+
+	VkDescriptorBufferInfo bufferInfo{};
+	bufferInfo.buffer = materialFactorsUniformBuffer->Get();
+	bufferInfo.offset = 0;
+	bufferInfo.range = sizeof(MaterialFactorsUBO);
+
+	VkDescriptorImageInfo baseColorInfo = GetBaseColorDescriptorInfo();
+	VkDescriptorImageInfo metallicRoughnessInfo = GetMetallicRoughnessDescriptorInfo();
+	VkDescriptorImageInfo normalInfo = GetNormalDescriptorInfo();
+
+	descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrites[0].dstSet = materialDescriptorSets[frame];
+	descriptorWrites[0].dstBinding = 0;
+	descriptorWrites[0].dstArrayElement = 0;
+	descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descriptorWrites[0].descriptorCount = 1;
+	descriptorWrites[0].pBufferInfo = &bufferInfo;
+
+	descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrites[1].dstSet = materialDescriptorSets[frame];
+	descriptorWrites[1].dstBinding = 1;
+	descriptorWrites[1].dstArrayElement = 0;
+	descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descriptorWrites[1].descriptorCount = 1;
+	descriptorWrites[1].pImageInfo = &baseColorInfo;
+
+	descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrites[2].dstSet = materialDescriptorSets[frame];
+	descriptorWrites[2].dstBinding = 2;
+	descriptorWrites[2].dstArrayElement = 0;
+	descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descriptorWrites[2].descriptorCount = 1;
+	descriptorWrites[2].pImageInfo = &metallicRoughnessInfo;
+
+	descriptorWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrites[3].dstSet = materialDescriptorSets[frame];
+	descriptorWrites[3].dstBinding = 3;
+	descriptorWrites[3].dstArrayElement = 0;
+	descriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descriptorWrites[3].descriptorCount = 1;
+	descriptorWrites[3].pImageInfo = &normalInfo;
+
+	vkUpdateDescriptorSets(device->GetLogical(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+	materialTextureGenerations[frame] = GetTextureGenerations();
 }
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include <Core/MipChain.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+using namespace VulkanRenderer;
+
+namespace
+{
+	struct SRGBTables
+	{
+		std::array<float, 256> toLinear{};
+		// Linear values quantized to 12 bits keep the dark end of the curve accurate
+		std::array<uint8_t, 4096> toSRGB{};
+
+		SRGBTables()
+		{
+			for (uint32_t i = 0; i < toLinear.size(); i++)
+			{
+				float c = i / 255.0f;
+				toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+
+			for (uint32_t i = 0; i < toSRGB.size(); i++)
+			{
+				float l = i / float(toSRGB.size() - 1);
+				float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+				toSRGB[i] = static_cast<uint8_t>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+			}
+		}
+	};
+
+	const SRGBTables& GetSRGBTables()
+	{
+		static const SRGBTables tables;
+		return tables;
+	}
+
+	void Downsample(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight, bool sRGB)
+	{
+		const SRGBTables& tables = GetSRGBTables();
+
+		for (uint32_t y = 0; y < dstHeight; y++)
+		{
+			// Odd sizes clamp the second tap to the edge
+			uint32_t y0 = std::min(y * 2, srcHeight - 1);
+			uint32_t y1 = std::min(y * 2 + 1, srcHeight - 1);
+
+			for (uint32_t x = 0; x < dstWidth; x++)
+			{
+				uint32_t x0 = std::min(x * 2, srcWidth - 1);
+				uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1);
+
+				const uint8_t* taps[4] = {
+					src + (size_t(y0) * srcWidth + x0) * 4,
+					src + (size_t(y0) * srcWidth + x1) * 4,
+					src + (size_t(y1) * srcWidth + x0) * 4,
+					src + (size_t(y1) * srcWidth + x1) * 4
+				};
+
+				uint8_t* out = dst + (size_t(y) * dstWidth + x) * 4;
+
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					if (sRGB)
+					{
+						float sum = tables.toLinear[taps[0][c]] + tables.toLinear[taps[1][c]] + tables.toLinear[taps[2][c]] + tables.toLinear[taps[3][c]];
+						out[c] = tables.toSRGB[static_cast<size_t>(sum * 0.25f * (tables.toSRGB.size() - 1) + 0.5f)];
+					}
+					else
+					{
+						out[c] = static_cast<uint8_t>((taps[0][c] + taps[1][c] + taps[2][c] + taps[3][c] + 2) / 4);
+					}
+				}
+
+				out[3] = static_cast<uint8_t>((taps[0][3] + taps[1][3] + taps[2][3] + taps[3][3] + 2) / 4);
+			}
+		}
+	}
+}
+
+uint32_t VulkanRenderer::GetMipLevelCount(uint32_t width, uint32_t height)
+{
+	uint32_t levels = 1;
+	uint32_t size = std::max(width, height);
+	while (size > 1)
+	{
+		size /= 2;
+		levels++;
+	}
+
+	return levels;
+}
+
+size_t VulkanRenderer::GetMipChainSize(uint32_t width, uint32_t height, uint32_t levelCount)
+{
+	size_t size = 0;
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		size += size_t(width) * height * 4;
+		width = std::max(width / 2, 1u);
+		height = std::max(height / 2, 1u);
+	}
+
+	return size;
+}
+
+void VulkanRenderer::GenerateMipChain(std::vector<uint8_t>& inOutPixels, uint32_t width, uint32_t height, bool sRGB)
+{
+	uint32_t levelCount = GetMipLevelCount(width, height);
+	inOutPixels.resize(GetMipChainSize(width, height, levelCount));
+
+	size_t srcOffset = 0;
+	for (uint32_t level = 1; level < levelCount; level++)
+	{
+		uint32_t dstWidth = std::max(width / 2, 1u);
+		uint32_t dstHeight = std::max(height / 2, 1u);
+		size_t dstOffset = srcOffset + size_t(width) * height * 4;
+
+		Downsample(inOutPixels.data() + srcOffset, width, height, inOutPixels.data() + dstOffset, dstWidth, dstHeight, sRGB);
+
+		srcOffset = dstOffset;
+		width = dstWidth;
+		height = dstHeight;
+	}
+}
@@ -0,0 +1,605 @@
+#include <Core/ModelCache.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+
+#include <Core/Hash.h>
+#include <Core/MipChain.h>
+#include <Core/TextureCompression.h>
+#include <Core/MappedFile.h>
+
+using namespace VulkanRenderer;
+
+static constexpr char CacheMagic[4] = {'V', 'R', 'M', 'D'};
+
+// Bump whenever the layout below or the cooking of its contents changes
+static constexpr uint32_t CacheVersion = 7;
+
+// Payloads start on this alignment so they can be copied straight to staging memory
+static constexpr size_t PayloadAlignment = 16;
+
+namespace
+{
+	struct FileHeader
+	{
+		char magic[4];
+		uint32_t version;
+
+		uint64_t sourceSize;
+		int64_t sourceWriteTime;
+		uint64_t sourceHash;
+
+		uint32_t nodeCount;
+		uint32_t rootNodeCount;
+		uint32_t textureCount;
+		uint32_t meshCount;
+		uint32_t primitiveCount;
+		uint32_t dependencyCount;
+	};
+
+	// Followed by the path
+	struct FileDependency
+	{
+		uint64_t size;
+		int64_t writeTime;
+		uint64_t contentHash;
+
+		uint32_t pathLength;
+		uint32_t reserved;
+	};
+
+	// Followed by the name and then the child indices
+	struct FileNode
+	{
+		float position[3];
+		float rotation[4];
+		float scale[3];
+
+		int32_t meshIndex;
+		uint32_t childCount;
+		uint32_t nameLength;
+	};
+
+	struct FileTexture
+	{
+		uint32_t width;
+		uint32_t height;
+		uint32_t flags;
+		uint32_t mipLevels;
+		uint32_t format;
+		uint32_t type;
+		uint64_t contentHash;
+
+		uint64_t dataOffset;
+		uint64_t dataSize;
+	};
+
+	struct FileMesh
+	{
+		uint32_t firstPrimitive;
+		uint32_t primitiveCount;
+	};
+
+	struct FilePrimitive
+	{
+		uint32_t vertexFormat;
+		uint32_t vertexCount;
+		uint32_t indexType;
+		uint32_t indexCount;
+
+		float positionOffset[4];
+		float positionScale[4];
+		float boundsMin[3];
+		float boundsMax[3];
+		float boundingSphere[4];
+
+		uint64_t vertexDataOffset;
+		uint64_t vertexDataSize;
+		uint64_t indexDataOffset;
+		uint64_t indexDataSize;
+
+		float baseColorFactor[4];
+		float metallicFactor;
+		float roughnessFactor;
+
+		int32_t textures[3];
+		uint32_t flags;
+	};
+
+	enum FileFlags : uint32_t
+	{
+		TextureSRGB = 1 << 0,
+		PrimitiveTransparent = 1 << 0,
+		PrimitiveDoubleSided = 1 << 1
+	};
+
+	class ByteWriter
+	{
+	public:
+		ByteWriter(std::vector<uint8_t>& bytes) : bytes(bytes) {}
+
+		size_t WriteBytes(const void* data, size_t size)
+		{
+			size_t offset = bytes.size();
+			bytes.resize(offset + size);
+			if (size > 0)
+				std::memcpy(bytes.data() + offset, data, size);
+			return offset;
+		}
+
+		template<typename T>
+		size_t Write(const T& value)
+		{
+			return WriteBytes(&value, sizeof(T));
+		}
+
+		template<typename T>
+		void Patch(size_t offset, const T& value)
+		{
+			std::memcpy(bytes.data() + offset, &value, sizeof(T));
+		}
+
+		void Align(size_t alignment)
+		{
+			bytes.resize((bytes.size() + alignment - 1) / alignment * alignment, 0);
+		}
+
+	private:
+		std::vector<uint8_t>& bytes;
+	};
+
+	class ByteReader
+	{
+	public:
+		ByteReader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+		bool ReadBytes(size_t count, const uint8_t*& outData)
+		{
+			if (count > size - offset)
+				return false;
+
+			outData = data + offset;
+			offset += count;
+			return true;
+		}
+
+		template<typename T>
+		bool Read(T& outValue)
+		{
+			const uint8_t* bytes = nullptr;
+			if (!ReadBytes(sizeof(T), bytes))
+				return false;
+
+			std::memcpy(&outValue, bytes, sizeof(T));
+			return true;
+		}
+
+		// Payloads are addressed from the start of the file
+		bool GetPayload(uint64_t payloadOffset, uint64_t payloadSize, const uint8_t*& outData) const
+		{
+			if (payloadOffset > size || payloadSize > size - payloadOffset)
+				return false;
+
+			outData = data + payloadOffset;
+			return true;
+		}
+
+	private:
+		const uint8_t* data;
+		size_t size;
+		size_t offset = 0;
+	};
+}
+
+// A newer write time alone doesn't mean the content changed, e.g. after a checkout
+static bool IsFileUnchanged(const std::filesystem::path& path, const ModelFileStamp& cachedStamp)
+{
+	ModelFileStamp stamp;
+	if (!ModelCache::GetFileStamp(path, stamp) || stamp.size != cachedStamp.size)
+		return false;
+
+	if (stamp.writeTime == cachedStamp.writeTime)
+		return true;
+
+	MappedFile file(path);
+	return file.IsValid() && HashBytes(file.GetData(), file.GetSize()) == cachedStamp.contentHash;
+}
+
+ModelCache::ModelCache(const std::filesystem::path& directory)
+	: directory(directory)
+{
+
+}
+
+std::filesystem::path ModelCache::GetCachePath(const std::filesystem::path& sourcePath) const
+{
+	std::error_code error;
+	std::filesystem::path absolutePath = std::filesystem::absolute(sourcePath, error);
+
+	std::ostringstream fileName;
+	fileName << sourcePath.stem().string() << '-' << std::hex << std::setw(16) << std::setfill('0') << HashString((error ? sourcePath : absolutePath).generic_string()) << ".vrmodel";
+
+	return directory / fileName.str();
+}
+
+std::unique_ptr<MappedFile> ModelCache::Open(const std::filesystem::path& sourcePath, CookedModel& outModel) const
+{
+	auto file = std::make_unique<MappedFile>(GetCachePath(sourcePath));
+	if (!file->IsValid())
+		return nullptr;
+
+	ModelSourceStamp cachedStamp;
+	if (!Deserialize(file->GetData(), file->GetSize(), outModel, cachedStamp))
+	{
+		outModel = CookedModel{};
+		return nullptr;
+	}
+
+	// External buffers and images are cooked into the model, so editing any of them invalidates it like editing the source
+	bool upToDate = IsFileUnchanged(sourcePath, cachedStamp.file) && std::all_of(cachedStamp.dependencies.begin(), cachedStamp.dependencies.end(),
+		[&](const ModelDependencyStamp& dependency)
+		{
+			return IsFileUnchanged(sourcePath.parent_path() / std::filesystem::u8path(dependency.path), dependency.file);
+		});
+
+	if (!upToDate)
+	{
+		outModel = CookedModel{};
+		return nullptr;
+	}
+
+	return file;
+}
+
+bool ModelCache::Write(const std::filesystem::path& sourcePath, const std::vector<uint8_t>& cookedBytes) const
+{
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+
+	std::filesystem::path cachePath = GetCachePath(sourcePath);
+
+	std::ostringstream tempName;
+	tempName << cachePath.filename().string() << ".tmp" << std::hash<std::thread::id>()(std::this_thread::get_id());
+	std::filesystem::path tempPath = cachePath.parent_path() / tempName.str();
+
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			std::cerr << "Failed to create model cache file: " << tempPath.string() << std::endl;
+			return false;
+		}
+
+		file.write(reinterpret_cast<const char*>(cookedBytes.data()), static_cast<std::streamsize>(cookedBytes.size()));
+		if (!file.good())
+		{
+			std::cerr << "Failed to write model cache file: " << tempPath.string() << std::endl;
+			file.close();
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+	}
+
+	std::filesystem::rename(tempPath, cachePath, error);
+	if (error)
+	{
+		std::cerr << "Failed to replace model cache file: " << cachePath.string() << std::endl;
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+
+	return true;
+}
+
+bool ModelCache::GetFileStamp(const std::filesystem::path& path, ModelFileStamp& outStamp)
+{
+	std::error_code error;
+
+	uint64_t size = std::filesystem::file_size(path, error);
+	if (error)
+		return false;
+
+	auto writeTime = std::filesystem::last_write_time(path, error);
+	if (error)
+		return false;
+
+	outStamp.size = size;
+	outStamp.writeTime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+	return true;
+}
+
+void ModelCache::Serialize(const CookedModel& model, const ModelSourceStamp& stamp, std::vector<uint8_t>& outBytes)
+{
+	outBytes.clear();
+	ByteWriter writer(outBytes);
+
+	FileHeader header{};
+	std::memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+	header.version = CacheVersion;
+	header.sourceSize = stamp.file.size;
+	header.sourceWriteTime = stamp.file.writeTime;
+	header.sourceHash = stamp.file.contentHash;
+	header.nodeCount = static_cast<uint32_t>(model.nodes.size());
+	header.rootNodeCount = static_cast<uint32_t>(model.rootNodes.size());
+	header.textureCount = static_cast<uint32_t>(model.textures.size());
+	header.meshCount = static_cast<uint32_t>(model.meshes.size());
+	header.primitiveCount = static_cast<uint32_t>(model.primitives.size());
+	header.dependencyCount = static_cast<uint32_t>(stamp.dependencies.size());
+	writer.Write(header);
+
+	for (const ModelDependencyStamp& dependency : stamp.dependencies)
+	{
+		FileDependency fileDependency{};
+		fileDependency.size = dependency.file.size;
+		fileDependency.writeTime = dependency.file.writeTime;
+		fileDependency.contentHash = dependency.file.contentHash;
+		fileDependency.pathLength = static_cast<uint32_t>(dependency.path.size());
+
+		writer.Write(fileDependency);
+		writer.WriteBytes(dependency.path.data(), dependency.path.size());
+	}
+
+	for (const ModelNode& node : model.nodes)
+	{
+		FileNode fileNode{};
+		std::memcpy(fileNode.position, &node.position, sizeof(fileNode.position));
+		fileNode.rotation[0] = node.rotation.x;
+		fileNode.rotation[1] = node.rotation.y;
+		fileNode.rotation[2] = node.rotation.z;
+		fileNode.rotation[3] = node.rotation.w;
+		std::memcpy(fileNode.scale, &node.scale, sizeof(fileNode.scale));
+		fileNode.meshIndex = node.meshIndex;
+		fileNode.childCount = static_cast<uint32_t>(node.children.size());
+		fileNode.nameLength = static_cast<uint32_t>(node.name.size());
+
+		writer.Write(fileNode);
+		writer.WriteBytes(node.name.data(), node.name.size());
+		writer.WriteBytes(node.children.data(), node.children.size() * sizeof(uint32_t));
+	}
+
+	writer.WriteBytes(model.rootNodes.data(), model.rootNodes.size() * sizeof(uint32_t));
+
+	// Tables first with payload offsets patched in once the payloads are placed
+	std::vector<size_t> textureRecords;
+	for (const CookedTexture& texture : model.textures)
+	{
+		FileTexture fileTexture{};
+		fileTexture.width = texture.width;
+		fileTexture.height = texture.height;
+		fileTexture.flags = texture.sRGB ? static_cast<uint32_t>(TextureSRGB) : 0u;
+		fileTexture.mipLevels = texture.mipLevels;
+		fileTexture.format = static_cast<uint32_t>(texture.format);
+		fileTexture.type = static_cast<uint32_t>(texture.type);
+		fileTexture.contentHash = texture.contentHash;
+		fileTexture.dataSize = texture.pixels ? texture.size : 0;
+
+		textureRecords.push_back(writer.Write(fileTexture));
+	}
+
+	for (const CookedMesh& mesh : model.meshes)
+	{
+		FileMesh fileMesh{};
+		fileMesh.firstPrimitive = mesh.firstPrimitive;
+		fileMesh.primitiveCount = mesh.primitiveCount;
+		writer.Write(fileMesh);
+	}
+
+	std::vector<size_t> primitiveRecords;
+	for (const CookedPrimitive& primitive : model.primitives)
+	{
+		const EncodedGeometry& geometry = primitive.geometry;
+
+		FilePrimitive filePrimitive{};
+		filePrimitive.vertexFormat = static_cast<uint32_t>(geometry.vertexFormat);
+		filePrimitive.vertexCount = geometry.vertexCount;
+		filePrimitive.indexType = geometry.indexType == VK_INDEX_TYPE_UINT32 ? 1 : 0;
+		filePrimitive.indexCount = geometry.indexCount;
+		std::memcpy(filePrimitive.positionOffset, &geometry.dequantization.positionOffset, sizeof(filePrimitive.positionOffset));
+		std::memcpy(filePrimitive.positionScale, &geometry.dequantization.positionScale, sizeof(filePrimitive.positionScale));
+		std::memcpy(filePrimitive.boundsMin, &geometry.bounds.min, sizeof(filePrimitive.boundsMin));
+		std::memcpy(filePrimitive.boundsMax, &geometry.bounds.max, sizeof(filePrimitive.boundsMax));
+		std::memcpy(filePrimitive.boundingSphere, &geometry.boundingSphere.center, sizeof(float) * 3);
+		filePrimitive.boundingSphere[3] = geometry.boundingSphere.radius;
+		filePrimitive.vertexDataSize = static_cast<uint64_t>(GetVertexStride(geometry.vertexFormat)) * geometry.vertexCount;
+		filePrimitive.indexDataSize = static_cast<uint64_t>(geometry.indexType == VK_INDEX_TYPE_UINT32 ? 4 : 2) * geometry.indexCount;
+		std::memcpy(filePrimitive.baseColorFactor, &primitive.baseColorFactor, sizeof(filePrimitive.baseColorFactor));
+		filePrimitive.metallicFactor = primitive.metallicFactor;
+		filePrimitive.roughnessFactor = primitive.roughnessFactor;
+		filePrimitive.textures[0] = primitive.baseColorTexture;
+		filePrimitive.textures[1] = primitive.metallicRoughnessTexture;
+		filePrimitive.textures[2] = primitive.normalTexture;
+		filePrimitive.flags = (primitive.enableTransparency ? static_cast<uint32_t>(PrimitiveTransparent) : 0u) | (primitive.doubleSided ? static_cast<uint32_t>(PrimitiveDoubleSided) : 0u);
+
+		primitiveRecords.push_back(writer.Write(filePrimitive));
+	}
+
+	auto writePayload = [&](const void* data, size_t size)
+		{
+			writer.Align(PayloadAlignment);
+			return static_cast<uint64_t>(writer.WriteBytes(data, size));
+		};
+
+	for (size_t i = 0; i < model.textures.size(); ++i)
+	{
+		const CookedTexture& texture = model.textures[i];
+		if (!texture.pixels)
+			continue;
+
+		writer.Patch(textureRecords[i] + offsetof(FileTexture, dataOffset), writePayload(texture.pixels, texture.size));
+	}
+
+	for (size_t i = 0; i < model.primitives.size(); ++i)
+	{
+		const EncodedGeometry& geometry = model.primitives[i].geometry;
+
+		uint64_t vertexDataSize = static_cast<uint64_t>(GetVertexStride(geometry.vertexFormat)) * geometry.vertexCount;
+		uint64_t indexDataSize = static_cast<uint64_t>(geometry.indexType == VK_INDEX_TYPE_UINT32 ? 4 : 2) * geometry.indexCount;
+
+		writer.Patch(primitiveRecords[i] + offsetof(FilePrimitive, vertexDataOffset), writePayload(geometry.vertexData, vertexDataSize));
+		writer.Patch(primitiveRecords[i] + offsetof(FilePrimitive, indexDataOffset), writePayload(geometry.indexData, indexDataSize));
+	}
+}
+
+bool ModelCache::Deserialize(const uint8_t* data, size_t size, CookedModel& outModel, ModelSourceStamp& outStamp)
+{
+	ByteReader reader(data, size);
+
+	FileHeader header;
+	if (!reader.Read(header) || std::memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) != 0 || header.version != CacheVersion)
+		return false;
+
+	outStamp.file.size = header.sourceSize;
+	outStamp.file.writeTime = header.sourceWriteTime;
+	outStamp.file.contentHash = header.sourceHash;
+
+	outStamp.dependencies.resize(header.dependencyCount);
+	for (ModelDependencyStamp& dependency : outStamp.dependencies)
+	{
+		FileDependency fileDependency;
+		const uint8_t* path = nullptr;
+
+		if (!reader.Read(fileDependency) || !reader.ReadBytes(fileDependency.pathLength, path))
+			return false;
+
+		dependency.path.assign(reinterpret_cast<const char*>(path), fileDependency.pathLength);
+		dependency.file.size = fileDependency.size;
+		dependency.file.writeTime = fileDependency.writeTime;
+		dependency.file.contentHash = fileDependency.contentHash;
+	}
+
+	outModel = CookedModel{};
+
+	outModel.nodes.resize(header.nodeCount);
+	for (ModelNode& node : outModel.nodes)
+	{
+		FileNode fileNode;
+		const uint8_t* name = nullptr;
+		const uint8_t* children = nullptr;
+
+		if (!reader.Read(fileNode) || !reader.ReadBytes(fileNode.nameLength, name) || !reader.ReadBytes(static_cast<size_t>(fileNode.childCount) * sizeof(uint32_t), children))
+			return false;
+
+		node.name.assign(reinterpret_cast<const char*>(name), fileNode.nameLength);
+		node.position = glm::vec3(fileNode.position[0], fileNode.position[1], fileNode.position[2]);
+		node.rotation = glm::quat(fileNode.rotation[3], fileNode.rotation[0], fileNode.rotation[1], fileNode.rotation[2]);
+		node.scale = glm::vec3(fileNode.scale[0], fileNode.scale[1], fileNode.scale[2]);
+		node.meshIndex = fileNode.meshIndex < static_cast<int32_t>(header.meshCount) ? fileNode.meshIndex : -1;
+
+		node.children.resize(fileNode.childCount);
+		std::memcpy(node.children.data(), children, node.children.size() * sizeof(uint32_t));
+
+		for (uint32_t child : node.children)
+		{
+			if (child >= header.nodeCount)
+				return false;
+		}
+	}
+
+	const uint8_t* rootNodes = nullptr;
+	if (!reader.ReadBytes(static_cast<size_t>(header.rootNodeCount) * sizeof(uint32_t), rootNodes))
+		return false;
+
+	outModel.rootNodes.resize(header.rootNodeCount);
+	std::memcpy(outModel.rootNodes.data(), rootNodes, outModel.rootNodes.size() * sizeof(uint32_t));
+
+	for (uint32_t root : outModel.rootNodes)
+	{
+		if (root >= header.nodeCount)
+			return false;
+	}
+
+	outModel.textures.resize(header.textureCount);
+	for (CookedTexture& texture : outModel.textures)
+	{
+		FileTexture fileTexture;
+		if (!reader.Read(fileTexture))
+			return false;
+
+		texture.width = fileTexture.width;
+		texture.height = fileTexture.height;
+		if (fileTexture.format >= static_cast<uint32_t>(TextureFormat::Count) || fileTexture.type > static_cast<uint32_t>(TextureType::Occlusion))
+			return false;
+
+		texture.mipLevels = fileTexture.mipLevels;
+		texture.sRGB = (fileTexture.flags & TextureSRGB) != 0;
+		texture.format = static_cast<TextureFormat>(fileTexture.format);
+		texture.type = static_cast<TextureType>(fileTexture.type);
+		texture.contentHash = fileTexture.contentHash;
+
+		if (fileTexture.dataSize == 0)
+			continue;
+
+		if (fileTexture.mipLevels == 0 || fileTexture.mipLevels > GetMipLevelCount(fileTexture.width, fileTexture.height) ||
+			fileTexture.dataSize != GetTextureDataSize(texture.format, fileTexture.width, fileTexture.height, fileTexture.mipLevels) || !reader.GetPayload(fileTexture.dataOffset, fileTexture.dataSize, texture.pixels))
+			return false;
+
+		texture.size = static_cast<size_t>(fileTexture.dataSize);
+	}
+
+	outModel.meshes.resize(header.meshCount);
+	for (CookedMesh& mesh : outModel.meshes)
+	{
+		FileMesh fileMesh;
+		if (!reader.Read(fileMesh))
+			return false;
+
+		if (fileMesh.firstPrimitive > header.primitiveCount || fileMesh.primitiveCount > header.primitiveCount - fileMesh.firstPrimitive)
+			return false;
+
+		mesh.firstPrimitive = fileMesh.firstPrimitive;
+		mesh.primitiveCount = fileMesh.primitiveCount;
+	}
+
+	outModel.primitives.resize(header.primitiveCount);
+	for (CookedPrimitive& primitive : outModel.primitives)
+	{
+		FilePrimitive filePrimitive;
+		if (!reader.Read(filePrimitive))
+			return false;
+
+		if (filePrimitive.vertexFormat >= static_cast<uint32_t>(VertexFormat::Count))
+			return false;
+
+		EncodedGeometry& geometry = primitive.geometry;
+		geometry.vertexFormat = static_cast<VertexFormat>(filePrimitive.vertexFormat);
+		geometry.vertexCount = filePrimitive.vertexCount;
+		geometry.indexType = filePrimitive.indexType == 1 ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16;
+		geometry.indexCount = filePrimitive.indexCount;
+		std::memcpy(&geometry.dequantization.positionOffset, filePrimitive.positionOffset, sizeof(filePrimitive.positionOffset));
+		std::memcpy(&geometry.dequantization.positionScale, filePrimitive.positionScale, sizeof(filePrimitive.positionScale));
+		std::memcpy(&geometry.bounds.min, filePrimitive.boundsMin, sizeof(filePrimitive.boundsMin));
+		std::memcpy(&geometry.bounds.max, filePrimitive.boundsMax, sizeof(filePrimitive.boundsMax));
+		std::memcpy(&geometry.boundingSphere.center, filePrimitive.boundingSphere, sizeof(float) * 3);
+		geometry.boundingSphere.radius = filePrimitive.boundingSphere[3];
+
+		uint64_t vertexDataSize = static_cast<uint64_t>(GetVertexStride(geometry.vertexFormat)) * geometry.vertexCount;
+		uint64_t indexDataSize = static_cast<uint64_t>(geometry.indexType == VK_INDEX_TYPE_UINT32 ? 4 : 2) * geometry.indexCount;
+
+		const uint8_t* vertexData = nullptr;
+		const uint8_t* indexData = nullptr;
+		if (filePrimitive.vertexDataSize != vertexDataSize || filePrimitive.indexDataSize != indexDataSize ||
+			!reader.GetPayload(filePrimitive.vertexDataOffset, vertexDataSize, vertexData) || !reader.GetPayload(filePrimitive.indexDataOffset, indexDataSize, indexData))
+			return false;
+
+		geometry.vertexData = vertexData;
+		geometry.indexData = indexData;
+
+		primitive.baseColorFactor = glm::vec4(filePrimitive.baseColorFactor[0], filePrimitive.baseColorFactor[1], filePrimitive.baseColorFactor[2], filePrimitive.baseColorFactor[3]);
+		primitive.metallicFactor = filePrimitive.metallicFactor;
+		primitive.roughnessFactor = filePrimitive.roughnessFactor;
+
+		int32_t* textureIndices[3] = {&primitive.baseColorTexture, &primitive.metallicRoughnessTexture, &primitive.normalTexture};
+		for (int i = 0; i < 3; ++i)
+			*textureIndices[i] = filePrimitive.textures[i] >= 0 && filePrimitive.textures[i] < static_cast<int32_t>(header.textureCount) ? filePrimitive.textures[i] : -1;
+
+		primitive.enableTransparency = (filePrimitive.flags & PrimitiveTransparent) != 0;
+		primitive.doubleSided = (filePrimitive.flags & PrimitiveDoubleSided) != 0;
+	}
+
+	return true;
+}
@@ -0,0 +1,85 @@
+#include <Core/ModelLoadRequest.h>
+
+#include <Core/MappedFile.h>
+#include <Vulkan/UploadBatch.h>
+
+using namespace VulkanRenderer;
+
+ModelLoadRequest::ModelLoadRequest(const std::string& name, const std::filesystem::path& path)
+	: name(name), path(path)
+{
+
+}
+
+ModelLoadRequest::~ModelLoadRequest()
+{
+
+}
+
+const std::string& ModelLoadRequest::GetName() const
+{
+	return name;
+}
+
+const std::filesystem::path& ModelLoadRequest::GetPath() const
+{
+	return path;
+}
+
+ModelLoadState ModelLoadRequest::GetState() const
+{
+	return state.load();
+}
+
+const char* ModelLoadRequest::GetStateName(ModelLoadState state)
+{
+	switch (state)
+	{
+	case ModelLoadState::Queued:
+		return "Queued";
+	case ModelLoadState::Parsing:
+		return "Parsing";
+	case ModelLoadState::Decoding:
+		return "Decoding";
+	case ModelLoadState::Uploading:
+		return "Uploading";
+	case ModelLoadState::Completed:
+		return "Completed";
+	case ModelLoadState::Failed:
+		return "Failed";
+	case ModelLoadState::Cancelled:
+		return "Cancelled";
+	default:
+		return "Unknown";
+	}
+}
+
+float ModelLoadRequest::GetProgress() const
+{
+	if (state.load() == ModelLoadState::Completed)
+		return 1.0f;
+
+	uint32_t total = totalSteps.load();
+	return total > 0 ? static_cast<float>(completedSteps.load()) / static_cast<float>(total) : 0.0f;
+}
+
+bool ModelLoadRequest::IsDone() const
+{
+	ModelLoadState current = state.load();
+	return current == ModelLoadState::Completed || current == ModelLoadState::Failed || current == ModelLoadState::Cancelled;
+}
+
+void ModelLoadRequest::Cancel()
+{
+	cancelled = true;
+}
+
+bool ModelLoadRequest::IsCancelled() const
+{
+	return cancelled.load();
+}
+
+std::shared_ptr<Model> ModelLoadRequest::GetModel() const
+{
+	return state.load() == ModelLoadState::Completed ? model : nullptr;
+}
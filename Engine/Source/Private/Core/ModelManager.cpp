@@ -3,27 +3,65 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <cstddef>
 
 #include <stb_image.h>
 
+#include <Core/ThreadPool.h>
 #include <Core/Transform.h>
 #include <Core/Model.h>
+#include <Core/ModelLoadRequest.h>
 #include <Core/Mesh.h>
 #include <Core/MeshPrimitive.h>
 #include <Core/MeshInstance.h>
+#include <Core/MeshOptimizer.h>
+#include <Core/MipChain.h>
+#include <Core/TextureCompression.h>
+#include <Core/ModelCache.h>
+#include <Core/MappedFile.h>
+#include <Core/GltfFile.h>
+#include <Core/AccessorReader.h>
+#include <Core/Hash.h>
+#include <Core/Ktx2.h>
+#include <Core/TextureStreamer.h>
+#include <Vulkan/Device.h>
 #include <Vulkan/Texture.h>
+#include <Vulkan/UploadBatch.h>
 
 using namespace VulkanRenderer;
 
-ModelManager::ModelManager(VulkanDevice* device, VkDescriptorSetLayout uniformDescriptorSetLayout, VkDescriptorSetLayout materialDescriptorSetLayout, VkDescriptorPool descriptorPool)
-	: device(device), uniformDescriptorSetLayout(uniformDescriptorSetLayout), materialDescriptorSetLayout(materialDescriptorSetLayout), descriptorPool(descriptorPool)
+// Render thread time Update may spend finalizing loads each frame
+static constexpr double UploadBudgetMilliseconds = 4.0;
+
+// Staging memory a load may fill before its current upload batch is submitted
+static constexpr VkDeviceSize MaxUploadBatchStaging = 256 * 1024 * 1024;
+
+ModelManager::ModelManager(VulkanDevice* device, VulkanGeometryArena* geometryArena, VkDescriptorSetLayout materialDescriptorSetLayout, VkDescriptorPool descriptorPool)
+	: device(device), geometryArena(geometryArena), materialDescriptorSetLayout(materialDescriptorSetLayout), descriptorPool(descriptorPool)
 {
 	fallbackTexture = CreateFallbackTexture(glm::vec4(1.0f));
+
+	threadPool = std::make_unique<ThreadPool>();
 }
 
 ModelManager::~ModelManager()
 {
+	// Stop in-flight imports before the state they write to goes away
+	for (const auto& request : pendingLoads)
+		request->Cancel();
+
+	// Imports past their cancellation check still use the pool, let them drain while it is alive
+	for (const auto& request : pendingLoads)
+	{
+		if (request->importTask.valid())
+			request->importTask.wait();
+	}
 
+	threadPool.reset();
+	textureStreamer.reset();
 }
 
 const std::unordered_map<std::string, std::shared_ptr<Model>>& ModelManager::GetModels()
@@ -33,354 +71,911 @@ const std::unordered_map<std::string, std::shared_ptr<Model>>& ModelManager::Get
 
 std::shared_ptr<Model> ModelManager::GetModel(const std::string& name)
 {
-	return models[name];
+	auto it = models.find(name);
+	return it != models.end() ? it->second : nullptr;
+}
+
+const std::vector<std::shared_ptr<ModelLoadRequest>>& ModelManager::GetPendingLoads() const
+{
+	return pendingLoads;
+}
+
+void ModelManager::SetCacheDirectory(const std::filesystem::path& directory)
+{
+	modelCache = directory.empty() ? nullptr : std::make_unique<ModelCache>(directory);
+}
+
+void ModelManager::SetTextureCompression(bool enabled)
+{
+	compressTextures = enabled && device->SupportsTextureCompressionBC();
+}
+
+void ModelManager::SetTextureStreaming(bool enabled, VkDeviceSize budget)
+{
+	textureStreamer = enabled ? std::make_unique<TextureStreamer>(device, budget) : nullptr;
+}
+
+TextureStreamer* ModelManager::GetTextureStreamer() const
+{
+	return textureStreamer.get();
 }
 
 std::shared_ptr<Model> ModelManager::LoadModel(const std::string& name, const std::filesystem::path& path)
+{
+	std::shared_ptr<ModelLoadRequest> request = LoadModelAsync(name, path);
+
+	if (request->importTask.valid())
+		request->importTask.wait();
+
+	while (!request->IsDone())
+		FinalizeLoad(*request, 0.0);
+
+	pendingLoads.erase(std::remove(pendingLoads.begin(), pendingLoads.end(), request), pendingLoads.end());
+
+	return request->GetModel();
+}
+
+std::shared_ptr<ModelLoadRequest> ModelManager::LoadModelAsync(const std::string& name, const std::filesystem::path& path)
 {
 	auto it = models.find(name);
 	if (it != models.end())
 	{
-		return it->second;
+		auto request = std::make_shared<ModelLoadRequest>(name, path);
+		request->model = it->second;
+		request->state = ModelLoadState::Completed;
+		return request;
 	}
-	
-	fastgltf::Parser parser;
 
-	auto data = fastgltf::GltfDataBuffer::FromPath(path);
-	if (data.error() != fastgltf::Error::None)
+	for (const auto& pending : pendingLoads)
 	{
-		std::cout << "fastgltf get buffer error: " << fastgltf::getErrorMessage(data.error()) << std::endl;
-		return false;
+		if (pending->GetName() == name && !pending->IsCancelled())
+			return pending;
+	}
+
+	auto request = std::make_shared<ModelLoadRequest>(name, path);
+	pendingLoads.push_back(request);
+
+	request->importTask = threadPool->Submit([this, request]()
+		{
+			ImportModel(*request);
+		});
+
+	return request;
+}
+
+void ModelManager::Update()
+{
+	auto elapsedMilliseconds = [start = std::chrono::steady_clock::now()]()
+		{
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		};
+
+	for (const auto& request : pendingLoads)
+	{
+		// Imports that are still parsing or decoding never block the render thread
+		if (request->importTask.valid() && request->importTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			continue;
+
+		double remaining = UploadBudgetMilliseconds - elapsedMilliseconds();
+		if (remaining <= 0.0)
+			break;
+
+		FinalizeLoad(*request, remaining);
 	}
-	
-	auto asset = parser.loadGltfBinary(data.get(), path.parent_path(), fastgltf::Options::None);
+
+	pendingLoads.erase(std::remove_if(pendingLoads.begin(), pendingLoads.end(),
+		[](const std::shared_ptr<ModelLoadRequest>& request)
+		{
+			return request->IsDone();
+		}), pendingLoads.end());
+}
+
+void ModelManager::ImportModel(ModelLoadRequest& request)
+{
+	if (request.IsCancelled())
+	{
+		request.state = ModelLoadState::Cancelled;
+		return;
+	}
+
+	request.state = ModelLoadState::Parsing;
+
+	// Warm start, everything is already cooked and only needs mapping
+	if (modelCache)
+	{
+		request.cacheFile = modelCache->Open(request.path, request.cooked);
+
+		bool matchesCompression = std::all_of(request.cooked.textures.begin(), request.cooked.textures.end(), [this](const CookedTexture& texture)
+			{
+				if (!texture.pixels)
+					return true;
+
+				// Block formats may also come pre-compressed from KTX2 images, so only their support is checked
+				return texture.format == TextureFormat::RGBA8 ? !compressTextures : device->SupportsTextureCompressionBC();
+			});
+
+		if (request.cacheFile && matchesCompression)
+		{
+			BeginUpload(request);
+			return;
+		}
+
+		request.cacheFile.reset();
+		request.cooked = CookedModel();
+	}
+
+	GltfFile source(request.path);
+	if (!source.IsValid())
+	{
+		std::cerr << "Failed to open model: " << request.path.string() << std::endl;
+		request.state = ModelLoadState::Failed;
+		return;
+	}
+
+	ModelSourceStamp stamp;
+	ModelCache::GetFileStamp(request.path, stamp.file);
+	stamp.file.contentHash = HashBytes(source.GetData(), source.GetSize());
+
+	// KHR_texture_basisu is only enabled so assets that require it still parse, textures are loaded from their regular source
+	fastgltf::Parser parser(fastgltf::Extensions::KHR_texture_basisu);
+
+	// Buffers and images stay in their mappings, so the import never holds a second copy of the file
+	auto asset = source.Load(parser);
 	if (asset.error() != fastgltf::Error::None)
 	{
 		std::cout << "fastgltf get data error: " << fastgltf::getErrorMessage(asset.error()) << std::endl;
-		return false;
+		request.state = ModelLoadState::Failed;
+		return;
 	}
-	
-	std::shared_ptr<Model> model = std::make_shared<Model>();
-	model->name = name;
-	model->gltfAsset = std::move(asset.get());
 
-	auto& gltfAsset = model->gltfAsset;
+	const fastgltf::Asset& gltfAsset = asset.get();
+
+	// Buffers and images referenced by URI are cooked in as well, the cache has to notice when they change
+	std::vector<GltfFile::ReferencedFile> referencedFiles = source.GetReferencedFiles(gltfAsset);
+	stamp.dependencies.resize(referencedFiles.size());
+
+	threadPool->ParallelFor(referencedFiles.size(), [&](size_t fileIndex)
+		{
+			const GltfFile::ReferencedFile& referenced = referencedFiles[fileIndex];
+			ModelDependencyStamp& dependency = stamp.dependencies[fileIndex];
 
-	LoadTextures(model);
-	
+			dependency.path = referenced.path.generic_u8string();
+			ModelCache::GetFileStamp(request.path.parent_path() / referenced.path, dependency.file);
+			dependency.file.contentHash = HashBytes(referenced.file->GetData(), referenced.file->GetSize());
+		});
+
+	// Flatten every primitive so each one can be processed as an independent job
+	std::vector<std::pair<size_t, size_t>> primitiveIndices;
 	for (size_t meshIndex = 0; meshIndex < gltfAsset.meshes.size(); ++meshIndex)
 	{
-		const fastgltf::Mesh& gltfMesh = gltfAsset.meshes[meshIndex];
-		
-		auto mesh = std::make_shared<Mesh>(device, uniformDescriptorSetLayout);
+		for (size_t primitiveIndex = 0; primitiveIndex < gltfAsset.meshes[meshIndex].primitives.size(); ++primitiveIndex)
+			primitiveIndices.emplace_back(meshIndex, primitiveIndex);
+	}
+
+	size_t imageCount = gltfAsset.images.size();
+	size_t jobCount = imageCount + primitiveIndices.size();
+
+	// Parsing, every decode job and every texture and mesh upload count as one step
+	request.totalSteps = static_cast<uint32_t>(1 + jobCount + gltfAsset.textures.size() + gltfAsset.meshes.size());
+	request.completedSteps = 1;
+	request.state = ModelLoadState::Decoding;
 
-		for (size_t primitiveIndex = 0; primitiveIndex < gltfMesh.primitives.size(); ++primitiveIndex)
+	// Owns the cooked payloads until they are serialized
+	struct EncodedPrimitive
+	{
+		std::vector<uint8_t> vertexData;
+		std::vector<uint8_t> indexData;
+	};
+
+	// Base color textures hold color data, everything else is linear
+	std::vector<bool> sRGBTextures(gltfAsset.textures.size(), false);
+	for (const auto& material : gltfAsset.materials)
+	{
+		if (material.pbrData.baseColorTexture.has_value() && material.pbrData.baseColorTexture->textureIndex < sRGBTextures.size())
+			sRGBTextures[material.pbrData.baseColorTexture->textureIndex] = true;
+	}
+
+	// Role of each image decides its block format and whether its mips are filtered in linear space
+	std::vector<TextureType> imageTypes(imageCount, TextureType::Unknown);
+	auto assignImageType = [&](size_t textureIndex, TextureType type)
 		{
-			const fastgltf::Primitive& primitive = gltfMesh.primitives[primitiveIndex];
-			
-			auto positionIt = primitive.findAttribute("POSITION");
-			auto normalIt = primitive.findAttribute("NORMAL");
-			auto tangentIt = primitive.findAttribute("TANGENT");
-			
-			MeshPrimitiveInfo primitiveInfo{};
-			
-			if (positionIt != primitive.attributes.end())
-			{
-				const auto& positionAccessor = gltfAsset.accessors[positionIt->accessorIndex];
-				primitiveInfo.vertices.resize(positionAccessor.count);
+			if (textureIndex >= gltfAsset.textures.size())
+				return;
 
-				fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec3>(gltfAsset, positionAccessor, [&](fastgltf::math::fvec3 position, std::size_t verticeIndex)
-					{
-						primitiveInfo.vertices[verticeIndex].position = glm::vec3(position.x(), position.y(), position.z());
-					});
-			}
+			const auto& imageIndex = gltfAsset.textures[textureIndex].imageIndex;
+			if (imageIndex.has_value() && imageIndex.value() < imageCount && imageTypes[imageIndex.value()] == TextureType::Unknown)
+				imageTypes[imageIndex.value()] = type;
+		};
 
-			if (normalIt != primitive.attributes.end())
-			{
-				auto& normalAccessor = gltfAsset.accessors[normalIt->accessorIndex];
-				fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec3>(gltfAsset, normalAccessor, [&](fastgltf::math::fvec3 normal, std::size_t verticeIndex)
-					{
-						//primitiveInfo.vertices[verticeIndex].normal = glm::vec3(normal.x(), normal.y(), normal.z());
-					});
-			}
+	for (const auto& material : gltfAsset.materials)
+	{
+		if (material.pbrData.baseColorTexture.has_value())
+			assignImageType(material.pbrData.baseColorTexture->textureIndex, TextureType::BaseColor);
+		if (material.pbrData.metallicRoughnessTexture.has_value())
+			assignImageType(material.pbrData.metallicRoughnessTexture->textureIndex, TextureType::MetallicRoughness);
+		if (material.normalTexture.has_value())
+			assignImageType(material.normalTexture->textureIndex, TextureType::Normal);
+	}
 
-			if (tangentIt != primitive.attributes.end())
-			{
-				auto& tangentAccessor = gltfAsset.accessors[tangentIt->accessorIndex];
-				fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec4>(gltfAsset, tangentAccessor, [&](fastgltf::math::fvec4 tangent, std::size_t verticeIndex)
-					{
-						//primitiveInfo.vertices[verticeIndex].tangent = glm::vec4(tangent.x(), tangent.y(), tangent.z(), tangent.w());
-					});
-			}
+	// KHR_texture_basisu images hold Basis Universal payloads, which cannot be transcoded, so images used by nothing else are not decoded
+	std::vector<bool> basisuOnlyImages(imageCount, false);
+	for (const auto& texture : gltfAsset.textures)
+	{
+		if (texture.basisuImageIndex.has_value() && texture.basisuImageIndex.value() < imageCount)
+			basisuOnlyImages[texture.basisuImageIndex.value()] = true;
+	}
+	for (const auto& texture : gltfAsset.textures)
+	{
+		if (texture.imageIndex.has_value() && texture.imageIndex.value() < imageCount)
+			basisuOnlyImages[texture.imageIndex.value()] = false;
+	}
 
-			if (primitive.indicesAccessor.has_value())
-			{
-				const auto& indexAccessor = gltfAsset.accessors[primitive.indicesAccessor.value()];
-				fastgltf::iterateAccessorWithIndex<std::uint16_t>(gltfAsset, indexAccessor, [&](std::uint16_t index, std::size_t verticeIndex)
-					{
-						primitiveInfo.indices.push_back(index);
-					});
-			}
+	std::vector<ImageData> decodedImages(imageCount);
+	std::vector<EncodedPrimitive> encodedPrimitives(primitiveIndices.size());
 
-			std::size_t baseColorTexcoordIndex = 0;
-			std::size_t metallicRoughnessTexcoordIndex = 0;
-			std::size_t normalTexcoordIndex = 0;
-			if (primitive.materialIndex.has_value())
-			{
-				auto& material = gltfAsset.materials[primitive.materialIndex.value()];
+	CookedModel cooked;
+	cooked.primitives.resize(primitiveIndices.size());
 
-				primitiveInfo.doubleSided = material.doubleSided;
+	// Image decodes and accessor reads only read the parsed asset, so they all run on the pool together
+	threadPool->ParallelFor(jobCount, [&](size_t job)
+		{
+			if (request.IsCancelled())
+				return;
 
-				const auto& baseColorFactor = material.pbrData.baseColorFactor;
-				primitiveInfo.baseColorFactor = glm::vec4(baseColorFactor.x(), baseColorFactor.y(), baseColorFactor.z(), baseColorFactor.w());
-				
-				auto& baseColorTexture = material.pbrData.baseColorTexture;
-				if (baseColorTexture.has_value())
-				{
-					auto& texture = gltfAsset.textures[baseColorTexture->textureIndex];
-					if (texture.imageIndex.has_value())
-					{
-						if (baseColorTexture->transform && baseColorTexture->transform->texCoordIndex.has_value())
-						{
-							baseColorTexcoordIndex = baseColorTexture->transform->texCoordIndex.value();
-						}
-						else
-						{
-							baseColorTexcoordIndex = material.pbrData.baseColorTexture->texCoordIndex;
-						}
-					}
-				}
-				
-				primitiveInfo.metallicFactor = material.pbrData.metallicFactor;
-				primitiveInfo.roughnessFactor = material.pbrData.roughnessFactor;
-				
-				auto& metallicRoughnessTexture = material.pbrData.metallicRoughnessTexture;
-				if (metallicRoughnessTexture.has_value())
+			if (job < imageCount)
+			{
+				ImageData& image = decodedImages[job];
+				if (!basisuOnlyImages[job] && DecodeImage(source, gltfAsset, job, image))
 				{
-					auto& texture = gltfAsset.textures[metallicRoughnessTexture->textureIndex];
-					if (texture.imageIndex.has_value())
+					// Pre-compressed images already carry their mips
+					if (image.format == TextureFormat::RGBA8)
 					{
-						if (metallicRoughnessTexture->transform && metallicRoughnessTexture->transform->texCoordIndex.has_value())
-						{
-							metallicRoughnessTexcoordIndex = metallicRoughnessTexture->transform->texCoordIndex.value();
-						}
-						else
+						uint32_t width = static_cast<uint32_t>(image.width);
+						uint32_t height = static_cast<uint32_t>(image.height);
+						GenerateMipChain(image.pixels, width, height, imageTypes[job] == TextureType::BaseColor);
+						image.mipLevels = GetMipLevelCount(width, height);
+
+						if (compressTextures)
 						{
-							metallicRoughnessTexcoordIndex = material.pbrData.baseColorTexture->texCoordIndex;
+							image.format = ChooseCompressedFormat(imageTypes[job], image.pixels.data(), width, height);
+
+							std::vector<uint8_t> compressed;
+							CompressTexture(image.pixels.data(), width, height, image.mipLevels, imageTypes[job], image.format, compressed);
+							image.pixels.swap(compressed);
 						}
 					}
 				}
-
-				auto& normalTexture = material.normalTexture;
-				if (normalTexture.has_value())
+				else if (!basisuOnlyImages[job])
 				{
-					auto& texture = gltfAsset.textures[normalTexture->textureIndex];
-					if (texture.imageIndex.has_value())
-					{
-						if (normalTexture->transform && normalTexture->transform->texCoordIndex.has_value())
-						{
-							normalTexcoordIndex = normalTexture->transform->texCoordIndex.value();
-						}
-						else
-						{
-							normalTexcoordIndex = material.normalTexture->texCoordIndex;
-						}
-					}
+					std::cerr << "Failed to decode image at index " << job << std::endl;
 				}
 			}
+			else
+			{
+				size_t primitiveJob = job - imageCount;
+				const auto& [meshIndex, primitiveIndex] = primitiveIndices[primitiveJob];
+				const fastgltf::Primitive& primitive = gltfAsset.meshes[meshIndex].primitives[primitiveIndex];
+
+				MeshPrimitiveInfo info;
+				ProcessPrimitive(source, gltfAsset, primitive, info);
+				CookPrimitive(gltfAsset, primitive, info, cooked.primitives[primitiveJob]);
+
+				EncodedPrimitive& encoded = encodedPrimitives[primitiveJob];
+				EncodedGeometry& geometry = cooked.primitives[primitiveJob].geometry;
+				geometry.vertexFormat = EncodeVertices(info.vertices, encoded.vertexData, geometry.dequantization);
+				geometry.vertexData = encoded.vertexData.data();
+				geometry.vertexCount = static_cast<uint32_t>(info.vertices.size());
+				geometry.indexType = EncodeIndices(info.indices, info.vertices.size(), encoded.indexData);
+				geometry.indexData = encoded.indexData.data();
+				geometry.indexCount = static_cast<uint32_t>(info.indices.size());
+				geometry.bounds = ComputeBounds(info.vertices);
+				geometry.boundingSphere = ComputeBoundingSphere(info.vertices, geometry.bounds);
+			}
+
+			++request.completedSteps;
+		});
+
+	if (request.IsCancelled())
+	{
+		request.state = ModelLoadState::Cancelled;
+		return;
+	}
+
+	ReadNodes(gltfAsset, cooked);
+
+	cooked.textures.resize(gltfAsset.textures.size());
+	for (size_t textureIndex = 0; textureIndex < gltfAsset.textures.size(); ++textureIndex)
+	{
+		const fastgltf::Texture& gltfTexture = gltfAsset.textures[textureIndex];
+		const auto& imageIndex = gltfTexture.imageIndex;
+
+		if (!imageIndex.has_value() && gltfTexture.basisuImageIndex.has_value())
+			std::cerr << "Texture " << textureIndex << " only has a KHR_texture_basisu source, which needs a Basis Universal transcoder." << std::endl;
 
-			auto baseColorTexcoordAttribute = std::string("TEXCOORD_") + std::to_string(baseColorTexcoordIndex);
-			if (const auto* texcoord = primitive.findAttribute(baseColorTexcoordAttribute); texcoord != primitive.attributes.end())
+		if (!imageIndex.has_value() || imageIndex.value() >= decodedImages.size() || decodedImages[imageIndex.value()].pixels.empty())
+			continue;
+
+		const ImageData& image = decodedImages[imageIndex.value()];
+
+		CookedTexture& texture = cooked.textures[textureIndex];
+		texture.width = static_cast<uint32_t>(image.width);
+		texture.height = static_cast<uint32_t>(image.height);
+		texture.mipLevels = image.mipLevels;
+		texture.sRGB = sRGBTextures[textureIndex];
+		texture.format = image.format;
+		texture.type = imageTypes[imageIndex.value()];
+
+		// The same source bytes only make the same GPU texture when they are cooked the same way
+		uint32_t textureKey[3] = {static_cast<uint32_t>(texture.format), static_cast<uint32_t>(texture.type), texture.sRGB ? 1u : 0u};
+		texture.contentHash = image.contentHash ? HashBytes(textureKey, sizeof(textureKey), image.contentHash) : 0;
+		texture.pixels = image.pixels.data();
+		texture.size = image.pixels.size();
+	}
+
+	uint32_t firstPrimitive = 0;
+	for (const auto& gltfMesh : gltfAsset.meshes)
+	{
+		CookedMesh mesh;
+		mesh.firstPrimitive = firstPrimitive;
+		mesh.primitiveCount = static_cast<uint32_t>(gltfMesh.primitives.size());
+		cooked.meshes.push_back(mesh);
+
+		firstPrimitive += mesh.primitiveCount;
+	}
+
+	// Cold and warm starts upload from the same cooked layout, so the views are rebuilt over the serialized bytes
+	ModelCache::Serialize(cooked, stamp, request.cookedBytes);
+	ModelCache::Deserialize(request.cookedBytes.data(), request.cookedBytes.size(), request.cooked, stamp);
+
+	if (modelCache)
+		modelCache->Write(request.path, request.cookedBytes);
+
+	BeginUpload(request);
+}
+
+void ModelManager::BeginUpload(ModelLoadRequest& request)
+{
+	const CookedModel& cooked = request.cooked;
+
+	std::shared_ptr<Model> model = std::make_shared<Model>();
+	model->name = request.name;
+	model->nodes = cooked.nodes;
+	model->rootNodes = cooked.rootNodes;
+
+	// A warm start skips straight here, so parsing is its only finished step
+	if (request.cacheFile)
+	{
+		request.totalSteps = static_cast<uint32_t>(1 + cooked.textures.size() + cooked.meshes.size());
+		request.completedSteps = 1;
+	}
+
+	if (textureStreamer)
+	{
+		request.streamingSource = std::make_shared<TextureStreamingSource>();
+
+		if (request.cacheFile)
+		{
+			// Moving the mapping keeps every cooked view valid
+			request.streamingSource->file = std::move(request.cacheFile);
+		}
+		else
+		{
+			// Only texture payloads outlive the load, geometry is released with cookedBytes once it is staged
+			size_t textureBytes = 0;
+			for (const CookedTexture& texture : request.cooked.textures)
+				textureBytes += texture.pixels ? texture.size : 0;
+
+			std::vector<uint8_t>& bytes = request.streamingSource->bytes;
+			bytes.reserve(textureBytes);
+
+			for (CookedTexture& texture : request.cooked.textures)
 			{
-				auto& texcoordAccessor = gltfAsset.accessors[texcoord->accessorIndex];
-				if (texcoordAccessor.bufferViewIndex.has_value())
-				{
-					fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec2>(gltfAsset, texcoordAccessor, [&](fastgltf::math::fvec2 uv, std::size_t idx)
-						{
-							primitiveInfo.vertices[idx].baseColorTexCoord = glm::vec2(uv.x(), uv.y());
-						});
-				}
+				if (!texture.pixels)
+					continue;
+
+				size_t offset = bytes.size();
+				bytes.insert(bytes.end(), texture.pixels, texture.pixels + texture.size);
+				texture.pixels = bytes.data() + offset;
 			}
+		}
+	}
+
+	request.model = std::move(model);
+	request.state = ModelLoadState::Uploading;
+}
+
+void ModelManager::ReadNodes(const fastgltf::Asset& asset, CookedModel& outModel)
+{
+	outModel.nodes.resize(asset.nodes.size());
+
+	for (size_t nodeIndex = 0; nodeIndex < asset.nodes.size(); ++nodeIndex)
+	{
+		const fastgltf::Node& node = asset.nodes[nodeIndex];
+		ModelNode& modelNode = outModel.nodes[nodeIndex];
+
+		fastgltf::math::fvec3 gltfTranslation(0.0f, 0.0f, 0.0f);
+		fastgltf::math::fquat gltfRotation;
+		fastgltf::math::fvec3 gltfScale(1.0f, 1.0f, 1.0f);
+
+		if (auto* transform = std::get_if<fastgltf::math::fmat4x4>(&node.transform))
+		{
+			fastgltf::math::decomposeTransformMatrix(*transform, gltfScale, gltfRotation, gltfTranslation);
+		}
+		else if (auto* trs = std::get_if<fastgltf::TRS>(&node.transform))
+		{
+			gltfTranslation = trs->translation;
+			gltfRotation = trs->rotation;
+			gltfScale = trs->scale;
+		}
+
+		modelNode.name = node.name.c_str();
+		modelNode.position = glm::vec3(gltfTranslation.x(), gltfTranslation.y(), gltfTranslation.z());
+		modelNode.rotation = glm::quat(gltfRotation.w(), gltfRotation.x(), gltfRotation.y(), gltfRotation.z());
+		modelNode.scale = glm::vec3(gltfScale.x(), gltfScale.y(), gltfScale.z());
+
+		if (node.meshIndex.has_value() && node.meshIndex.value() < asset.meshes.size())
+			modelNode.meshIndex = static_cast<int32_t>(node.meshIndex.value());
+
+		for (size_t childIndex : node.children)
+		{
+			if (childIndex < asset.nodes.size())
+				modelNode.children.push_back(static_cast<uint32_t>(childIndex));
+		}
+	}
+
+	if (asset.scenes.empty())
+		return;
+
+	size_t sceneIndex = asset.defaultScene.value_or(0);
+	if (sceneIndex >= asset.scenes.size())
+		sceneIndex = 0;
 
-			auto metallicRoughnessTexcoordAttribute = std::string("TEXCOORD_") + std::to_string(metallicRoughnessTexcoordIndex);
-			if (const auto* texcoord = primitive.findAttribute(metallicRoughnessTexcoordAttribute); texcoord != primitive.attributes.end())
+	for (size_t rootNodeIndex : asset.scenes[sceneIndex].nodeIndices)
+	{
+		if (rootNodeIndex < asset.nodes.size())
+			outModel.rootNodes.push_back(static_cast<uint32_t>(rootNodeIndex));
+	}
+}
+
+void ModelManager::FinalizeLoad(ModelLoadRequest& request, double budgetMilliseconds)
+{
+	if (request.IsDone())
+		return;
+
+	// Dropping the request releases anything already uploaded
+	if (request.IsCancelled())
+	{
+		request.state = ModelLoadState::Cancelled;
+		return;
+	}
+
+	if (request.GetState() != ModelLoadState::Uploading)
+		return;
+
+	auto start = std::chrono::steady_clock::now();
+	auto overBudget = [&]()
+		{
+			return budgetMilliseconds > 0.0 && std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= budgetMilliseconds;
+		};
+
+	Model& model = *request.model;
+	const CookedModel& cooked = request.cooked;
+
+	// Uploads are recorded into a few large batches on the render thread, each submitted once with a single fence
+	auto currentBatch = [&]()
+		{
+			if (request.uploadBatches.empty() || request.uploadBatches.back()->IsSubmitted())
+				request.uploadBatches.push_back(std::make_unique<VulkanUploadBatch>(device));
+			return request.uploadBatches.back().get();
+		};
+
+	auto submitIfFull = [&](VulkanUploadBatch* batch)
+		{
+			if (batch->GetStagingSize() >= MaxUploadBatchStaging)
+				batch->Submit();
+		};
+
+	while (request.nextTexture < cooked.textures.size())
+	{
+		if (overBudget())
+			return;
+
+		VulkanUploadBatch* batch = currentBatch();
+		CreateTexture(request, request.nextTexture++, batch);
+		submitIfFull(batch);
+
+		++request.completedSteps;
+	}
+
+	while (request.nextMesh < cooked.meshes.size())
+	{
+		if (overBudget())
+			return;
+
+		const CookedMesh& cookedMesh = cooked.meshes[request.nextMesh++];
+		
+		auto mesh = std::make_shared<Mesh>(device);
+
+		VulkanUploadBatch* batch = currentBatch();
+		for (uint32_t i = 0; i < cookedMesh.primitiveCount; ++i)
+		{
+			const CookedPrimitive& cookedPrimitive = cooked.primitives[cookedMesh.firstPrimitive + i];
+
+			MeshPrimitiveInfo primitiveInfo;
+			primitiveInfo.baseColorFactor = cookedPrimitive.baseColorFactor;
+			primitiveInfo.metallicFactor = cookedPrimitive.metallicFactor;
+			primitiveInfo.roughnessFactor = cookedPrimitive.roughnessFactor;
+			primitiveInfo.enableTransparency = cookedPrimitive.enableTransparency;
+			primitiveInfo.doubleSided = cookedPrimitive.doubleSided;
+			primitiveInfo.encodedGeometry = &cookedPrimitive.geometry;
+			AssignTextures(model, cookedPrimitive, primitiveInfo);
+
+			auto meshPrimitive = std::make_unique<MeshPrimitive>(device, geometryArena, materialDescriptorSetLayout, descriptorPool, primitiveInfo, batch);
+			mesh->AddPrimitive(std::move(meshPrimitive));
+		}
+		submitIfFull(batch);
+		
+		model.meshes.push_back(mesh);
+		++request.completedSteps;
+	}
+
+	// Every payload now lives in staging memory
+	request.cooked = CookedModel{};
+	request.cacheFile.reset();
+	std::vector<uint8_t>().swap(request.cookedBytes);
+
+	if (!request.uploadBatches.empty())
+		request.uploadBatches.back()->Submit();
+
+	// Poll without blocking unless the caller asked to finish in one call
+	for (const auto& batch : request.uploadBatches)
+	{
+		if (budgetMilliseconds <= 0.0)
+			batch->Wait();
+		else if (!batch->IsComplete())
+			return;
+	}
+
+	request.uploadBatches.clear();
+
+	for (const auto& [contentHash, texture] : request.createdTextures)
+		textureCache[contentHash] = texture;
+	request.createdTextures.clear();
+
+	// Only publish once everything is resident
+	models[request.name] = request.model;
+	request.state = ModelLoadState::Completed;
+}
+
+void ModelManager::ProcessPrimitive(const GltfFile& file, const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, MeshPrimitiveInfo& outInfo)
+{
+	std::size_t baseColorTexcoordIndex = 0;
+	std::size_t metallicRoughnessTexcoordIndex = 0;
+	std::size_t normalTexcoordIndex = 0;
+	if (primitive.materialIndex.has_value())
+	{
+		auto& material = asset.materials[primitive.materialIndex.value()];
+
+		outInfo.doubleSided = material.doubleSided;
+
+		const auto& baseColorFactor = material.pbrData.baseColorFactor;
+		outInfo.baseColorFactor = glm::vec4(baseColorFactor.x(), baseColorFactor.y(), baseColorFactor.z(), baseColorFactor.w());
+		
+		auto& baseColorTexture = material.pbrData.baseColorTexture;
+		if (baseColorTexture.has_value())
+		{
+			auto& texture = asset.textures[baseColorTexture->textureIndex];
+			if (texture.imageIndex.has_value())
 			{
-				auto& texcoordAccessor = gltfAsset.accessors[texcoord->accessorIndex];
-				if (texcoordAccessor.bufferViewIndex.has_value())
+				if (baseColorTexture->transform && baseColorTexture->transform->texCoordIndex.has_value())
 				{
-					fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec2>(gltfAsset, texcoordAccessor, [&](fastgltf::math::fvec2 uv, std::size_t idx)
-						{
-							primitiveInfo.vertices[idx].metallicRoughnessTexCoord = glm::vec2(uv.x(), uv.y());
-						});
+					baseColorTexcoordIndex = baseColorTexture->transform->texCoordIndex.value();
+				}
+				else
+				{
+					baseColorTexcoordIndex = material.pbrData.baseColorTexture->texCoordIndex;
 				}
 			}
-
-			auto normalTexcoordAttribute = std::string("TEXCOORD_") + std::to_string(normalTexcoordIndex);
-			if (const auto* texcoord = primitive.findAttribute(normalTexcoordAttribute); texcoord != primitive.attributes.end())
+		}
+		
+		outInfo.metallicFactor = material.pbrData.metallicFactor;
+		outInfo.roughnessFactor = material.pbrData.roughnessFactor;
+		
+		auto& metallicRoughnessTexture = material.pbrData.metallicRoughnessTexture;
+		if (metallicRoughnessTexture.has_value())
+		{
+			auto& texture = asset.textures[metallicRoughnessTexture->textureIndex];
+			if (texture.imageIndex.has_value())
 			{
-				auto& texcoordAccessor = gltfAsset.accessors[texcoord->accessorIndex];
-				if (texcoordAccessor.bufferViewIndex.has_value())
+				if (metallicRoughnessTexture->transform && metallicRoughnessTexture->transform->texCoordIndex.has_value())
 				{
-					fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec2>(gltfAsset, texcoordAccessor, [&](fastgltf::math::fvec2 uv, std::size_t idx)
-						{
-							primitiveInfo.vertices[idx].normalTexCoord = glm::vec2(uv.x(), uv.y());
-						});
+					metallicRoughnessTexcoordIndex = metallicRoughnessTexture->transform->texCoordIndex.value();
+				}
+				else
+				{
+					metallicRoughnessTexcoordIndex = material.pbrData.metallicRoughnessTexture->texCoordIndex;
 				}
 			}
-			
-			primitiveInfo.baseColorTexture = fallbackTexture;
-			primitiveInfo.metallicRoughnessTexture = fallbackTexture;
-			primitiveInfo.normalTexture = fallbackTexture;
+		}
 
-			if (primitive.materialIndex.has_value())
+		auto& normalTexture = material.normalTexture;
+		if (normalTexture.has_value())
+		{
+			auto& texture = asset.textures[normalTexture->textureIndex];
+			if (texture.imageIndex.has_value())
 			{
-				const auto& material = gltfAsset.materials[primitive.materialIndex.value()];
-
-				if (material.pbrData.baseColorTexture.has_value())
+				if (normalTexture->transform && normalTexture->transform->texCoordIndex.has_value())
 				{
-					const auto& texture = gltfAsset.textures[material.pbrData.baseColorTexture->textureIndex];
-					if (texture.imageIndex.has_value())
-					{
-						auto imageIndex = texture.imageIndex.value();
-						primitiveInfo.baseColorTexture = model->textures[imageIndex];
-					}
-				}
-				if (material.pbrData.metallicRoughnessTexture.has_value())
-				{
-					const auto& texture = gltfAsset.textures[material.pbrData.metallicRoughnessTexture->textureIndex];
-					if (texture.imageIndex.has_value())
-					{
-						auto imageIndex = texture.imageIndex.value();
-						primitiveInfo.metallicRoughnessTexture = model->textures[imageIndex];
-					}
+					normalTexcoordIndex = normalTexture->transform->texCoordIndex.value();
 				}
-				if (material.normalTexture.has_value())
+				else
 				{
-					const auto& texture = gltfAsset.textures[material.normalTexture->textureIndex];
-					if (texture.imageIndex.has_value())
-					{
-						auto imageIndex = texture.imageIndex.value();
-						primitiveInfo.normalTexture = model->textures[imageIndex];
-					}
+					normalTexcoordIndex = material.normalTexture->texCoordIndex;
 				}
 			}
-			
-			auto meshPrimitive = std::make_unique<MeshPrimitive>(device, materialDescriptorSetLayout, descriptorPool, primitiveInfo);
-			mesh->AddPrimitive(std::move(meshPrimitive));
 		}
-		
-		model->meshes.push_back(mesh);
 	}
-	
-	models[name] = model;
 
-	return model;
+	auto positionIt = primitive.findAttribute("POSITION");
+	if (positionIt != primitive.attributes.end())
+	{
+		const auto& positionAccessor = asset.accessors[positionIt->accessorIndex];
+		outInfo.vertices.resize(positionAccessor.count);
+
+		std::vector<VertexAttributeTarget> targets;
+		targets.push_back({&positionAccessor, offsetof(Vertex, position), 3});
+
+		auto addTexcoordTarget = [&](std::size_t texcoordIndex, size_t offset)
+			{
+				auto texcoordAttribute = std::string("TEXCOORD_") + std::to_string(texcoordIndex);
+				if (const auto* texcoord = primitive.findAttribute(texcoordAttribute); texcoord != primitive.attributes.end())
+					targets.push_back({&asset.accessors[texcoord->accessorIndex], offset, 2});
+			};
+
+		addTexcoordTarget(baseColorTexcoordIndex, offsetof(Vertex, baseColorTexCoord));
+		addTexcoordTarget(metallicRoughnessTexcoordIndex, offsetof(Vertex, metallicRoughnessTexCoord));
+		addTexcoordTarget(normalTexcoordIndex, offsetof(Vertex, normalTexCoord));
+
+		// Every attribute lands in the vertex array in one interleaving sweep
+		ReadVertexAttributes(file, asset, targets, outInfo.vertices.size(), outInfo.vertices.data(), sizeof(Vertex));
+	}
+
+	if (primitive.indicesAccessor.has_value())
+	{
+		const auto& indexAccessor = asset.accessors[primitive.indicesAccessor.value()];
+		outInfo.indices.resize(indexAccessor.count);
+		ReadIndices(file, asset, indexAccessor, outInfo.indices.data());
+	}
+	else
+	{
+		// Non-indexed primitives draw their vertices in order
+		outInfo.indices.resize(outInfo.vertices.size());
+		std::iota(outInfo.indices.begin(), outInfo.indices.end(), 0u);
+	}
+
+	// The pipelines draw triangle lists, other topologies are left untouched
+	if (primitive.type == fastgltf::PrimitiveType::Triangles)
+		OptimizeMesh(outInfo.vertices, outInfo.indices);
 }
 
-void ModelManager::LoadTextures(std::shared_ptr<Model>& model)
+void ModelManager::CookPrimitive(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, const MeshPrimitiveInfo& info, CookedPrimitive& outPrimitive)
 {
-	fastgltf::Asset& asset = model->gltfAsset;
-	
-	std::unordered_map<size_t, ImageData> decodedImages;
-	
-	for (size_t imageIndex = 0; imageIndex < asset.images.size(); ++imageIndex)
-	{
-		auto& image = asset.images[imageIndex];
+	outPrimitive.baseColorFactor = info.baseColorFactor;
+	outPrimitive.metallicFactor = info.metallicFactor;
+	outPrimitive.roughnessFactor = info.roughnessFactor;
+	outPrimitive.enableTransparency = info.enableTransparency;
+	outPrimitive.doubleSided = info.doubleSided;
+
+	if (!primitive.materialIndex.has_value())
+		return;
+
+	const auto& material = asset.materials[primitive.materialIndex.value()];
+
+	// Textures are keyed by glTF texture index, not image index
+	if (material.pbrData.baseColorTexture.has_value())
+		outPrimitive.baseColorTexture = static_cast<int32_t>(material.pbrData.baseColorTexture->textureIndex);
+	if (material.pbrData.metallicRoughnessTexture.has_value())
+		outPrimitive.metallicRoughnessTexture = static_cast<int32_t>(material.pbrData.metallicRoughnessTexture->textureIndex);
+	if (material.normalTexture.has_value())
+		outPrimitive.normalTexture = static_cast<int32_t>(material.normalTexture->textureIndex);
+}
 
-		ImageData data;
+void ModelManager::AssignTextures(const Model& model, const CookedPrimitive& primitive, MeshPrimitiveInfo& outInfo)
+{
+	auto findTexture = [&](int32_t textureIndex)
+		{
+			auto it = textureIndex >= 0 ? model.textures.find(static_cast<size_t>(textureIndex)) : model.textures.end();
+			return it != model.textures.end() ? it->second : fallbackTexture;
+		};
 
-		if (DecodeImage(asset, image, data.pixels, data.width, data.height, data.channels))
-			decodedImages[imageIndex] = std::move(data);
-		else
-			std::cerr << "Failed to decode image at index " << imageIndex << std::endl;
-	}
+	outInfo.baseColorTexture = findTexture(primitive.baseColorTexture);
+	outInfo.metallicRoughnessTexture = findTexture(primitive.metallicRoughnessTexture);
+	outInfo.normalTexture = findTexture(primitive.normalTexture);
+}
+
+std::shared_ptr<Mesh> ModelManager::CreateMesh(const std::vector<MeshPrimitiveInfo>& primitiveInfos)
+{
+	auto mesh = std::make_shared<Mesh>(device);
+
+	VulkanUploadBatch uploadBatch(device);
 
-	model->textures.clear();
-	
-	for (size_t textureIndex = 0; textureIndex < asset.textures.size(); ++textureIndex)
+	for (MeshPrimitiveInfo primitiveInfo : primitiveInfos)
 	{
-		const auto& texture = asset.textures[textureIndex];
+		if (!primitiveInfo.baseColorTexture)
+			primitiveInfo.baseColorTexture = fallbackTexture;
+		if (!primitiveInfo.metallicRoughnessTexture)
+			primitiveInfo.metallicRoughnessTexture = fallbackTexture;
+		if (!primitiveInfo.normalTexture)
+			primitiveInfo.normalTexture = fallbackTexture;
 
-		auto imageIndex = texture.imageIndex;
+		mesh->AddPrimitive(std::make_unique<MeshPrimitive>(device, geometryArena, materialDescriptorSetLayout, descriptorPool, primitiveInfo, &uploadBatch));
+	}
 
-		if (!imageIndex.has_value() || decodedImages.count(imageIndex.value()) == 0)
+	uploadBatch.SubmitAndWait();
+
+	return mesh;
+}
+
+void ModelManager::CreateTexture(ModelLoadRequest& request, size_t textureIndex, VulkanUploadBatch* uploadBatch)
+{
+	const CookedTexture& texture = request.cooked.textures[textureIndex];
+
+	if (!texture.pixels)
+	{
+		std::cerr << "Texture " << textureIndex << " references a missing image." << std::endl;
+		return;
+	}
+
+	// Reuse a texture another model, or an earlier texture of this one, already uploaded
+	if (texture.contentHash)
+	{
+		auto created = request.createdTextures.find(texture.contentHash);
+		if (created != request.createdTextures.end())
 		{
-			std::cerr << "Texture " << textureIndex << " references a missing image." << std::endl;
-			continue;
+			request.model->textures[textureIndex] = created->second;
+			return;
 		}
 
-		bool sRGB = false;
-		for (auto& material : asset.materials)
+		auto cached = textureCache.find(texture.contentHash);
+		if (cached != textureCache.end())
 		{
-			if (material.pbrData.baseColorTexture.has_value() && material.pbrData.baseColorTexture->textureIndex == textureIndex)
+			if (auto sharedTexture = cached->second.lock())
 			{
-				sRGB = true;
-				break;
+				request.model->textures[textureIndex] = sharedTexture;
+				return;
 			}
+
+			textureCache.erase(cached);
 		}
+	}
+
+	TextureInfo info;
+	info.data = texture.pixels;
+	info.width = texture.width;
+	info.height = texture.height;
+	info.mipLevels = texture.mipLevels;
+	info.format = texture.format;
+	info.sRGB = texture.sRGB;
+	info.components = GetTextureComponentMapping(texture.type, texture.format);
+
+	std::shared_ptr<VulkanTexture> vulkanTexture;
+	if (textureStreamer)
+	{
+		vulkanTexture = std::make_shared<VulkanTexture>(device, TextureStreamer::GetInitialInfo(info), uploadBatch);
+		textureStreamer->Register(vulkanTexture, info, request.streamingSource);
+	}
+	else
+	{
+		vulkanTexture = std::make_shared<VulkanTexture>(device, info, uploadBatch);
+	}
+
+	request.model->textures[textureIndex] = vulkanTexture;
 
-		auto& imageData = decodedImages[imageIndex.value()];
+	if (texture.contentHash)
+		request.createdTextures[texture.contentHash] = vulkanTexture;
+}
 
-		auto vulkanTexture = std::make_shared<VulkanTexture>(device, imageData.pixels.data(), imageData.width, imageData.height, sRGB);
-		model->textures[textureIndex] = vulkanTexture;
+bool ModelManager::DecodeImage(const GltfFile& file, const fastgltf::Asset& asset, size_t imageIndex, ImageData& outImage)
+{
+	fastgltf::span<const std::byte> data = file.GetImageData(asset, imageIndex);
+	if (data.empty())
+	{
+		std::cerr << "Image " << imageIndex << " has no data." << std::endl;
+		return false;
 	}
+
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+	outImage.contentHash = HashBytes(bytes, data.size());
+
+	if (IsKtx2(bytes, data.size()))
+		return DecodeKtx2(bytes, data.size(), outImage);
+
+	// Decodes run on pool threads, so only change this thread's flip setting
+	stbi_set_flip_vertically_on_load_thread(false);
+
+	unsigned char* pixels = stbi_load_from_memory(bytes, static_cast<int>(data.size()), &outImage.width, &outImage.height, &outImage.channels, 4);
+	if (!pixels)
+	{
+		std::cerr << "STB Image failed to decode image." << std::endl;
+		return false;
+	}
+
+	outImage.pixels.assign(pixels, pixels + (outImage.width * outImage.height * 4));
+	outImage.channels = 4;
+
+	stbi_image_free(pixels);
+
+	return true;
 }
 
-bool ModelManager::DecodeImage(const fastgltf::Asset& asset, const fastgltf::Image& image, std::vector<uint8_t>& outPixels, int& outWidth, int& outHeight, int& outChannels)
+bool ModelManager::DecodeKtx2(const uint8_t* data, size_t size, ImageData& outImage)
 {
-	bool decoded = false;
+	Ktx2Image ktx;
+	if (!ReadKtx2(data, size, ktx))
+	{
+		std::cerr << "Failed to read KTX2 container." << std::endl;
+		return false;
+	}
+
+	// ETC1S (BasisLZ) and UASTC (undefined VkFormat) payloads need a Basis Universal transcoder, which the engine does not include
+	if (ktx.supercompression == Ktx2Supercompression::BasisLZ || ktx.vkFormat == VK_FORMAT_UNDEFINED)
+	{
+		std::cerr << "KTX2 image holds a Basis Universal payload, which cannot be transcoded." << std::endl;
+		return false;
+	}
+
+	if (ktx.supercompression != Ktx2Supercompression::None && ktx.supercompression != Ktx2Supercompression::Zstandard)
+	{
+		std::cerr << "Unsupported KTX2 supercompression scheme " << static_cast<uint32_t>(ktx.supercompression) << "." << std::endl;
+		return false;
+	}
+
+	TextureFormat format;
+	if (!GetKtx2TextureFormat(ktx.vkFormat, format))
+	{
+		std::cerr << "Unsupported KTX2 format " << ktx.vkFormat << "." << std::endl;
+		return false;
+	}
+
+	if (format != TextureFormat::RGBA8 && !device->SupportsTextureCompressionBC())
+	{
+		std::cerr << "KTX2 image uses a block format the device cannot sample." << std::endl;
+		return false;
+	}
+
+	// Level sizes follow from the header, which bounds every allocation below by what the device could create
+	uint32_t maxDimension = device->GetProperties().limits.maxImageDimension2D;
+	if (ktx.width > maxDimension || ktx.height > maxDimension)
+	{
+		std::cerr << "KTX2 image is " << ktx.width << "x" << ktx.height << ", larger than the device supports." << std::endl;
+		return false;
+	}
+
+	// Uncompressed images go through mip generation and cooking like any decoded image
+	uint32_t levelCount = format == TextureFormat::RGBA8 ? 1 : static_cast<uint32_t>(ktx.levels.size());
+	levelCount = std::min(levelCount, GetMipLevelCount(ktx.width, ktx.height));
+
+	outImage.pixels.clear();
+	outImage.pixels.reserve(GetTextureDataSize(format, ktx.width, ktx.height, levelCount));
 
-	std::visit(fastgltf::visitor
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		size_t levelSize = GetTextureLevelSize(format, std::max(ktx.width >> level, 1u), std::max(ktx.height >> level, 1u));
+
+		if (!AppendKtx2Level(ktx, level, levelSize, outImage.pixels))
 		{
-			[&](const fastgltf::sources::URI& filePath)
-			{
-				std::cout << "External GLTF textures not yet supported. Please use GLB models." << std::endl;
-			},
-			[&](const fastgltf::sources::Array& vector)
-			{
-				std::cout << "GLTF textures not yet supported. Please use GLB models." << std::endl;
-			},
-			[&](const fastgltf::sources::BufferView& view)
-			{
-				if (view.bufferViewIndex >= asset.bufferViews.size())
-				{
-					std::cerr << "Invalid buffer view index in image." << std::endl;
-					return;
-				}
-				
-				auto& bufferView = asset.bufferViews[view.bufferViewIndex];
-				auto& buffer = asset.buffers[bufferView.bufferIndex];
+			std::cerr << "KTX2 level " << level << " has the wrong size or fails to decompress." << std::endl;
+			return false;
+		}
+	}
 
-				stbi_set_flip_vertically_on_load(false);
+	outImage.width = static_cast<int>(ktx.width);
+	outImage.height = static_cast<int>(ktx.height);
+	outImage.channels = 4;
+	outImage.mipLevels = levelCount;
+	outImage.format = format;
 
-				std::visit(fastgltf::visitor
-					{
-						[&](const fastgltf::sources::Array& vector)
-						{
-							unsigned char* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(vector.bytes.data() + bufferView.byteOffset),
-																		static_cast<int>(bufferView.byteLength), &outWidth, &outHeight, &outChannels, 4);
-							if (pixels)
-							{
-								outPixels.assign(pixels, pixels + (outWidth * outHeight * 4));
-
-								outChannels = 4;
-
-								stbi_image_free(pixels);
-
-								decoded = true;
-							}
-							else
-							{
-								std::cerr << "STB Image failed to decode image." << std::endl;
-							}
-						},
-						[](auto& arg) {}
-					}, buffer.data);
-			},
-			[](auto& arg) {}
-		}, image.data);
-	
-	return decoded;
+	return true;
 }
 
 std::shared_ptr<VulkanTexture> ModelManager::CreateFallbackTexture(glm::vec4 color)
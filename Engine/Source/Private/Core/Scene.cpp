@@ -1,21 +1,32 @@
 #include <Core/Scene.h>
 
 #include <iostream>
+#include <algorithm>
 
 #include <Core/SceneObject.h>
 #include <Core/MeshInstance.h>
 #include <Core/ModelManager.h>
 #include <Core/Mesh.h>
+#include <Core/MeshPrimitive.h>
 #include <Core/Camera.h>
+#include <Core/Frustum.h>
 #include <Core/Transform.h>
+#include <Core/TransformStore.h>
+#include <Core/AabbTree.h>
 #include <Core/Model.h>
+#include <Vulkan/Config.h>
+#include <Vulkan/InstanceBuffer.h>
 
 using namespace VulkanRenderer;
 
-Scene::Scene(VulkanDevice* device, ModelManager* modelManager, VkDescriptorSetLayout cameraDescriptorSetLayout, VkDescriptorPool descriptorPool)
+Scene::Scene(VulkanDevice* device, ModelManager* modelManager, VkDescriptorSetLayout cameraDescriptorSetLayout, VkDescriptorSetLayout instanceDescriptorSetLayout, VkDescriptorPool descriptorPool)
 	: device(device), modelManager(modelManager), cameraDescriptorSetLayout(cameraDescriptorSetLayout), descriptorPool(descriptorPool)
 {
+	transformStore = std::make_unique<TransformStore>();
+	spatialIndex = std::make_unique<AabbTree>();
 
+	instanceBuffer = std::make_unique<VulkanInstanceBuffer>(device, instanceDescriptorSetLayout, descriptorPool);
+	pendingInstanceMatrices.resize(VulkanConfig::MAX_FRAMES_IN_FLIGHT);
 }
 
 Scene::~Scene()
@@ -33,6 +44,237 @@ std::vector<std::unique_ptr<SceneObject>>& Scene::GetObjectsMutable()
 	return objects;
 }
 
+const std::vector<MeshInstance*>& Scene::GetMeshInstances() const
+{
+	return meshInstances;
+}
+
+const std::vector<Camera*>& Scene::GetCameras() const
+{
+	return cameras;
+}
+
+const std::vector<RenderItem>& Scene::GetOpaqueRenderItems() const
+{
+	return opaqueRenderItems;
+}
+
+const std::vector<RenderItem>& Scene::GetTransparentRenderItems() const
+{
+	return transparentRenderItems;
+}
+
+const std::vector<RenderItem>& Scene::GetVisibleOpaqueRenderItems() const
+{
+	return visibleOpaqueRenderItems;
+}
+
+const std::vector<RenderItem>& Scene::GetVisibleTransparentRenderItems() const
+{
+	return visibleTransparentRenderItems;
+}
+
+const std::vector<MeshInstance*>& Scene::GetVisibleMeshInstances() const
+{
+	return visibleMeshInstances;
+}
+
+void Scene::CullRenderItems(const Frustum& frustum, bool cullOpaque)
+{
+	visibleOpaqueRenderItems.clear();
+	visibleTransparentRenderItems.clear();
+	visibleMeshInstances.clear();
+
+	queryItems.clear();
+	spatialIndex->QueryFrustum(frustum, queryItems);
+
+	// Creation order keeps draws of one model together, which the pipelines rely on to skip rebinding
+	std::sort(queryItems.begin(), queryItems.end());
+
+	auto cull = [&](const glm::mat4& worldMatrix, const RenderItem* items, uint32_t count, std::vector<RenderItem>& visibleItems)
+		{
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const RenderItem& item = items[i];
+
+				// The sphere rejects most off-screen primitives cheaply, the box catches long thin ones it is too loose for
+				if (!frustum.IntersectsSphere(item.primitive->GetBoundingSphere().Transformed(worldMatrix)))
+					continue;
+
+				if (!frustum.IntersectsBox(item.primitive->GetBounds().Transformed(worldMatrix)))
+					continue;
+
+				visibleItems.push_back(item);
+			}
+		};
+
+	for (uint32_t meshInstanceIndex : queryItems)
+	{
+		const MeshInstanceRecord& record = meshInstanceRecords[meshInstanceIndex];
+		glm::mat4 worldMatrix = meshInstances[meshInstanceIndex]->transform.GetWorldMatrix();
+
+		visibleMeshInstances.push_back(meshInstances[meshInstanceIndex]);
+
+		if (cullOpaque)
+			cull(worldMatrix, opaqueRenderItems.data() + record.firstOpaqueItem, record.opaqueItemCount, visibleOpaqueRenderItems);
+		cull(worldMatrix, transparentRenderItems.data() + record.firstTransparentItem, record.transparentItemCount, visibleTransparentRenderItems);
+	}
+}
+
+void Scene::QueryBox(const BoundingBox& box, std::vector<MeshInstance*>& outInstances) const
+{
+	queryItems.clear();
+	spatialIndex->QueryBox(box, queryItems);
+
+	for (uint32_t meshInstanceIndex : queryItems)
+	{
+		if (GetWorldBounds(meshInstanceIndex).Intersects(box))
+			outInstances.push_back(meshInstances[meshInstanceIndex]);
+	}
+}
+
+void Scene::QuerySphere(const glm::vec3& center, float radius, std::vector<MeshInstance*>& outInstances) const
+{
+	queryItems.clear();
+	spatialIndex->QuerySphere(center, radius, queryItems);
+
+	for (uint32_t meshInstanceIndex : queryItems)
+	{
+		if (GetWorldBounds(meshInstanceIndex).IntersectsSphere(center, radius))
+			outInstances.push_back(meshInstances[meshInstanceIndex]);
+	}
+}
+
+MeshInstance* Scene::RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float* outDistance) const
+{
+	glm::vec3 inverseDirection = 1.0f / direction;
+
+	// Instances are only as exact as the boxes of their primitives, triangles are not kept on the CPU
+	auto hitTest = [&](uint32_t meshInstanceIndex)
+		{
+			const MeshInstanceRecord& record = meshInstanceRecords[meshInstanceIndex];
+			glm::mat4 worldMatrix = meshInstances[meshInstanceIndex]->transform.GetWorldMatrix();
+
+			float closest = -1.0f;
+			auto testItems = [&](const RenderItem* items, uint32_t count)
+				{
+					for (uint32_t i = 0; i < count; ++i)
+					{
+						float distance;
+						if (items[i].primitive->GetBounds().Transformed(worldMatrix).IntersectsRay(origin, inverseDirection, maxDistance, distance) && (closest < 0.0f || distance < closest))
+							closest = distance;
+					}
+				};
+
+			testItems(opaqueRenderItems.data() + record.firstOpaqueItem, record.opaqueItemCount);
+			testItems(transparentRenderItems.data() + record.firstTransparentItem, record.transparentItemCount);
+
+			return closest;
+		};
+
+	uint32_t meshInstanceIndex;
+	float distance;
+	if (!spatialIndex->RayCast(origin, direction, maxDistance, hitTest, meshInstanceIndex, distance))
+		return nullptr;
+
+	if (outDistance)
+		*outDistance = distance;
+
+	return meshInstances[meshInstanceIndex];
+}
+
+void Scene::SortTransparentRenderItems(const glm::vec3& cameraPosition)
+{
+	std::sort(visibleTransparentRenderItems.begin(), visibleTransparentRenderItems.end(),
+		[&](const RenderItem& a, const RenderItem& b)
+		{
+			float distA = glm::length(cameraPosition - a.meshInstance->transform.GetPosition());
+			float distB = glm::length(cameraPosition - b.meshInstance->transform.GetPosition());
+			return distA > distB;
+		});
+}
+
+void Scene::BuildInstancedDraws(int currentFrame)
+{
+	opaqueDraws.clear();
+	transparentDraws.clear();
+	itemDraws.clear();
+
+	// A new stamp invalidates every primitive's draw index from earlier builds without touching them
+	++drawStamp;
+
+	// Draws come in order of first appearance, which keeps the primitives of one model next to each other
+	for (const RenderItem& item : visibleOpaqueRenderItems)
+	{
+		MeshPrimitive* primitive = item.primitive;
+		if (primitive->drawStamp != drawStamp)
+		{
+			primitive->drawStamp = drawStamp;
+			primitive->drawIndex = static_cast<uint32_t>(opaqueDraws.size());
+
+			InstancedDraw draw;
+			draw.primitive = primitive;
+			draw.meshInstance = item.meshInstance;
+			draw.primitiveIndex = item.primitiveIndex;
+			opaqueDraws.push_back(draw);
+		}
+
+		++opaqueDraws[primitive->drawIndex].instanceCount;
+		itemDraws.push_back(primitive->drawIndex);
+	}
+
+	uint32_t opaqueInstanceCount = 0;
+	for (InstancedDraw& draw : opaqueDraws)
+	{
+		draw.firstInstance = opaqueInstanceCount;
+		opaqueInstanceCount += draw.instanceCount;
+	}
+
+	// Transparent instances follow the opaque ones in list order
+	for (uint32_t i = 0; i < visibleTransparentRenderItems.size(); ++i)
+	{
+		const RenderItem& item = visibleTransparentRenderItems[i];
+
+		if (transparentDraws.empty() || transparentDraws.back().primitive != item.primitive)
+		{
+			InstancedDraw draw;
+			draw.primitive = item.primitive;
+			draw.meshInstance = item.meshInstance;
+			draw.primitiveIndex = item.primitiveIndex;
+			draw.firstInstance = opaqueInstanceCount + i;
+			transparentDraws.push_back(draw);
+		}
+
+		++transparentDraws.back().instanceCount;
+	}
+
+	instanceBuffer->ReserveDrawInstances(currentFrame, opaqueInstanceCount + visibleTransparentRenderItems.size());
+	uint32_t* drawInstances = instanceBuffer->GetDrawInstances(currentFrame);
+
+	// Counts are rebuilt while scattering, each item lands at the next free slot of its draw
+	for (InstancedDraw& draw : opaqueDraws)
+		draw.instanceCount = 0;
+
+	for (size_t i = 0; i < visibleOpaqueRenderItems.size(); ++i)
+	{
+		InstancedDraw& draw = opaqueDraws[itemDraws[i]];
+		drawInstances[draw.firstInstance + draw.instanceCount++] = visibleOpaqueRenderItems[i].instanceIndex;
+	}
+
+	for (size_t i = 0; i < visibleTransparentRenderItems.size(); ++i)
+		drawInstances[opaqueInstanceCount + i] = visibleTransparentRenderItems[i].instanceIndex;
+}
+
+const std::vector<InstancedDraw>& Scene::GetOpaqueDraws() const
+{
+	return opaqueDraws;
+}
+
+const std::vector<InstancedDraw>& Scene::GetTransparentDraws() const
+{
+	return transparentDraws;
+}
+
 Camera* Scene::GetMainCamera() const
 {
 	return mainCamera;
@@ -55,9 +297,8 @@ SceneObject* Scene::CreateSceneObject(const std::string& name, const glm::vec3&
 	objectNames.insert(instanceName);
 
 	std::unique_ptr<SceneObject> object = std::make_unique<SceneObject>(instanceName);
-	object->transform.position = position;
-	object->transform.rotation = rotation;
-	object->transform.scale = scale;
+	object->transform.Attach(transformStore.get());
+	object->transform.SetLocal(position, rotation, scale);
 	object->transform.SetParent(parent);
 
 	SceneObject* objectPtr = object.get();
@@ -78,13 +319,13 @@ Camera* Scene::CreateCamera(const std::string& name, const glm::vec3& position,
 	objectNames.insert(cameraName);
 
 	std::unique_ptr<Camera> camera = std::make_unique<Camera>(cameraName, device, cameraDescriptorSetLayout, descriptorPool);
-	camera->transform.position = position;
-	camera->transform.rotation = rotation;
-	camera->transform.scale = scale;
+	camera->transform.Attach(transformStore.get());
+	camera->transform.SetLocal(position, rotation, scale);
 	camera->transform.SetParent(parent);
 
 	Camera* cameraPtr = camera.get();
 	objects.push_back(std::move(camera));
+	cameras.push_back(cameraPtr);
 	
 	return cameraPtr;
 }
@@ -100,56 +341,76 @@ MeshInstance* Scene::CreateMeshInstance(const std::string& name, const glm::vec3
 	}
 	objectNames.insert(instanceName);
 	
-	std::unique_ptr<MeshInstance> meshInstance = std::make_unique<MeshInstance>(instanceName, mesh, device, descriptorPool);
-	meshInstance->transform.position = position;
-	meshInstance->transform.rotation = rotation;
-	meshInstance->transform.scale = scale;
+	std::unique_ptr<MeshInstance> meshInstance = std::make_unique<MeshInstance>(instanceName, mesh);
+	meshInstance->transform.Attach(transformStore.get());
+	meshInstance->transform.SetLocal(position, rotation, scale);
 	meshInstance->transform.SetParent(parent);
 
 	MeshInstance* meshInstancePtr = meshInstance.get();
 	objects.push_back(std::move(meshInstance));
-	
-	return meshInstancePtr;
-}
+	uint32_t meshInstanceIndex = static_cast<uint32_t>(meshInstances.size());
+	meshInstances.push_back(meshInstancePtr);
 
-void Scene::InstantiateModelNode(const std::shared_ptr<Model>& model, const fastgltf::Node& node, Transform* parent)
-{
-	fastgltf::math::fvec3 gltfTranslation(0.0f, 0.0f, 0.0f);
-	fastgltf::math::fquat gltfRotation;
-	fastgltf::math::fvec3 gltfScale(1.0f, 1.0f, 1.0f);
+	MeshInstanceRecord record;
+	record.firstOpaqueItem = static_cast<uint32_t>(opaqueRenderItems.size());
+	record.firstTransparentItem = static_cast<uint32_t>(transparentRenderItems.size());
 
-	if (auto* transform = std::get_if<fastgltf::math::fmat4x4>(&node.transform))
+	for (size_t i = 0; i < mesh->GetPrimitiveCount(); ++i)
 	{
-		fastgltf::math::decomposeTransformMatrix(*transform, gltfScale, gltfRotation, gltfTranslation);
-	}
-	else if (auto* trs = std::get_if<fastgltf::TRS>(&node.transform))
-	{
-		gltfTranslation = trs->translation;
-		gltfRotation = trs->rotation;
-		gltfScale = trs->scale;
+		RenderItem item;
+		item.meshInstance = meshInstancePtr;
+		item.primitive = mesh->GetPrimitive(i);
+		item.primitiveIndex = static_cast<uint32_t>(i);
+		item.instanceIndex = meshInstanceIndex;
+
+		record.localBounds.Expand(item.primitive->GetBounds());
+
+		if (item.primitive->GetTransparencyEnabled())
+		{
+			transparentRenderItems.push_back(item);
+			++record.transparentItemCount;
+		}
+		else
+		{
+			opaqueRenderItems.push_back(item);
+			++record.opaqueItemCount;
+		}
 	}
+
+	meshInstanceRecords.push_back(record);
+
+	uint32_t handle = meshInstancePtr->transform.GetHandle();
+	if (handle >= transformMeshInstances.size())
+		transformMeshInstances.resize(handle + 1, UINT32_MAX);
+	transformMeshInstances[handle] = meshInstanceIndex;
+
+	meshInstanceRecords.back().proxy = spatialIndex->CreateProxy(GetWorldBounds(meshInstanceIndex), meshInstanceIndex);
+
+	for (std::vector<uint32_t>& pending : pendingInstanceMatrices)
+		pending.push_back(meshInstanceIndex);
 	
-	glm::vec3 position = glm::vec3(gltfTranslation.x(), gltfTranslation.y(), gltfTranslation.z());
-	glm::quat rotation = glm::quat(gltfRotation.w(), gltfRotation.x(), gltfRotation.y(), gltfRotation.z());
-	glm::vec3 scale = glm::vec3(gltfScale.x(), gltfScale.y(), gltfScale.z());
-	
+	return meshInstancePtr;
+}
+
+void Scene::InstantiateModelNode(const std::shared_ptr<Model>& model, const ModelNode& node, Transform* parent)
+{
 	SceneObject* object = nullptr;
 
-	if (node.meshIndex.has_value())
+	if (node.meshIndex >= 0)
 	{
-		if (node.meshIndex.value() < model->meshes.size())
+		if (static_cast<size_t>(node.meshIndex) < model->meshes.size())
 		{
-			object = CreateMeshInstance(node.name.c_str(), position, rotation, scale, parent, model->meshes[node.meshIndex.value()]);
+			object = CreateMeshInstance(node.name, node.position, node.rotation, node.scale, parent, model->meshes[node.meshIndex]);
 		}
 	}
 	else
 	{
-		object = CreateSceneObject(node.name.c_str(), position, rotation, scale, parent);
+		object = CreateSceneObject(node.name, node.position, node.rotation, node.scale, parent);
 	}
 
-	for (const auto& childNodeIndex : node.children)
+	for (uint32_t childNodeIndex : node.children)
 	{
-		const auto& childNode = model->gltfAsset.nodes[childNodeIndex];
+		const ModelNode& childNode = model->nodes[childNodeIndex];
 		if (object)
 			InstantiateModelNode(model, childNode, &object->transform);
 	}
@@ -165,27 +426,74 @@ SceneObject* Scene::InstantiateModel(const std::string& name, const Transform& t
 		return nullptr;
 	}
 
-	const fastgltf::Scene& gltfScene = model->gltfAsset.scenes[0];
+	SceneObject* root = CreateSceneObject(name, transform.GetPosition(), transform.GetRotation(), transform.GetScale(), nullptr);
+
+	for (uint32_t rootNodeIndex : model->rootNodes)
+	{
+		InstantiateModelNode(model, model->nodes[rootNodeIndex], &root->transform);
+	}
+
+	return root;
+}
+
+void Scene::UpdateTransforms()
+{
+	transformStore->Update();
+
+	for (uint32_t handle : transformStore->GetMovedHandles())
+	{
+		uint32_t meshInstanceIndex = handle < transformMeshInstances.size() ? transformMeshInstances[handle] : UINT32_MAX;
+		if (meshInstanceIndex == UINT32_MAX)
+			continue;
+
+		spatialIndex->MoveProxy(meshInstanceRecords[meshInstanceIndex].proxy, GetWorldBounds(meshInstanceIndex));
 
-	SceneObject* root = CreateSceneObject(name, transform.position, transform.rotation, transform.scale, nullptr);
+		for (std::vector<uint32_t>& pending : pendingInstanceMatrices)
+			pending.push_back(meshInstanceIndex);
+	}
+}
 
-	for (size_t rootNodeIndex : gltfScene.nodeIndices)
+BoundingBox Scene::GetWorldBounds(uint32_t meshInstanceIndex) const
+{
+	const MeshInstanceRecord& record = meshInstanceRecords[meshInstanceIndex];
+	const glm::mat4 worldMatrix = meshInstances[meshInstanceIndex]->transform.GetWorldMatrix();
+
+	// Instances without geometry still get a point so they can be found
+	if (!record.localBounds.IsValid())
 	{
-		InstantiateModelNode(model, model->gltfAsset.nodes[rootNodeIndex], &root->transform);
+		BoundingBox point;
+		point.Expand(glm::vec3(worldMatrix[3]));
+		return point;
 	}
+
+	return record.localBounds.Transformed(worldMatrix);
 }
 
 void Scene::UpdateUniformBuffers(int currentFrame, VkExtent2D swapChainExtent)
 {
-	for (const auto& object : GetObjects())
+	std::vector<uint32_t>& pending = pendingInstanceMatrices[currentFrame];
+
+	// A reallocated buffer starts out empty, so every matrix is written
+	if (instanceBuffer->Reserve(currentFrame, meshInstances.size()))
 	{
-		if (auto* meshInstance = dynamic_cast<MeshInstance*>(object.get()))
-		{
-			meshInstance->UpdateUniformBuffer(currentFrame);
-		}
-		else if (auto* camera = dynamic_cast<Camera*>(object.get()))
-		{
-			camera->UpdateUniformBuffer(currentFrame, swapChainExtent);
-		}
+		pending.resize(meshInstances.size());
+		for (uint32_t i = 0; i < pending.size(); ++i)
+			pending[i] = i;
 	}
+
+	glm::mat4* matrices = instanceBuffer->GetMatrices(currentFrame);
+	for (uint32_t meshInstanceIndex : pending)
+		matrices[meshInstanceIndex] = meshInstances[meshInstanceIndex]->transform.GetWorldMatrix();
+
+	pending.clear();
+
+	for (Camera* camera : cameras)
+	{
+		camera->UpdateUniformBuffer(currentFrame, swapChainExtent);
+	}
+}
+
+VulkanInstanceBuffer* Scene::GetInstanceBuffer() const
+{
+	return instanceBuffer.get();
 }
\ No newline at end of file
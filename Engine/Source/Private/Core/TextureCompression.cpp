@@ -0,0 +1,463 @@
+#include <Core/TextureCompression.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cfloat>
+
+using namespace VulkanRenderer;
+
+namespace
+{
+	// BC7 interpolation weights for 4-bit indices, out of 64
+	constexpr int BC7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+	struct BlockWriter
+	{
+		uint8_t* data;
+		uint32_t bit = 0;
+
+		void Write(uint32_t value, uint32_t bitCount)
+		{
+			for (uint32_t i = 0; i < bitCount; i++, bit++)
+			{
+				if ((value >> i) & 1)
+					data[bit >> 3] |= static_cast<uint8_t>(1 << (bit & 7));
+			}
+		}
+	};
+
+	uint32_t GetBlockBytes(TextureFormat format)
+	{
+		switch (format)
+		{
+		case TextureFormat::BC1:
+			return 8;
+		case TextureFormat::BC5:
+		case TextureFormat::BC7:
+			return 16;
+		default:
+			return 0;
+		}
+	}
+
+	// Edge blocks of textures that are not a multiple of 4 repeat the last row and column
+	void ReadBlock(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t outBlock[16][4])
+	{
+		for (uint32_t y = 0; y < 4; y++)
+		{
+			uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+			for (uint32_t x = 0; x < 4; x++)
+			{
+				uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+				std::memcpy(outBlock[y * 4 + x], pixels + (size_t(sourceY) * width + sourceX) * 4, 4);
+			}
+		}
+	}
+
+	// Fits a line through the block's colors, outStart and outEnd are its extremes along the principal axis
+	void FitEndpoints(const uint8_t block[16][4], uint32_t channelCount, float outStart[4], float outEnd[4])
+	{
+		float mean[4] = {};
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			for (uint32_t c = 0; c < channelCount; c++)
+				mean[c] += block[i][c];
+		}
+		for (uint32_t c = 0; c < channelCount; c++)
+			mean[c] /= 16.0f;
+
+		float covariance[4][4] = {};
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			float delta[4] = {};
+			for (uint32_t c = 0; c < channelCount; c++)
+				delta[c] = block[i][c] - mean[c];
+
+			for (uint32_t a = 0; a < channelCount; a++)
+			{
+				for (uint32_t b = 0; b < channelCount; b++)
+					covariance[a][b] += delta[a] * delta[b];
+			}
+		}
+
+		// Power iteration from the channel with the largest variance converges on the dominant eigenvector
+		uint32_t widest = 0;
+		for (uint32_t c = 1; c < channelCount; c++)
+		{
+			if (covariance[c][c] > covariance[widest][widest])
+				widest = c;
+		}
+
+		float axis[4] = {};
+		for (uint32_t c = 0; c < channelCount; c++)
+			axis[c] = covariance[c][widest];
+
+		for (uint32_t iteration = 0; iteration < 8; iteration++)
+		{
+			float next[4] = {};
+			float largest = 0.0f;
+			for (uint32_t a = 0; a < channelCount; a++)
+			{
+				for (uint32_t b = 0; b < channelCount; b++)
+					next[a] += covariance[a][b] * axis[b];
+
+				largest = std::max(largest, std::abs(next[a]));
+			}
+
+			if (largest <= 0.0f)
+				break;
+
+			for (uint32_t c = 0; c < channelCount; c++)
+				axis[c] = next[c] / largest;
+		}
+
+		float lengthSquared = 0.0f;
+		for (uint32_t c = 0; c < channelCount; c++)
+			lengthSquared += axis[c] * axis[c];
+
+		float minT = 0.0f;
+		float maxT = 0.0f;
+		if (lengthSquared > 0.0f)
+		{
+			minT = FLT_MAX;
+			maxT = -FLT_MAX;
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				float t = 0.0f;
+				for (uint32_t c = 0; c < channelCount; c++)
+					t += (block[i][c] - mean[c]) * axis[c];
+				t /= lengthSquared;
+
+				minT = std::min(minT, t);
+				maxT = std::max(maxT, t);
+			}
+		}
+
+		for (uint32_t c = 0; c < channelCount; c++)
+		{
+			outStart[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+			outEnd[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+		}
+	}
+
+	uint16_t PackRGB565(const float color[4])
+	{
+		uint32_t r = static_cast<uint32_t>(color[0] * 31.0f / 255.0f + 0.5f);
+		uint32_t g = static_cast<uint32_t>(color[1] * 63.0f / 255.0f + 0.5f);
+		uint32_t b = static_cast<uint32_t>(color[2] * 31.0f / 255.0f + 0.5f);
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	void UnpackRGB565(uint16_t packed, int outColor[3])
+	{
+		int r = (packed >> 11) & 31;
+		int g = (packed >> 5) & 63;
+		int b = packed & 31;
+		outColor[0] = (r << 3) | (r >> 2);
+		outColor[1] = (g << 2) | (g >> 4);
+		outColor[2] = (b << 3) | (b >> 2);
+	}
+
+	void EncodeBC1Block(const uint8_t block[16][4], uint8_t* out)
+	{
+		float start[4], end[4];
+		FitEndpoints(block, 3, start, end);
+
+		uint16_t color0 = PackRGB565(end);
+		uint16_t color1 = PackRGB565(start);
+
+		// Four color mode is selected by color0 > color1
+		if (color0 < color1)
+			std::swap(color0, color1);
+
+		uint32_t indices = 0;
+		if (color0 != color1)
+		{
+			int palette[4][3];
+			UnpackRGB565(color0, palette[0]);
+			UnpackRGB565(color1, palette[1]);
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				uint32_t bestIndex = 0;
+				int bestError = INT32_MAX;
+				for (uint32_t index = 0; index < 4; index++)
+				{
+					int error = 0;
+					for (uint32_t c = 0; c < 3; c++)
+					{
+						int delta = block[i][c] - palette[index][c];
+						error += delta * delta;
+					}
+
+					if (error < bestError)
+					{
+						bestError = error;
+						bestIndex = index;
+					}
+				}
+
+				indices |= bestIndex << (i * 2);
+			}
+		}
+
+		out[0] = static_cast<uint8_t>(color0 & 0xFF);
+		out[1] = static_cast<uint8_t>(color0 >> 8);
+		out[2] = static_cast<uint8_t>(color1 & 0xFF);
+		out[3] = static_cast<uint8_t>(color1 >> 8);
+		for (uint32_t i = 0; i < 4; i++)
+			out[4 + i] = static_cast<uint8_t>(indices >> (i * 8));
+	}
+
+	// One channel with eight interpolated values, BC5 stores two of these
+	void EncodeBC4Block(const uint8_t block[16][4], uint32_t channel, uint8_t* out)
+	{
+		int low = 255;
+		int high = 0;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			low = std::min<int>(low, block[i][channel]);
+			high = std::max<int>(high, block[i][channel]);
+		}
+
+		uint64_t indices = 0;
+		if (high > low)
+		{
+			int palette[8] = {high, low};
+			for (int index = 2; index < 8; index++)
+				palette[index] = ((8 - index) * high + (index - 1) * low) / 7;
+
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				uint64_t bestIndex = 0;
+				int bestError = INT32_MAX;
+				for (uint32_t index = 0; index < 8; index++)
+				{
+					int error = std::abs(block[i][channel] - palette[index]);
+					if (error < bestError)
+					{
+						bestError = error;
+						bestIndex = index;
+					}
+				}
+
+				indices |= bestIndex << (i * 3);
+			}
+		}
+
+		out[0] = static_cast<uint8_t>(high);
+		out[1] = static_cast<uint8_t>(low);
+		for (uint32_t i = 0; i < 6; i++)
+			out[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+	}
+
+	// Seven bits per channel plus the shared low bit that fits the endpoint best
+	void QuantizeBC7Endpoint(const float endpoint[4], uint32_t outQuantized[4], uint32_t& outPBit)
+	{
+		float bestError = FLT_MAX;
+		for (uint32_t pBit = 0; pBit < 2; pBit++)
+		{
+			uint32_t quantized[4];
+			float error = 0.0f;
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				quantized[c] = static_cast<uint32_t>(std::clamp(static_cast<int>((endpoint[c] - pBit) * 0.5f + 0.5f), 0, 127));
+				float delta = static_cast<float>((quantized[c] << 1) | pBit) - endpoint[c];
+				error += delta * delta;
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				outPBit = pBit;
+				std::copy(quantized, quantized + 4, outQuantized);
+			}
+		}
+	}
+
+	// Mode 6, a single RGBA line with 4-bit indices
+	void EncodeBC7Block(const uint8_t block[16][4], uint8_t* out)
+	{
+		float start[4], end[4];
+		FitEndpoints(block, 4, start, end);
+
+		uint32_t quantized[2][4];
+		uint32_t pBits[2];
+		QuantizeBC7Endpoint(start, quantized[0], pBits[0]);
+		QuantizeBC7Endpoint(end, quantized[1], pBits[1]);
+
+		int endpoints[2][4];
+		for (uint32_t e = 0; e < 2; e++)
+		{
+			for (uint32_t c = 0; c < 4; c++)
+				endpoints[e][c] = static_cast<int>((quantized[e][c] << 1) | pBits[e]);
+		}
+
+		uint32_t indices[16];
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			uint32_t bestIndex = 0;
+			int bestError = INT32_MAX;
+			for (uint32_t index = 0; index < 16; index++)
+			{
+				int weight = BC7Weights[index];
+				int error = 0;
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					int value = ((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6;
+					int delta = block[i][c] - value;
+					error += delta * delta;
+				}
+
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = index;
+				}
+			}
+
+			indices[i] = bestIndex;
+		}
+
+		// The first index is stored without its top bit, swapping the endpoints keeps it below 8
+		if (indices[0] >= 8)
+		{
+			std::swap(quantized[0], quantized[1]);
+			std::swap(pBits[0], pBits[1]);
+			for (uint32_t i = 0; i < 16; i++)
+				indices[i] = 15 - indices[i];
+		}
+
+		std::memset(out, 0, 16);
+
+		BlockWriter writer{out};
+		writer.Write(1 << 6, 7);
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			writer.Write(quantized[0][c], 7);
+			writer.Write(quantized[1][c], 7);
+		}
+		writer.Write(pBits[0], 1);
+		writer.Write(pBits[1], 1);
+		for (uint32_t i = 0; i < 16; i++)
+			writer.Write(indices[i], i == 0 ? 3 : 4);
+	}
+}
+
+size_t VulkanRenderer::GetTextureLevelSize(TextureFormat format, uint32_t width, uint32_t height)
+{
+	if (format == TextureFormat::RGBA8)
+		return size_t(width) * height * 4;
+
+	return size_t((width + 3) / 4) * ((height + 3) / 4) * GetBlockBytes(format);
+}
+
+size_t VulkanRenderer::GetTextureDataSize(TextureFormat format, uint32_t width, uint32_t height, uint32_t levelCount)
+{
+	size_t size = 0;
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		size += GetTextureLevelSize(format, width, height);
+		width = std::max(width / 2, 1u);
+		height = std::max(height / 2, 1u);
+	}
+
+	return size;
+}
+
+TextureFormat VulkanRenderer::ChooseCompressedFormat(TextureType type, const uint8_t* pixels, uint32_t width, uint32_t height)
+{
+	switch (type)
+	{
+	case TextureType::BaseColor:
+	{
+		size_t pixelCount = size_t(width) * height;
+		for (size_t i = 0; i < pixelCount; i++)
+		{
+			if (pixels[i * 4 + 3] != 255)
+				return TextureFormat::BC7;
+		}
+
+		return TextureFormat::BC1;
+	}
+	case TextureType::Normal:
+	case TextureType::MetallicRoughness:
+		return TextureFormat::BC5;
+	default:
+		return TextureFormat::BC7;
+	}
+}
+
+void VulkanRenderer::CompressTexture(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t levelCount, TextureType type, TextureFormat format, std::vector<uint8_t>& outData)
+{
+	if (format == TextureFormat::RGBA8)
+	{
+		outData.assign(pixels, pixels + GetTextureDataSize(format, width, height, levelCount));
+		return;
+	}
+
+	outData.resize(GetTextureDataSize(format, width, height, levelCount));
+
+	// Metallic-roughness keeps roughness (G) and metallic (B), the shader side swizzle puts them back
+	uint32_t firstChannel = type == TextureType::MetallicRoughness ? 1 : 0;
+	uint32_t blockBytes = GetBlockBytes(format);
+
+	uint8_t* output = outData.data();
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		uint32_t blocksX = (width + 3) / 4;
+		uint32_t blocksY = (height + 3) / 4;
+
+		for (uint32_t blockY = 0; blockY < blocksY; blockY++)
+		{
+			for (uint32_t blockX = 0; blockX < blocksX; blockX++)
+			{
+				uint8_t block[16][4];
+				ReadBlock(pixels, width, height, blockX, blockY, block);
+
+				switch (format)
+				{
+				case TextureFormat::BC1:
+					EncodeBC1Block(block, output);
+					break;
+				case TextureFormat::BC5:
+					EncodeBC4Block(block, firstChannel, output);
+					EncodeBC4Block(block, firstChannel + 1, output + 8);
+					break;
+				case TextureFormat::BC7:
+					EncodeBC7Block(block, output);
+					break;
+				default:
+					break;
+				}
+
+				output += blockBytes;
+			}
+		}
+
+		pixels += size_t(width) * height * 4;
+		width = std::max(width / 2, 1u);
+		height = std::max(height / 2, 1u);
+	}
+}
+
+VkComponentMapping VulkanRenderer::GetTextureComponentMapping(TextureType type, TextureFormat format)
+{
+	VkComponentMapping components{};
+
+	if (type == TextureType::MetallicRoughness && format == TextureFormat::BC5)
+	{
+		components.r = VK_COMPONENT_SWIZZLE_ONE;
+		components.g = VK_COMPONENT_SWIZZLE_R;
+		components.b = VK_COMPONENT_SWIZZLE_G;
+		components.a = VK_COMPONENT_SWIZZLE_ONE;
+	}
+
+	return components;
+}
@@ -0,0 +1,370 @@
+#include <Core/TextureStreamer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include <Core/ThreadPool.h>
+#include <Core/MappedFile.h>
+#include <Core/Camera.h>
+#include <Core/Mesh.h>
+#include <Core/MeshInstance.h>
+#include <Core/MeshPrimitive.h>
+#include <Core/TextureCompression.h>
+#include <Vulkan/Config.h>
+#include <Vulkan/Image.h>
+#include <Vulkan/UploadBatch.h>
+
+using namespace VulkanRenderer;
+
+// Largest dimension of the levels every texture keeps resident
+static constexpr uint32_t TailSize = 64;
+
+// Reads started per update, finer levels of nearby textures arrive first and the rest follow over the next frames
+static constexpr size_t MaxReadsPerUpdate = 4;
+
+// Workers that copy level data out of the source, kept low so streaming never competes with model imports
+static constexpr size_t ReadThreadCount = 2;
+
+TextureStreamingSource::TextureStreamingSource() = default;
+
+TextureStreamingSource::~TextureStreamingSource() = default;
+
+TextureStreamer::TextureStreamer(VulkanDevice* device, VkDeviceSize budget)
+	: device(device), budget(budget)
+{
+	readPool = std::make_unique<ThreadPool>(ReadThreadCount);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	for (const auto& streamed : textures)
+	{
+		if (streamed->read.valid())
+			streamed->read.wait();
+	}
+
+	readPool.reset();
+
+	for (const auto& batch : uploadBatches)
+		batch->Wait();
+	uploadBatches.clear();
+
+	for (const RetiredImage& retired : retiredImages)
+		delete retired.image;
+}
+
+TextureInfo TextureStreamer::GetInitialInfo(const TextureInfo& info)
+{
+	uint32_t level = 0;
+	while (level + 1 < info.mipLevels && (std::max(info.width, info.height) >> level) > TailSize)
+		level++;
+
+	return GetLevelInfo(info, level);
+}
+
+void TextureStreamer::Register(const std::shared_ptr<VulkanTexture>& texture, const TextureInfo& info, std::shared_ptr<TextureStreamingSource> source)
+{
+	if (texture->streamingSlot >= 0)
+		return;
+
+	auto streamed = std::make_unique<StreamedTexture>();
+	streamed->texture = texture;
+	streamed->texturePointer = texture.get();
+	streamed->info = info;
+	streamed->source = std::move(source);
+	streamed->tailLevel = info.mipLevels - GetInitialInfo(info).mipLevels;
+	streamed->residentLevel = streamed->tailLevel;
+	streamed->targetLevel = streamed->tailLevel;
+
+	residentSize += GetLevelsSize(info, streamed->residentLevel);
+
+	texture->streamingSlot = static_cast<int32_t>(textures.size());
+	textures.push_back(std::move(streamed));
+}
+
+void TextureStreamer::Update(const std::vector<MeshInstance*>& meshInstances, const Camera* camera, VkExtent2D extent)
+{
+	ReleaseRetired();
+	RemoveExpired();
+	ApplyFinishedReads();
+
+	if (!camera)
+		return;
+
+	MeasureScreenSizes(meshInstances, camera, extent);
+	PlanLevels();
+	StartReads();
+}
+
+VkDeviceSize TextureStreamer::GetBudget() const
+{
+	return budget;
+}
+
+VkDeviceSize TextureStreamer::GetResidentSize() const
+{
+	return residentSize;
+}
+
+size_t TextureStreamer::GetTextureCount() const
+{
+	return textures.size();
+}
+
+void TextureStreamer::ReleaseRetired()
+{
+	// Update runs once per frame after that frame's fence, so a countdown of MAX_FRAMES_IN_FLIGHT outlives every frame that sampled the image
+	for (RetiredImage& retired : retiredImages)
+	{
+		if (--retired.updatesLeft == 0)
+		{
+			delete retired.image;
+			retired.image = nullptr;
+		}
+	}
+
+	retiredImages.erase(std::remove_if(retiredImages.begin(), retiredImages.end(),
+		[](const RetiredImage& retired)
+		{
+			return retired.image == nullptr;
+		}), retiredImages.end());
+
+	uploadBatches.erase(std::remove_if(uploadBatches.begin(), uploadBatches.end(),
+		[](const std::unique_ptr<VulkanUploadBatch>& batch)
+		{
+			return batch->IsComplete();
+		}), uploadBatches.end());
+}
+
+void TextureStreamer::RemoveExpired()
+{
+	bool removed = false;
+
+	for (auto& streamed : textures)
+	{
+		if (!streamed->texture.expired())
+			continue;
+
+		if (streamed->read.valid())
+			streamed->read.wait();
+
+		residentSize -= GetLevelsSize(streamed->info, streamed->residentLevel);
+
+		streamed.reset();
+		removed = true;
+	}
+
+	if (!removed)
+		return;
+
+	textures.erase(std::remove(textures.begin(), textures.end(), nullptr), textures.end());
+
+	// Survivors moved down, their textures are still alive since they did not expire
+	for (size_t i = 0; i < textures.size(); ++i)
+		textures[i]->texturePointer->streamingSlot = static_cast<int32_t>(i);
+}
+
+void TextureStreamer::ApplyFinishedReads()
+{
+	VulkanUploadBatch* batch = nullptr;
+
+	for (const auto& streamed : textures)
+	{
+		if (!streamed->read.valid() || streamed->read.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			continue;
+
+		streamed->read.get();
+
+		std::shared_ptr<VulkanTexture> texture = streamed->texture.lock();
+		if (texture && streamed->readLevel != streamed->residentLevel)
+		{
+			if (!batch)
+			{
+				uploadBatches.push_back(std::make_unique<VulkanUploadBatch>(device));
+				batch = uploadBatches.back().get();
+			}
+
+			TextureInfo info = GetLevelInfo(streamed->info, streamed->readLevel);
+			info.data = streamed->readData.data();
+
+			RetiredImage retired;
+			retired.image = texture->Recreate(info, batch);
+			retired.updatesLeft = VulkanConfig::MAX_FRAMES_IN_FLIGHT;
+			retiredImages.push_back(retired);
+
+			residentSize -= GetLevelsSize(streamed->info, streamed->residentLevel);
+			residentSize += GetLevelsSize(streamed->info, streamed->readLevel);
+			streamed->residentLevel = streamed->readLevel;
+		}
+
+		std::vector<uint8_t>().swap(streamed->readData);
+	}
+
+	// Submitted ahead of the frame on the same queue, so the draws recorded next already see the new images
+	if (batch)
+		batch->Submit();
+}
+
+void TextureStreamer::MeasureScreenSizes(const std::vector<MeshInstance*>& meshInstances, const Camera* camera, VkExtent2D extent)
+{
+	for (const auto& streamed : textures)
+		streamed->screenSize = 0.0f;
+
+	// Pixels covered by one world unit at a distance of one
+	float pixelsPerUnit = extent.height / (2.0f * std::tan(glm::radians(camera->fov) * 0.5f));
+	glm::vec3 cameraPosition = camera->transform.GetPosition();
+
+	for (MeshInstance* meshInstance : meshInstances)
+	{
+		glm::mat4 worldMatrix = meshInstance->transform.GetWorldMatrix();
+		const Mesh& mesh = meshInstance->GetMesh();
+
+		for (size_t i = 0; i < mesh.GetPrimitiveCount(); ++i)
+		{
+			const MeshPrimitive* primitive = mesh.GetPrimitive(i);
+			if (!primitive->GetBounds().IsValid())
+				continue;
+
+			BoundingBox bounds = primitive->GetBounds().Transformed(worldMatrix);
+			float radius = glm::length(bounds.GetExtents());
+			float distance = std::max(glm::length(bounds.GetCenter() - cameraPosition) - radius, 0.01f);
+			float screenSize = 2.0f * radius / distance * pixelsPerUnit;
+
+			for (const VulkanTexture* texture : {primitive->baseColorTexture.get(), primitive->metallicRoughnessTexture.get(), primitive->normalTexture.get()})
+			{
+				if (!texture || texture->streamingSlot < 0)
+					continue;
+
+				StreamedTexture& streamed = *textures[texture->streamingSlot];
+				streamed.screenSize = std::max(streamed.screenSize, screenSize);
+			}
+		}
+	}
+}
+
+void TextureStreamer::PlanLevels()
+{
+	// Tails never leave, so only the levels above them compete for what is left of the budget
+	VkDeviceSize planned = 0;
+	for (const auto& streamed : textures)
+	{
+		planned += GetLevelsSize(streamed->info, streamed->tailLevel);
+		streamed->targetLevel = streamed->tailLevel;
+	}
+
+	byScreenSize.clear();
+	for (const auto& streamed : textures)
+	{
+		if (streamed->screenSize > 0.0f)
+			byScreenSize.push_back(streamed.get());
+	}
+
+	std::sort(byScreenSize.begin(), byScreenSize.end(), [](const StreamedTexture* a, const StreamedTexture* b)
+		{
+			return a->screenSize > b->screenSize;
+		});
+
+	for (StreamedTexture* streamed : byScreenSize)
+	{
+		// Level whose size matches the screen size, one texel per pixel
+		float textureSize = static_cast<float>(std::max(streamed->info.width, streamed->info.height));
+		float wantedLevel = std::floor(std::log2(std::max(textureSize / streamed->screenSize, 1.0f)));
+		uint32_t level = std::min(static_cast<uint32_t>(wantedLevel), streamed->tailLevel);
+
+		VkDeviceSize tailSize = GetLevelsSize(streamed->info, streamed->tailLevel);
+		while (level < streamed->tailLevel && planned + GetLevelsSize(streamed->info, level) - tailSize > budget)
+			level++;
+
+		planned += GetLevelsSize(streamed->info, level) - tailSize;
+		streamed->targetLevel = level;
+	}
+}
+
+void TextureStreamer::StartReads()
+{
+	size_t started = 0;
+	bool blocked = false;
+
+	// Pending reads will grow the resident total once applied
+	VkDeviceSize committed = residentSize;
+	for (const auto& streamed : textures)
+	{
+		if (streamed->read.valid() && streamed->readLevel < streamed->residentLevel)
+			committed += GetLevelsSize(streamed->info, streamed->readLevel) - GetLevelsSize(streamed->info, streamed->residentLevel);
+	}
+
+	byScreenSize.clear();
+	for (const auto& streamed : textures)
+		byScreenSize.push_back(streamed.get());
+
+	std::sort(byScreenSize.begin(), byScreenSize.end(), [](const StreamedTexture* a, const StreamedTexture* b)
+		{
+			return a->screenSize > b->screenSize;
+		});
+
+	for (StreamedTexture* streamed : byScreenSize)
+	{
+		if (started >= MaxReadsPerUpdate)
+			return;
+
+		if (streamed->read.valid() || streamed->targetLevel >= streamed->residentLevel)
+			continue;
+
+		VkDeviceSize growth = GetLevelsSize(streamed->info, streamed->targetLevel) - GetLevelsSize(streamed->info, streamed->residentLevel);
+		if (committed + growth > budget)
+		{
+			blocked = true;
+			continue;
+		}
+
+		committed += growth;
+		StartRead(*streamed, streamed->targetLevel);
+		started++;
+	}
+
+	// Levels are only dropped under pressure, so textures moving in and out of view do not thrash
+	if (!blocked && residentSize <= budget)
+		return;
+
+	for (auto it = byScreenSize.rbegin(); it != byScreenSize.rend() && started < MaxReadsPerUpdate; ++it)
+	{
+		StreamedTexture* streamed = *it;
+		if (streamed->read.valid() || streamed->targetLevel <= streamed->residentLevel)
+			continue;
+
+		StartRead(*streamed, streamed->targetLevel);
+		started++;
+	}
+}
+
+void TextureStreamer::StartRead(StreamedTexture& streamed, uint32_t level)
+{
+	streamed.readLevel = level;
+
+	// Copying out of the mapping faults its pages in on the worker instead of the render thread
+	streamed.read = readPool->Submit([&streamed, level]()
+		{
+			VkDeviceSize offset = GetTextureDataSize(streamed.info.format, streamed.info.width, streamed.info.height, level);
+			VkDeviceSize size = GetLevelsSize(streamed.info, level);
+
+			streamed.readData.resize(size);
+			memcpy(streamed.readData.data(), streamed.info.data + offset, size);
+		});
+}
+
+TextureInfo TextureStreamer::GetLevelInfo(const TextureInfo& info, uint32_t level)
+{
+	TextureInfo levelInfo = info;
+	levelInfo.data = info.data + GetTextureDataSize(info.format, info.width, info.height, level);
+	levelInfo.width = std::max(info.width >> level, 1u);
+	levelInfo.height = std::max(info.height >> level, 1u);
+	levelInfo.mipLevels = info.mipLevels - level;
+	return levelInfo;
+}
+
+VkDeviceSize TextureStreamer::GetLevelsSize(const TextureInfo& info, uint32_t level)
+{
+	return GetTextureDataSize(info.format, info.width, info.height, info.mipLevels) - GetTextureDataSize(info.format, info.width, info.height, level);
+}
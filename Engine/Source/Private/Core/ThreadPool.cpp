@@ -0,0 +1,110 @@
+#include <Core/ThreadPool.h>
+
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+using namespace VulkanRenderer;
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	workers.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i)
+		workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	condition.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+size_t ThreadPool::GetThreadCount() const
+{
+	return workers.size();
+}
+
+std::future<void> ThreadPool::Submit(std::function<void()> task)
+{
+	std::packaged_task<void()> packagedTask(std::move(task));
+	std::future<void> future = packagedTask.get_future();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push(std::move(packagedTask));
+	}
+	condition.notify_one();
+
+	return future;
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& func)
+{
+	if (count == 0)
+		return;
+
+	struct State
+	{
+		std::atomic<size_t> next{0};
+		std::atomic<size_t> finished{0};
+		std::mutex mutex;
+		std::condition_variable condition;
+	};
+
+	auto state = std::make_shared<State>();
+
+	// Helpers that start after every index is claimed exit without touching func
+	auto run = [state, count, &func]()
+		{
+			size_t index;
+			while ((index = state->next.fetch_add(1)) < count)
+			{
+				func(index);
+
+				if (state->finished.fetch_add(1) + 1 == count)
+				{
+					std::lock_guard<std::mutex> lock(state->mutex);
+					state->condition.notify_all();
+				}
+			}
+		};
+
+	size_t helperCount = std::min(count - 1, workers.size());
+	for (size_t i = 0; i < helperCount; ++i)
+		Submit(run);
+
+	run();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->condition.wait(lock, [&]() { return state->finished.load() == count; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::packaged_task<void()> task;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+			if (stopping && tasks.empty())
+				return;
+
+			task = std::move(tasks.front());
+			tasks.pop();
+		}
+
+		task();
+	}
+}
@@ -1,5 +1,12 @@
 #include <Core/Transform.h>
 
+#include <algorithm>
+#include <iostream>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <Core/TransformStore.h>
+
 using namespace VulkanRenderer;
 
 Transform::Transform()
@@ -20,8 +27,30 @@ Transform::~Transform()
 	for (Transform* child : children)
 	{
 		child->parent = nullptr;
+		if (child->store)
+			child->store->SetParent(child->handle, TransformStore::InvalidHandle);
 	}
 	children.clear();
+
+	if (store)
+		store->Remove(handle);
+}
+
+void Transform::Attach(TransformStore* newStore)
+{
+	if (store || parent || !children.empty())
+	{
+		std::cerr << "Failed to attach transform, it must be detached and outside any hierarchy" << std::endl;
+		return;
+	}
+
+	store = newStore;
+	handle = store->Add(position, rotation, scale);
+}
+
+uint32_t Transform::GetHandle() const
+{
+	return handle;
 }
 
 void Transform::SetParent(Transform* newParent)
@@ -29,6 +58,12 @@ void Transform::SetParent(Transform* newParent)
 	if (parent == newParent)
 		return;
 
+	if (newParent && newParent->store != store)
+	{
+		std::cerr << "Failed to parent transform, both must belong to the same store" << std::endl;
+		return;
+	}
+
 	if (parent)
 		parent->RemoveChild(this);
 
@@ -36,6 +71,9 @@ void Transform::SetParent(Transform* newParent)
 
 	if (parent)
 		parent->AddChild(this);
+
+	if (store)
+		store->SetParent(handle, parent ? parent->handle : TransformStore::InvalidHandle);
 }
 
 Transform* Transform::GetParent() const
@@ -48,8 +86,63 @@ const std::vector<Transform*>& Transform::GetChildren() const
 	return children;
 }
 
+glm::vec3 Transform::GetPosition() const
+{
+	return store ? store->GetPosition(handle) : position;
+}
+
+void Transform::SetPosition(const glm::vec3& newPosition)
+{
+	if (store)
+		store->SetPosition(handle, newPosition);
+	else
+		position = newPosition;
+}
+
+glm::quat Transform::GetRotation() const
+{
+	return store ? store->GetRotation(handle) : rotation;
+}
+
+void Transform::SetRotation(const glm::quat& newRotation)
+{
+	if (store)
+		store->SetRotation(handle, newRotation);
+	else
+		rotation = newRotation;
+}
+
+glm::vec3 Transform::GetScale() const
+{
+	return store ? store->GetScale(handle) : scale;
+}
+
+void Transform::SetScale(const glm::vec3& newScale)
+{
+	if (store)
+		store->SetScale(handle, newScale);
+	else
+		scale = newScale;
+}
+
+void Transform::SetLocal(const glm::vec3& newPosition, const glm::quat& newRotation, const glm::vec3& newScale)
+{
+	if (store)
+	{
+		store->SetLocal(handle, newPosition, newRotation, newScale);
+		return;
+	}
+
+	position = newPosition;
+	rotation = newRotation;
+	scale = newScale;
+}
+
 glm::mat4 Transform::GetLocalMatrix() const
 {
+	if (store)
+		return store->GetLocalMatrix(handle);
+
 	glm::mat4 t = glm::translate(glm::mat4(1.0f), position);
 	glm::mat4 r = glm::mat4_cast(rotation);
 	glm::mat4 s = glm::scale(glm::mat4(1.0f), scale);
@@ -58,6 +151,9 @@ glm::mat4 Transform::GetLocalMatrix() const
 
 glm::mat4 Transform::GetWorldMatrix() const
 {
+	if (store)
+		return store->GetWorldMatrix(handle);
+
 	if (parent)
 		return parent->GetWorldMatrix() * GetLocalMatrix();
 	else
@@ -75,4 +171,4 @@ void Transform::RemoveChild(Transform* child)
 	auto it = std::find(children.begin(), children.end(), child);
 	if (it != children.end())
 		children.erase(it);
-}
\ No newline at end of file
+}
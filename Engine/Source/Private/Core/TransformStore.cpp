@@ -0,0 +1,455 @@
+#include <Core/TransformStore.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define TRANSFORM_STORE_SSE2 1
+#include <xmmintrin.h>
+#endif
+
+using namespace VulkanRenderer;
+
+namespace
+{
+	const glm::mat4 Identity = glm::mat4(1.0f);
+
+	template<typename T>
+	void Permute(std::vector<T>& values, const std::vector<uint32_t>& order)
+	{
+		std::vector<T> permuted(order.size());
+		for (size_t i = 0; i < order.size(); ++i)
+			permuted[i] = values[order[i]];
+
+		values = std::move(permuted);
+	}
+}
+
+TransformStore::TransformStore()
+{
+
+}
+
+TransformStore::~TransformStore()
+{
+
+}
+
+uint32_t TransformStore::Add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+	uint32_t handle;
+	if (!freeHandles.empty())
+	{
+		handle = freeHandles.back();
+		freeHandles.pop_back();
+	}
+	else
+	{
+		handle = static_cast<uint32_t>(handleSlots.size());
+		handleSlots.push_back(InvalidSlot);
+	}
+
+	uint32_t slot = static_cast<uint32_t>(slotHandles.size());
+	handleSlots[handle] = slot;
+	slotHandles.push_back(handle);
+
+	positionX.push_back(position.x);
+	positionY.push_back(position.y);
+	positionZ.push_back(position.z);
+
+	rotationX.push_back(rotation.x);
+	rotationY.push_back(rotation.y);
+	rotationZ.push_back(rotation.z);
+	rotationW.push_back(rotation.w);
+
+	scaleX.push_back(scale.x);
+	scaleY.push_back(scale.y);
+	scaleZ.push_back(scale.z);
+
+	parentSlots.push_back(InvalidSlot);
+	worldMatrices.push_back(Identity);
+	dirty.push_back(0);
+
+	// Appended roots break the depth order just like reparenting does
+	orderChanged = true;
+	MarkDirty(slot);
+	++count;
+
+	return handle;
+}
+
+void TransformStore::Remove(uint32_t handle)
+{
+	uint32_t slot = handleSlots[handle];
+
+	// The slot is left in place as a hole so no parent index has to move until the next sort
+	slotHandles[slot] = InvalidHandle;
+	parentSlots[slot] = InvalidSlot;
+	dirty[slot] = 0;
+
+	handleSlots[handle] = InvalidSlot;
+	freeHandles.push_back(handle);
+
+	orderChanged = true;
+	--count;
+}
+
+void TransformStore::SetParent(uint32_t handle, uint32_t parentHandle)
+{
+	uint32_t slot = handleSlots[handle];
+	parentSlots[slot] = parentHandle == InvalidHandle ? InvalidSlot : handleSlots[parentHandle];
+
+	orderChanged = true;
+	MarkDirty(slot);
+}
+
+glm::vec3 TransformStore::GetPosition(uint32_t handle) const
+{
+	uint32_t slot = handleSlots[handle];
+	return glm::vec3(positionX[slot], positionY[slot], positionZ[slot]);
+}
+
+glm::quat TransformStore::GetRotation(uint32_t handle) const
+{
+	uint32_t slot = handleSlots[handle];
+	return glm::quat::wxyz(rotationW[slot], rotationX[slot], rotationY[slot], rotationZ[slot]);
+}
+
+glm::vec3 TransformStore::GetScale(uint32_t handle) const
+{
+	uint32_t slot = handleSlots[handle];
+	return glm::vec3(scaleX[slot], scaleY[slot], scaleZ[slot]);
+}
+
+void TransformStore::SetPosition(uint32_t handle, const glm::vec3& position)
+{
+	uint32_t slot = handleSlots[handle];
+	positionX[slot] = position.x;
+	positionY[slot] = position.y;
+	positionZ[slot] = position.z;
+	MarkDirty(slot);
+}
+
+void TransformStore::SetRotation(uint32_t handle, const glm::quat& rotation)
+{
+	uint32_t slot = handleSlots[handle];
+	rotationX[slot] = rotation.x;
+	rotationY[slot] = rotation.y;
+	rotationZ[slot] = rotation.z;
+	rotationW[slot] = rotation.w;
+	MarkDirty(slot);
+}
+
+void TransformStore::SetScale(uint32_t handle, const glm::vec3& scale)
+{
+	uint32_t slot = handleSlots[handle];
+	scaleX[slot] = scale.x;
+	scaleY[slot] = scale.y;
+	scaleZ[slot] = scale.z;
+	MarkDirty(slot);
+}
+
+void TransformStore::SetLocal(uint32_t handle, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+	SetPosition(handle, position);
+	SetRotation(handle, rotation);
+	SetScale(handle, scale);
+}
+
+glm::mat4 TransformStore::GetLocalMatrix(uint32_t handle) const
+{
+	return ComposeLocalMatrix(handleSlots[handle]);
+}
+
+glm::mat4 TransformStore::GetWorldMatrix(uint32_t handle) const
+{
+	uint32_t slot = handleSlots[handle];
+
+	if (IsPending(slot))
+		return ComputeWorldMatrix(slot);
+
+	return worldMatrices[slot];
+}
+
+void TransformStore::Update()
+{
+	movedHandles.clear();
+
+	if (orderChanged)
+		SortByDepth();
+
+	if (!anyDirty)
+		return;
+
+	for (size_t level = 0; level + 1 < levelStarts.size(); ++level)
+	{
+		size_t begin = levelStarts[level];
+		size_t end = levelStarts[level + 1];
+
+		// Parents are all in earlier levels and already settled, so moving one moves everything below it
+		if (level > 0)
+		{
+			for (size_t slot = begin; slot < end; ++slot)
+				dirty[slot] |= dirty[parentSlots[slot]];
+		}
+
+		// Groups never straddle levels so no lane depends on another lane's result
+		size_t slot = begin;
+		for (; slot + 4 <= end; slot += 4)
+		{
+			uint32_t groupDirty;
+			memcpy(&groupDirty, &dirty[slot], sizeof(groupDirty));
+
+			if (groupDirty)
+				ComposeWorldMatrices4(static_cast<uint32_t>(slot));
+		}
+
+		for (; slot < end; ++slot)
+		{
+			if (dirty[slot])
+				ComposeWorldMatrix(static_cast<uint32_t>(slot));
+		}
+	}
+
+	for (size_t slot = 0; slot < dirty.size(); ++slot)
+	{
+		if (dirty[slot])
+			movedHandles.push_back(slotHandles[slot]);
+	}
+
+	std::fill(dirty.begin(), dirty.end(), uint8_t(0));
+	anyDirty = false;
+}
+
+size_t TransformStore::GetCount() const
+{
+	return count;
+}
+
+const std::vector<uint32_t>& TransformStore::GetMovedHandles() const
+{
+	return movedHandles;
+}
+
+void TransformStore::MarkDirty(uint32_t slot)
+{
+	dirty[slot] = 1;
+	anyDirty = true;
+}
+
+bool TransformStore::IsPending(uint32_t slot) const
+{
+	if (!anyDirty)
+		return false;
+
+	for (uint32_t ancestor = slot; ancestor != InvalidSlot; ancestor = parentSlots[ancestor])
+	{
+		if (dirty[ancestor])
+			return true;
+	}
+
+	return false;
+}
+
+glm::mat4 TransformStore::ComposeLocalMatrix(uint32_t slot) const
+{
+	glm::mat4 t = glm::translate(glm::mat4(1.0f), glm::vec3(positionX[slot], positionY[slot], positionZ[slot]));
+	glm::mat4 r = glm::mat4_cast(glm::quat::wxyz(rotationW[slot], rotationX[slot], rotationY[slot], rotationZ[slot]));
+	glm::mat4 s = glm::scale(glm::mat4(1.0f), glm::vec3(scaleX[slot], scaleY[slot], scaleZ[slot]));
+	return t * r * s;
+}
+
+glm::mat4 TransformStore::ComputeWorldMatrix(uint32_t slot) const
+{
+	uint32_t parent = parentSlots[slot];
+	if (parent == InvalidSlot)
+		return ComposeLocalMatrix(slot);
+
+	return ComputeWorldMatrix(parent) * ComposeLocalMatrix(slot);
+}
+
+void TransformStore::SortByDepth()
+{
+	size_t slotCount = slotHandles.size();
+
+	std::vector<uint32_t> depths(slotCount, UINT32_MAX);
+	std::vector<uint32_t> path;
+	uint32_t maxDepth = 0;
+
+	for (uint32_t slot = 0; slot < slotCount; ++slot)
+	{
+		if (slotHandles[slot] == InvalidHandle)
+			continue;
+
+		// Climb to the first ancestor with a known depth, then fill in the path on the way back down
+		uint32_t current = slot;
+		while (current != InvalidSlot && depths[current] == UINT32_MAX)
+		{
+			path.push_back(current);
+			current = parentSlots[current];
+		}
+
+		uint32_t depth = current == InvalidSlot ? 0 : depths[current] + 1;
+		while (!path.empty())
+		{
+			depths[path.back()] = depth++;
+			path.pop_back();
+		}
+
+		maxDepth = std::max(maxDepth, depths[slot]);
+	}
+
+	// Counting sort keeps siblings in creation order within each level
+	levelStarts.assign(count > 0 ? maxDepth + 2 : 1, 0);
+	for (uint32_t slot = 0; slot < slotCount; ++slot)
+	{
+		if (slotHandles[slot] != InvalidHandle)
+			++levelStarts[depths[slot] + 1];
+	}
+
+	for (size_t level = 1; level < levelStarts.size(); ++level)
+		levelStarts[level] += levelStarts[level - 1];
+
+	std::vector<size_t> next(levelStarts.begin(), levelStarts.end() - 1);
+	std::vector<uint32_t> order(count);
+	std::vector<uint32_t> newSlots(slotCount, InvalidSlot);
+
+	for (uint32_t slot = 0; slot < slotCount; ++slot)
+	{
+		if (slotHandles[slot] == InvalidHandle)
+			continue;
+
+		size_t newSlot = next[depths[slot]]++;
+		order[newSlot] = slot;
+		newSlots[slot] = static_cast<uint32_t>(newSlot);
+	}
+
+	Permute(positionX, order);
+	Permute(positionY, order);
+	Permute(positionZ, order);
+	Permute(rotationX, order);
+	Permute(rotationY, order);
+	Permute(rotationZ, order);
+	Permute(rotationW, order);
+	Permute(scaleX, order);
+	Permute(scaleY, order);
+	Permute(scaleZ, order);
+	Permute(parentSlots, order);
+	Permute(worldMatrices, order);
+	Permute(dirty, order);
+	Permute(slotHandles, order);
+
+	for (uint32_t slot = 0; slot < count; ++slot)
+	{
+		if (parentSlots[slot] != InvalidSlot)
+			parentSlots[slot] = newSlots[parentSlots[slot]];
+
+		handleSlots[slotHandles[slot]] = slot;
+	}
+
+	orderChanged = false;
+}
+
+void TransformStore::ComposeWorldMatrix(uint32_t slot)
+{
+	uint32_t parent = parentSlots[slot];
+	if (parent == InvalidSlot)
+		worldMatrices[slot] = ComposeLocalMatrix(slot);
+	else
+		worldMatrices[slot] = worldMatrices[parent] * ComposeLocalMatrix(slot);
+}
+
+void TransformStore::ComposeWorldMatrices4(uint32_t slot)
+{
+#ifdef TRANSFORM_STORE_SSE2
+	// Every register holds one matrix element for four transforms
+	__m128 x = _mm_loadu_ps(&rotationX[slot]);
+	__m128 y = _mm_loadu_ps(&rotationY[slot]);
+	__m128 z = _mm_loadu_ps(&rotationZ[slot]);
+	__m128 w = _mm_loadu_ps(&rotationW[slot]);
+
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128 two = _mm_set1_ps(2.0f);
+
+	__m128 xx = _mm_mul_ps(x, x);
+	__m128 yy = _mm_mul_ps(y, y);
+	__m128 zz = _mm_mul_ps(z, z);
+	__m128 xy = _mm_mul_ps(x, y);
+	__m128 xz = _mm_mul_ps(x, z);
+	__m128 yz = _mm_mul_ps(y, z);
+	__m128 wx = _mm_mul_ps(w, x);
+	__m128 wy = _mm_mul_ps(w, y);
+	__m128 wz = _mm_mul_ps(w, z);
+
+	__m128 sx = _mm_loadu_ps(&scaleX[slot]);
+	__m128 sy = _mm_loadu_ps(&scaleY[slot]);
+	__m128 sz = _mm_loadu_ps(&scaleZ[slot]);
+
+	// Local columns of translate * rotate * scale, same layout as glm::mat4_cast
+	__m128 local[4][3];
+	local[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+	local[0][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+	local[0][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+
+	local[1][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+	local[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+	local[1][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+
+	local[2][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+	local[2][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+	local[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+
+	local[3][0] = _mm_loadu_ps(&positionX[slot]);
+	local[3][1] = _mm_loadu_ps(&positionY[slot]);
+	local[3][2] = _mm_loadu_ps(&positionZ[slot]);
+
+	// Gather the parents into the same layout, roots multiply by identity
+	const float* parentColumns[4];
+	for (uint32_t lane = 0; lane < 4; ++lane)
+	{
+		uint32_t parent = parentSlots[slot + lane];
+		parentColumns[lane] = parent == InvalidSlot ? &Identity[0][0] : &worldMatrices[parent][0][0];
+	}
+
+	// World matrices are affine, so only the top three rows of each column are needed
+	__m128 parentMatrix[4][3];
+	for (int column = 0; column < 4; ++column)
+	{
+		__m128 lane0 = _mm_loadu_ps(parentColumns[0] + column * 4);
+		__m128 lane1 = _mm_loadu_ps(parentColumns[1] + column * 4);
+		__m128 lane2 = _mm_loadu_ps(parentColumns[2] + column * 4);
+		__m128 lane3 = _mm_loadu_ps(parentColumns[3] + column * 4);
+		_MM_TRANSPOSE4_PS(lane0, lane1, lane2, lane3);
+
+		parentMatrix[column][0] = lane0;
+		parentMatrix[column][1] = lane1;
+		parentMatrix[column][2] = lane2;
+	}
+
+	for (int column = 0; column < 4; ++column)
+	{
+		__m128 world[4];
+		for (int row = 0; row < 3; ++row)
+		{
+			world[row] = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(parentMatrix[0][row], local[column][0]),
+				_mm_mul_ps(parentMatrix[1][row], local[column][1])),
+				_mm_mul_ps(parentMatrix[2][row], local[column][2]));
+
+			if (column == 3)
+				world[row] = _mm_add_ps(world[row], parentMatrix[3][row]);
+		}
+		world[3] = column == 3 ? one : _mm_setzero_ps();
+
+		// Back to one column per transform
+		_MM_TRANSPOSE4_PS(world[0], world[1], world[2], world[3]);
+		for (uint32_t lane = 0; lane < 4; ++lane)
+			_mm_storeu_ps(&worldMatrices[slot + lane][column][0], world[lane]);
+	}
+#else
+	for (uint32_t lane = 0; lane < 4; ++lane)
+		ComposeWorldMatrix(slot + lane);
+#endif
+}
@@ -1,9 +1,17 @@
 #include <Core/Vertex.h>
 
 #include <iostream>
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+
+#include <glm/gtc/packing.hpp>
 
 using namespace VulkanRenderer;
 
+// Half floats step by 1/1024 between 1 and 2, tiling texcoords beyond that keep the float format
+static constexpr float MaxHalfTexCoord = 2.0f;
+
 VkVertexInputBindingDescription Vertex::GetBindingDescription()
 {
 	VkVertexInputBindingDescription bindingDescription{};
@@ -43,4 +51,133 @@ std::array<VkVertexInputAttributeDescription, 4> Vertex::GetAttributeDescription
 	attributeDescriptions[3].offset = offsetof(Vertex, normalTexCoord);
 
 	return attributeDescriptions;
-}
\ No newline at end of file
+}
+
+uint32_t VulkanRenderer::GetVertexStride(VertexFormat format)
+{
+	switch (format)
+	{
+	case VertexFormat::Quantized:
+		return sizeof(QuantizedVertex);
+	case VertexFormat::QuantizedSharedTexCoord:
+		return sizeof(QuantizedSharedTexCoordVertex);
+	default:
+		return sizeof(Vertex);
+	}
+}
+
+VkVertexInputBindingDescription VulkanRenderer::GetVertexBindingDescription(VertexFormat format)
+{
+	VkVertexInputBindingDescription bindingDescription = Vertex::GetBindingDescription();
+	bindingDescription.stride = GetVertexStride(format);
+
+	return bindingDescription;
+}
+
+std::array<VkVertexInputAttributeDescription, 4> VulkanRenderer::GetVertexAttributeDescriptions(VertexFormat format)
+{
+	if (format == VertexFormat::Float || format == VertexFormat::Count)
+		return Vertex::GetAttributeDescriptions();
+
+	std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions{};
+	for (uint32_t i = 0; i < attributeDescriptions.size(); ++i)
+	{
+		attributeDescriptions[i].binding = 0;
+		attributeDescriptions[i].location = i;
+		attributeDescriptions[i].format = VK_FORMAT_R16G16_SFLOAT;
+	}
+
+	// Position is dequantized in the vertex shader with the primitive's push constants
+	attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+
+	if (format == VertexFormat::Quantized)
+	{
+		attributeDescriptions[0].offset = offsetof(QuantizedVertex, position);
+		attributeDescriptions[1].offset = offsetof(QuantizedVertex, baseColorTexCoord);
+		attributeDescriptions[2].offset = offsetof(QuantizedVertex, metallicRoughnessTexCoord);
+		attributeDescriptions[3].offset = offsetof(QuantizedVertex, normalTexCoord);
+	}
+	else
+	{
+		// Every texcoord attribute reads the one shared stream
+		attributeDescriptions[0].offset = offsetof(QuantizedSharedTexCoordVertex, position);
+		attributeDescriptions[1].offset = offsetof(QuantizedSharedTexCoordVertex, texCoord);
+		attributeDescriptions[2].offset = offsetof(QuantizedSharedTexCoordVertex, texCoord);
+		attributeDescriptions[3].offset = offsetof(QuantizedSharedTexCoordVertex, texCoord);
+	}
+
+	return attributeDescriptions;
+}
+
+static void PackTexCoord(const glm::vec2& texCoord, uint16_t* outHalf)
+{
+	outHalf[0] = glm::packHalf1x16(texCoord.x);
+	outHalf[1] = glm::packHalf1x16(texCoord.y);
+}
+
+VertexFormat VulkanRenderer::EncodeVertices(const std::vector<Vertex>& vertices, std::vector<uint8_t>& outData, VertexDequantization& outDequantization)
+{
+	glm::vec3 minPosition(FLT_MAX);
+	glm::vec3 maxPosition(-FLT_MAX);
+	float maxTexCoord = 0.0f;
+	bool sharedTexCoords = true;
+
+	for (const Vertex& vertex : vertices)
+	{
+		minPosition = glm::min(minPosition, vertex.position);
+		maxPosition = glm::max(maxPosition, vertex.position);
+
+		glm::vec2 texCoordExtent = glm::max(glm::abs(vertex.baseColorTexCoord), glm::max(glm::abs(vertex.metallicRoughnessTexCoord), glm::abs(vertex.normalTexCoord)));
+		maxTexCoord = std::max(maxTexCoord, std::max(texCoordExtent.x, texCoordExtent.y));
+
+		sharedTexCoords = sharedTexCoords && vertex.baseColorTexCoord == vertex.metallicRoughnessTexCoord && vertex.baseColorTexCoord == vertex.normalTexCoord;
+	}
+
+	outDequantization = VertexDequantization{};
+
+	if (vertices.empty() || maxTexCoord > MaxHalfTexCoord)
+	{
+		outData.resize(sizeof(Vertex) * vertices.size());
+		std::memcpy(outData.data(), vertices.data(), outData.size());
+		return VertexFormat::Float;
+	}
+
+	glm::vec3 extent = maxPosition - minPosition;
+	glm::vec3 inverseExtent(extent.x > 0.0f ? 1.0f / extent.x : 0.0f, extent.y > 0.0f ? 1.0f / extent.y : 0.0f, extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+
+	outDequantization.positionOffset = glm::vec4(minPosition, 0.0f);
+	outDequantization.positionScale = glm::vec4(extent, 0.0f);
+
+	auto quantizePosition = [&](const glm::vec3& position, uint16_t* outPosition)
+		{
+			glm::vec3 normalized = glm::clamp((position - minPosition) * inverseExtent, 0.0f, 1.0f);
+			for (int i = 0; i < 3; ++i)
+				outPosition[i] = static_cast<uint16_t>(std::lround(normalized[i] * 65535.0f));
+			outPosition[3] = 0;
+		};
+
+	VertexFormat format = sharedTexCoords ? VertexFormat::QuantizedSharedTexCoord : VertexFormat::Quantized;
+	outData.resize(static_cast<size_t>(GetVertexStride(format)) * vertices.size());
+
+	for (size_t i = 0; i < vertices.size(); ++i)
+	{
+		const Vertex& vertex = vertices[i];
+
+		if (sharedTexCoords)
+		{
+			QuantizedSharedTexCoordVertex* packed = reinterpret_cast<QuantizedSharedTexCoordVertex*>(outData.data()) + i;
+			quantizePosition(vertex.position, packed->position);
+			PackTexCoord(vertex.baseColorTexCoord, packed->texCoord);
+		}
+		else
+		{
+			QuantizedVertex* packed = reinterpret_cast<QuantizedVertex*>(outData.data()) + i;
+			quantizePosition(vertex.position, packed->position);
+			PackTexCoord(vertex.baseColorTexCoord, packed->baseColorTexCoord);
+			PackTexCoord(vertex.metallicRoughnessTexCoord, packed->metallicRoughnessTexCoord);
+			PackTexCoord(vertex.normalTexCoord, packed->normalTexCoord);
+		}
+	}
+
+	return format;
+}
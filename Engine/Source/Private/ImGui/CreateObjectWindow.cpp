@@ -44,12 +44,12 @@ void CreateObjectWindow::OnRender()
 		switch (selectedObjectType)
 		{
 		case 0:
-			m_Scene->CreateSceneObject("Empty Scene Object", transform.position, transform.rotation, transform.scale, nullptr);
+			m_Scene->CreateSceneObject("Empty Scene Object", transform.GetPosition(), transform.GetRotation(), transform.GetScale(), nullptr);
 			break;
 		case 1:
 			break;
 		case 2:
-			Camera* camera = m_Scene->CreateCamera("Camera", transform.position, transform.rotation, transform.scale, nullptr);
+			Camera* camera = m_Scene->CreateCamera("Camera", transform.GetPosition(), transform.GetRotation(), transform.GetScale(), nullptr);
 			if (!m_Scene->GetMainCamera())
 			{
 				m_Scene->SetMainCamera(camera);
@@ -0,0 +1,81 @@
+#include <ImGui/GpuProfilerWindow.h>
+
+#include <vector>
+#include <algorithm>
+
+#include <Vulkan/GpuProfiler.h>
+
+using namespace VulkanRenderer;
+
+GpuProfilerWindow::GpuProfilerWindow(VulkanGpuProfiler* profiler, bool open)
+	: ImGuiWindow("GPU Profiler", open), m_Profiler(profiler)
+{
+
+}
+
+void GpuProfilerWindow::OnRender()
+{
+	if (!m_Profiler || !m_Profiler->IsSupported())
+	{
+		ImGui::Text("GPU timestamps are not supported on this device.");
+		return;
+	}
+
+	const GpuTimings& timings = m_Profiler->GetLastTimings();
+	if (!timings.valid)
+	{
+		ImGui::Text("Waiting for results...");
+		return;
+	}
+
+	ImGui::Text("Frame: %.3f ms", timings.total);
+	ImGui::Separator();
+
+	for (size_t pass = 0; pass < timings.passes.size(); ++pass)
+	{
+		ImGui::Text("%s", VulkanGpuProfiler::GetPassName(static_cast<GpuPass>(pass)));
+		ImGui::SameLine(120.0f);
+		ImGui::Text("%.3f ms", timings.passes[pass]);
+	}
+
+	ImGui::Separator();
+
+	bool perDrawTiming = m_Profiler->IsPerDrawTimingEnabled();
+	if (ImGui::Checkbox("Time individual draws", &perDrawTiming))
+		m_Profiler->SetPerDrawTimingEnabled(perDrawTiming);
+
+	if (!perDrawTiming || timings.draws.empty())
+		return;
+
+	ImGui::SliderInt("Shown", &m_MaxDrawsShown, 1, 256);
+
+	// Show the most expensive draws first
+	std::vector<const GpuDrawTiming*> draws;
+	draws.reserve(timings.draws.size());
+	for (const GpuDrawTiming& draw : timings.draws)
+		draws.push_back(&draw);
+
+	size_t shown = std::min(draws.size(), static_cast<size_t>(m_MaxDrawsShown));
+	std::partial_sort(draws.begin(), draws.begin() + shown, draws.end(),
+		[](const GpuDrawTiming* a, const GpuDrawTiming* b)
+		{
+			return a->milliseconds > b->milliseconds;
+		});
+
+	if (ImGui::BeginTable("Draws", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY))
+	{
+		ImGui::TableSetupColumn("Draw");
+		ImGui::TableSetupColumn("Time (ms)");
+		ImGui::TableHeadersRow();
+
+		for (size_t i = 0; i < shown; ++i)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::Text("%s", draws[i]->name.c_str());
+			ImGui::TableNextColumn();
+			ImGui::Text("%.4f", draws[i]->milliseconds);
+		}
+		ImGui::EndTable();
+	}
+}
@@ -52,12 +52,14 @@ void Inspector::OnRender()
 		ImGui::Text("Position");
 		ImGui::SameLine();
 		ImGui::SetCursorPosX(xPos);
-		ImGui::DragFloat3("##Position", &selectedObject->transform.position[0], 0.01f, 0.0f, 0.0f, "%g");
+		glm::vec3 position = selectedObject->transform.GetPosition();
+		if (ImGui::DragFloat3("##Position", &position[0], 0.01f, 0.0f, 0.0f, "%g"))
+			selectedObject->transform.SetPosition(position);
 
 		static void* lastObject = nullptr;
 		if (selectedObject != lastObject)
 		{
-			cachedEulerDegrees = glm::degrees(glm::eulerAngles(selectedObject->transform.rotation));
+			cachedEulerDegrees = glm::degrees(glm::eulerAngles(selectedObject->transform.GetRotation()));
 			lastObject = selectedObject;
 		}
 
@@ -75,13 +77,15 @@ void Inspector::OnRender()
 			glm::quat roll = glm::angleAxis(eulerRadians.z, glm::vec3(0.0f, 0.0f, 1.0f));
 
 			// Translate back to radians and quaternion for internal memory
-			selectedObject->transform.rotation = yaw * pitch * roll;
+			selectedObject->transform.SetRotation(yaw * pitch * roll);
 		}
 
 		ImGui::Text("Scale");
 		ImGui::SameLine();
 		ImGui::SetCursorPosX(xPos);
-		ImGui::DragFloat3("##Scale", &selectedObject->transform.scale[0], 0.01f, 0.0f, 0.0f, "%g");
+		glm::vec3 scale = selectedObject->transform.GetScale();
+		if (ImGui::DragFloat3("##Scale", &scale[0], 0.01f, 0.0f, 0.0f, "%g"))
+			selectedObject->transform.SetScale(scale);
 
 		if (Camera* camera = dynamic_cast<Camera*>(selectedObject))
 		{
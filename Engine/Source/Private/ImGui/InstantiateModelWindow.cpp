@@ -53,7 +53,9 @@ void InstantiateModelWindow::OnRender()
 			selectedModel = name;
 	}
 
-	ImGui::DragFloat3("Position", &transform.position[0], 0.01f, 0.0f, 0.0f, "%g");
+	glm::vec3 position = transform.GetPosition();
+	if (ImGui::DragFloat3("Position", &position[0], 0.01f, 0.0f, 0.0f, "%g"))
+		transform.SetPosition(position);
 	if (ImGui::DragFloat3("Rotation", &cachedEulerDegrees[0], 0.1f, 0.0f, 0.0f, "%g"))
 	{
 		cachedEulerDegrees = WrapEuler180(cachedEulerDegrees);
@@ -65,9 +67,11 @@ void InstantiateModelWindow::OnRender()
 		glm::quat roll = glm::angleAxis(eulerRadians.z, glm::vec3(0.0f, 0.0f, 1.0f));
 
 		// Translate back to radians and quaternion for internal memory
-		transform.rotation = yaw * pitch * roll;
+		transform.SetRotation(yaw * pitch * roll);
 	}
-	ImGui::DragFloat3("Scale", &transform.scale[0], 0.01f, 0.0f, 0.0f, "%g");
+	glm::vec3 scale = transform.GetScale();
+	if (ImGui::DragFloat3("Scale", &scale[0], 0.01f, 0.0f, 0.0f, "%g"))
+		transform.SetScale(scale);
 
 	ImGui::BeginDisabled(selectedModel.size() < 1);
 	if (ImGui::Button("Instantiate Model"))
@@ -1,8 +1,10 @@
 #include <ImGui/LoadModelWindow.h>
 
 #include <string>
+#include <cstdio>
 
 #include <Core/ModelManager.h>
+#include <Core/ModelLoadRequest.h>
 
 using namespace VulkanRenderer;
 
@@ -17,16 +19,14 @@ void LoadModelWindow::OnRender()
 	static std::string name;
 	static char nameBuffer[1024];
 
-	strncpy_s(nameBuffer, name.c_str(), sizeof(nameBuffer));
-	nameBuffer[sizeof(nameBuffer) - 1] = '\0';
+	std::snprintf(nameBuffer, sizeof(nameBuffer), "%s", name.c_str());
 
 	static std::string path;
 	static char pathBuffer[1024];
 
-	strncpy_s(pathBuffer, path.c_str(), sizeof(pathBuffer));
-	pathBuffer[sizeof(pathBuffer) - 1] = '\0';
+	std::snprintf(pathBuffer, sizeof(pathBuffer), "%s", path.c_str());
 
-	ImGui::Text("Load a .glb format model.");
+	ImGui::Text("Load a .glb or .gltf model.");
 
 	if (ImGui::InputText("Name", nameBuffer, sizeof(nameBuffer)))
 	{
@@ -41,8 +41,35 @@ void LoadModelWindow::OnRender()
 	ImGui::BeginDisabled(name.size() < 1 || path.size() < 1);
 	if (ImGui::Button("Load Model"))
 	{
-		m_ModelManager->LoadModel(name, path);
-		SetOpen(false);
+		m_ModelManager->LoadModelAsync(name, path);
 	}
 	ImGui::EndDisabled();
+
+	RenderPendingLoads();
+}
+
+void LoadModelWindow::RenderPendingLoads()
+{
+	const auto& pendingLoads = m_ModelManager->GetPendingLoads();
+	if (pendingLoads.empty())
+		return;
+
+	ImGui::Separator();
+	ImGui::Text("Loading");
+
+	for (const auto& request : pendingLoads)
+	{
+		ImGui::PushID(request.get());
+
+		ImGui::Text("%s (%s)", request->GetName().c_str(), ModelLoadRequest::GetStateName(request->GetState()));
+		ImGui::ProgressBar(request->GetProgress(), ImVec2(-80.0f, 0.0f));
+		ImGui::SameLine();
+
+		ImGui::BeginDisabled(request->IsCancelled());
+		if (ImGui::Button("Cancel"))
+			request->Cancel();
+		ImGui::EndDisabled();
+
+		ImGui::PopID();
+	}
 }
\ No newline at end of file
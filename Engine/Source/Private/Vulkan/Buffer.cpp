@@ -65,7 +65,11 @@ void VulkanBuffer::CreateBuffer(VkBufferUsageFlags usageFlags, VkMemoryPropertyF
 
 	if (propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
 	{
-		allocationInfo.flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+		// Host visible transfer destinations are readback buffers, which need cached memory for random reads
+		if (usageFlags & VK_BUFFER_USAGE_TRANSFER_DST_BIT)
+			allocationInfo.flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
+		else
+			allocationInfo.flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
 
 		if (!(propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
 		{
@@ -1,6 +1,7 @@
 #include <Vulkan/Config.h>
 
 #include <iostream>
+#include <cstring>
 
 #include <volk.h>
 
@@ -29,12 +29,18 @@ void VulkanDescriptorPool::CreateDescriptorPool(size_t meshCount)
 	constexpr uint32_t SET_COUNT = 2;
 	constexpr uint32_t SAMPLER_COUNT = 2;
 
-	std::array<VkDescriptorPoolSize, 2> poolSizes{};
+	// Instance matrices, draw instance lists and the culling buffers, a fixed number of sets per frame in flight
+	constexpr uint32_t STORAGE_BUFFER_COUNT = 12;
+
+	std::array<VkDescriptorPoolSize, 3> poolSizes{};
 	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	poolSizes[0].descriptorCount = static_cast<uint32_t>(meshCount * VulkanConfig::MAX_FRAMES_IN_FLIGHT);
 
 	poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	poolSizes[1].descriptorCount = static_cast<uint32_t>(meshCount * VulkanConfig::MAX_FRAMES_IN_FLIGHT * SAMPLER_COUNT * SET_COUNT);
+
+	poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSizes[2].descriptorCount = STORAGE_BUFFER_COUNT * VulkanConfig::MAX_FRAMES_IN_FLIGHT;
 	
 	VkDescriptorPoolCreateInfo poolInfo{};
 	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
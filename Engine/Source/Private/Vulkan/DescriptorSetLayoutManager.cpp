@@ -11,14 +11,14 @@ VulkanDescriptorSetLayoutManager::VulkanDescriptorSetLayoutManager(VulkanDevice*
 	: device(device)
 {
 	CreateCameraDescriptorSetLayout();
-	CreateMeshDescriptorSetLayout();
+	CreateInstanceDescriptorSetLayout();
 	CreateMaterialDescriptorSetLayout();
 }
 
 VulkanDescriptorSetLayoutManager::~VulkanDescriptorSetLayoutManager()
 {
 	vkDestroyDescriptorSetLayout(device->GetLogical(), cameraDescriptorSetLayout, nullptr);
-	vkDestroyDescriptorSetLayout(device->GetLogical(), meshDescriptorSetLayout, nullptr);
+	vkDestroyDescriptorSetLayout(device->GetLogical(), instanceDescriptorSetLayout, nullptr);
 	vkDestroyDescriptorSetLayout(device->GetLogical(), materialDescriptorSetLayout, nullptr);
 }
 
@@ -27,9 +27,9 @@ VkDescriptorSetLayout VulkanDescriptorSetLayoutManager::GetCameraDescriptorSetLa
 	return cameraDescriptorSetLayout;
 }
 
-VkDescriptorSetLayout VulkanDescriptorSetLayoutManager::GetMeshDescriptorSetLayout() const
+VkDescriptorSetLayout VulkanDescriptorSetLayoutManager::GetInstanceDescriptorSetLayout() const
 {
-	return meshDescriptorSetLayout;
+	return instanceDescriptorSetLayout;
 }
 
 VkDescriptorSetLayout VulkanDescriptorSetLayoutManager::GetMaterialDescriptorSetLayout() const
@@ -57,23 +57,33 @@ void VulkanDescriptorSetLayoutManager::CreateCameraDescriptorSetLayout()
 	}
 }
 
-void VulkanDescriptorSetLayoutManager::CreateMeshDescriptorSetLayout()
+void VulkanDescriptorSetLayoutManager::CreateInstanceDescriptorSetLayout()
 {
-	VkDescriptorSetLayoutBinding uboBinding{};
-	uboBinding.binding = 0;
-	uboBinding.descriptorCount = 1;
-	uboBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	uboBinding.pImmutableSamplers = nullptr;
-	uboBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	// World matrices of every mesh instance
+	VkDescriptorSetLayoutBinding matricesBinding{};
+	matricesBinding.binding = 0;
+	matricesBinding.descriptorCount = 1;
+	matricesBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	matricesBinding.pImmutableSamplers = nullptr;
+	matricesBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+	// Instance indices of the frame's instanced draws, indexed by gl_InstanceIndex
+	VkDescriptorSetLayoutBinding drawInstancesBinding{};
+	drawInstancesBinding.binding = 1;
+	drawInstancesBinding.descriptorCount = 1;
+	drawInstancesBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	drawInstancesBinding.pImmutableSamplers = nullptr;
+	drawInstancesBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 	
+	std::array<VkDescriptorSetLayoutBinding, 2> bindings = {matricesBinding, drawInstancesBinding};
 	VkDescriptorSetLayoutCreateInfo layoutInfo{};
 	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	layoutInfo.bindingCount = 1;
-	layoutInfo.pBindings = &uboBinding;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
 
-	if (vkCreateDescriptorSetLayout(device->GetLogical(), &layoutInfo, nullptr, &meshDescriptorSetLayout) != VK_SUCCESS)
+	if (vkCreateDescriptorSetLayout(device->GetLogical(), &layoutInfo, nullptr, &instanceDescriptorSetLayout) != VK_SUCCESS)
 	{
-		std::cerr << "Failed to create mesh descriptor set layout" << std::endl;
+		std::cerr << "Failed to create instance descriptor set layout" << std::endl;
 	}
 }
 
@@ -5,6 +5,7 @@
 #include <set>
 
 #include <Vulkan/Config.h>
+#include <Vulkan/SamplerCache.h>
 
 using namespace VulkanRenderer;
 
@@ -16,10 +17,14 @@ VulkanDevice::VulkanDevice(VkInstance instance, VkSurfaceKHR surface)
 	CreateAllocator();
 	CreateCommandPool();
 	CreateCommandBuffers();
+
+	samplerCache = new VulkanSamplerCache(this);
 }
 
 VulkanDevice::~VulkanDevice()
 {
+	delete samplerCache;
+
 	vmaDestroyAllocator(allocator);
 
 	vkDestroyCommandPool(logicalDevice, commandPool, nullptr);
@@ -50,6 +55,7 @@ void VulkanDevice::SelectPhysicalDevice()
 	if (candidates.rbegin()->first > 0)
 	{
 		physicalDevice = candidates.rbegin()->second;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
 	}
 	else
 	{
@@ -75,16 +81,35 @@ void VulkanDevice::CreateLogicalDevice()
 		queueCreateInfos.push_back(queueCreateInfo);
 	}
 
+	VkPhysicalDeviceFeatures supportedFeatures{};
+	vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
+	textureCompressionBC = supportedFeatures.textureCompressionBC == VK_TRUE;
+
+	// Indirect draws written by a compute pass start at non-zero instances of the draw instance list
+	drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance == VK_TRUE;
+
 	VkPhysicalDeviceFeatures deviceFeatures{};
 	deviceFeatures.samplerAnisotropy = VK_TRUE;
+	deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+	deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
 
 	VkDeviceCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 	createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 	createInfo.pQueueCreateInfos = queueCreateInfos.data();
 	createInfo.pEnabledFeatures = &deviceFeatures;
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(VulkanConfig::deviceExtensions.size());
-	createInfo.ppEnabledExtensionNames = VulkanConfig::deviceExtensions.data();
+
+	// Swap chain extensions are only needed when presenting to a surface
+	if (surface != VK_NULL_HANDLE)
+	{
+		createInfo.enabledExtensionCount = static_cast<uint32_t>(VulkanConfig::deviceExtensions.size());
+		createInfo.ppEnabledExtensionNames = VulkanConfig::deviceExtensions.data();
+	}
+	else
+	{
+		createInfo.enabledExtensionCount = 0;
+	}
 
 	if (VulkanConfig::enableValidationLayers)
 	{
@@ -205,6 +230,11 @@ void VulkanDevice::EndSingleTimeCommands(VkCommandBuffer commandBuffer) const
 	vkFreeCommandBuffers(logicalDevice, commandPool, 1, &commandBuffer);
 }
 
+VkCommandPool VulkanDevice::GetCommandPool() const
+{
+	return commandPool;
+}
+
 VkDevice VulkanDevice::GetLogical() const
 {
 	return logicalDevice;
@@ -215,7 +245,22 @@ VkPhysicalDevice VulkanDevice::GetPhysical() const
 	return physicalDevice;
 }
 
+const VkPhysicalDeviceProperties& VulkanDevice::GetProperties() const
+{
+	return properties;
+}
+
+VulkanSamplerCache* VulkanDevice::GetSamplerCache() const
+{
+	return samplerCache;
+}
+
 VmaAllocator VulkanDevice::GetAllocator() const
 {
 	return allocator;
+}
+
+bool VulkanDevice::SupportsTextureCompressionBC() const
+{
+	return textureCompressionBC;
 }
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include <Vulkan/GeometryArena.h>
+
+#include <iostream>
+#include <algorithm>
+
+#include <Vulkan/Device.h>
+#include <Vulkan/Buffer.h>
+#include <Vulkan/UploadBatch.h>
+
+using namespace VulkanRenderer;
+
+static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+bool VulkanGeometryArena::RangeAllocator::Allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset)
+{
+	for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it)
+	{
+		VkDeviceSize rangeOffset = it->first;
+		VkDeviceSize rangeEnd = it->first + it->second;
+
+		VkDeviceSize alignedOffset = AlignUp(rangeOffset, alignment);
+		if (alignedOffset + size > rangeEnd)
+			continue;
+
+		freeRanges.erase(it);
+
+		// Keep the padding before and the tail after the allocation free
+		if (alignedOffset > rangeOffset)
+			freeRanges[rangeOffset] = alignedOffset - rangeOffset;
+		if (alignedOffset + size < rangeEnd)
+			freeRanges[alignedOffset + size] = rangeEnd - (alignedOffset + size);
+
+		outOffset = alignedOffset;
+		return true;
+	}
+
+	return false;
+}
+
+void VulkanGeometryArena::RangeAllocator::Free(VkDeviceSize offset, VkDeviceSize size)
+{
+	auto it = freeRanges.emplace(offset, size).first;
+
+	// Merge with the following range
+	auto next = std::next(it);
+	if (next != freeRanges.end() && it->first + it->second == next->first)
+	{
+		it->second += next->second;
+		freeRanges.erase(next);
+	}
+
+	// Merge with the preceding range
+	if (it != freeRanges.begin())
+	{
+		auto previous = std::prev(it);
+		if (previous->first + previous->second == it->first)
+		{
+			previous->second += it->second;
+			freeRanges.erase(it);
+		}
+	}
+}
+
+VulkanGeometryArena::VulkanGeometryArena(VulkanDevice* device, VkDeviceSize vertexBlockSize, VkDeviceSize indexBlockSize)
+	: device(device), vertexBlockSize(vertexBlockSize), indexBlockSize(indexBlockSize)
+{
+
+}
+
+VulkanGeometryArena::~VulkanGeometryArena()
+{
+	for (Block& block : blocks)
+	{
+		delete block.indexBuffer;
+		delete block.vertexBuffer;
+	}
+}
+
+uint32_t VulkanGeometryArena::CreateBlock(VkDeviceSize vertexSize, VkDeviceSize indexSize)
+{
+	Block block;
+	block.vertexBuffer = new VulkanBuffer(device, vertexSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	block.indexBuffer = new VulkanBuffer(device, indexSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	block.vertexRanges.freeRanges[0] = vertexSize;
+	block.indexRanges.freeRanges[0] = indexSize;
+
+	blocks.push_back(std::move(block));
+	return static_cast<uint32_t>(blocks.size() - 1);
+}
+
+GeometryAllocation VulkanGeometryArena::Allocate(VulkanUploadBatch* uploadBatch, const void* vertices, VkDeviceSize vertexStride, uint32_t vertexCount, const void* indices, VkIndexType indexType, uint32_t indexCount)
+{
+	VkDeviceSize indexSize = indexType == VK_INDEX_TYPE_UINT32 ? 4 : 2;
+
+	// Zero sized ranges would alias their neighbours, so every allocation takes at least one element
+	VkDeviceSize vertexBytes = vertexStride * std::max(vertexCount, 1u);
+	VkDeviceSize indexBytes = indexSize * std::max(indexCount, 1u);
+
+	GeometryAllocation allocation;
+
+	for (uint32_t i = 0; i < blocks.size() && !allocation.IsValid(); ++i)
+	{
+		Block& block = blocks[i];
+
+		VkDeviceSize vertexOffset = 0;
+		if (!block.vertexRanges.Allocate(vertexBytes, vertexStride, vertexOffset))
+			continue;
+
+		VkDeviceSize indexOffset = 0;
+		if (!block.indexRanges.Allocate(indexBytes, indexSize, indexOffset))
+		{
+			block.vertexRanges.Free(vertexOffset, vertexBytes);
+			continue;
+		}
+
+		allocation.block = i;
+		allocation.vertexByteOffset = vertexOffset;
+		allocation.indexByteOffset = indexOffset;
+	}
+
+	if (!allocation.IsValid())
+	{
+		// Geometry bigger than a block gets a block sized to fit
+		uint32_t blockIndex = CreateBlock(std::max(vertexBlockSize, vertexBytes), std::max(indexBlockSize, indexBytes));
+		Block& block = blocks[blockIndex];
+
+		block.vertexRanges.Allocate(vertexBytes, vertexStride, allocation.vertexByteOffset);
+		block.indexRanges.Allocate(indexBytes, indexSize, allocation.indexByteOffset);
+		allocation.block = blockIndex;
+	}
+
+	allocation.vertexByteSize = vertexBytes;
+	allocation.indexByteSize = indexBytes;
+	allocation.vertexOffset = static_cast<int32_t>(allocation.vertexByteOffset / vertexStride);
+	allocation.firstIndex = static_cast<uint32_t>(allocation.indexByteOffset / indexSize);
+	allocation.indexCount = indexCount;
+	allocation.indexType = indexType;
+
+	const Block& block = blocks[allocation.block];
+	uploadBatch->UploadBuffer(block.vertexBuffer->Get(), vertices, vertexStride * vertexCount, allocation.vertexByteOffset);
+	uploadBatch->UploadBuffer(block.indexBuffer->Get(), indices, indexSize * indexCount, allocation.indexByteOffset);
+
+	return allocation;
+}
+
+void VulkanGeometryArena::Free(const GeometryAllocation& allocation)
+{
+	if (!allocation.IsValid() || allocation.block >= blocks.size())
+		return;
+
+	Block& block = blocks[allocation.block];
+	block.vertexRanges.Free(allocation.vertexByteOffset, allocation.vertexByteSize);
+	block.indexRanges.Free(allocation.indexByteOffset, allocation.indexByteSize);
+}
+
+VkBuffer VulkanGeometryArena::GetVertexBuffer(uint32_t block) const
+{
+	return blocks[block].vertexBuffer->Get();
+}
+
+VkBuffer VulkanGeometryArena::GetIndexBuffer(uint32_t block) const
+{
+	return blocks[block].indexBuffer->Get();
+}
+
+size_t VulkanGeometryArena::GetBlockCount() const
+{
+	return blocks.size();
+}
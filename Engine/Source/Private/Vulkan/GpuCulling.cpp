@@ -0,0 +1,368 @@
+#include <Vulkan/GpuCulling.h>
+
+#include <iostream>
+#include <array>
+#include <algorithm>
+#include <unordered_map>
+
+#include <Core/Shader.h>
+#include <Core/MeshPrimitive.h>
+#include <Core/RenderItem.h>
+#include <Core/Frustum.h>
+#include <Vulkan/Config.h>
+#include <Vulkan/Device.h>
+#include <Vulkan/Buffer.h>
+#include <Vulkan/InstanceBuffer.h>
+
+using namespace VulkanRenderer;
+
+// Must match local_size_x in Cull.comp
+static constexpr uint32_t WorkgroupSize = 64;
+
+namespace
+{
+	// Matches CullConstants in Cull.comp
+	struct CullConstants
+	{
+		glm::vec4 planes[6];
+		uint32_t recordCount;
+	};
+}
+
+VulkanGpuCulling::VulkanGpuCulling(VulkanDevice* device, VkDescriptorSetLayout instanceDescriptorSetLayout, VkDescriptorPool descriptorPool)
+	: device(device)
+{
+	frames.resize(VulkanConfig::MAX_FRAMES_IN_FLIGHT);
+
+	CreateDescriptorSetLayout();
+	CreateComputePipeline();
+	CreateDescriptorSets(instanceDescriptorSetLayout, descriptorPool);
+}
+
+VulkanGpuCulling::~VulkanGpuCulling()
+{
+	for (FrameBuffers& frame : frames)
+	{
+		if (frame.mappedRecords)
+			frame.records->Unmap();
+		if (frame.mappedCommandTemplates)
+			frame.commandTemplates->Unmap();
+	}
+
+	vkDestroyPipeline(device->GetLogical(), pipeline, nullptr);
+	vkDestroyPipelineLayout(device->GetLogical(), pipelineLayout, nullptr);
+	vkDestroyDescriptorSetLayout(device->GetLogical(), descriptorSetLayout, nullptr);
+}
+
+void VulkanGpuCulling::SetRenderItems(const std::vector<RenderItem>& renderItems)
+{
+	if (renderItems.size() == builtItemCount)
+		return;
+
+	builtItemCount = renderItems.size();
+	++generation;
+
+	records.clear();
+	commandTemplates.clear();
+	batches.clear();
+
+	std::unordered_map<MeshPrimitive*, uint32_t> batchIndices;
+
+	for (const RenderItem& item : renderItems)
+	{
+		if (!item.primitive->GetGeometry().IsValid())
+			continue;
+
+		auto [it, inserted] = batchIndices.try_emplace(item.primitive, static_cast<uint32_t>(batches.size()));
+		if (inserted)
+		{
+			GpuDrawBatch batch;
+			batch.primitive = item.primitive;
+			batch.meshInstance = item.meshInstance;
+			batch.primitiveIndex = item.primitiveIndex;
+			batches.push_back(batch);
+		}
+
+		++batches[it->second].maxInstanceCount;
+	}
+
+	// Batches sharing a pipeline and arena block sit next to each other so drawing them rebinds less
+	std::sort(batches.begin(), batches.end(),
+		[](const GpuDrawBatch& a, const GpuDrawBatch& b)
+		{
+			const GeometryAllocation& geometryA = a.primitive->GetGeometry();
+			const GeometryAllocation& geometryB = b.primitive->GetGeometry();
+
+			if (a.primitive->GetVertexFormat() != b.primitive->GetVertexFormat())
+				return a.primitive->GetVertexFormat() < b.primitive->GetVertexFormat();
+			if (geometryA.block != geometryB.block)
+				return geometryA.block < geometryB.block;
+			return geometryA.indexType < geometryB.indexType;
+		});
+
+	uint32_t instanceCount = 0;
+	for (uint32_t i = 0; i < batches.size(); ++i)
+	{
+		GpuDrawBatch& batch = batches[i];
+		const GeometryAllocation& geometry = batch.primitive->GetGeometry();
+
+		batch.firstInstance = instanceCount;
+		instanceCount += batch.maxInstanceCount;
+
+		batchIndices[batch.primitive] = i;
+
+		VkDrawIndexedIndirectCommand command{};
+		command.indexCount = geometry.indexCount;
+		command.instanceCount = 0;
+		command.firstIndex = geometry.firstIndex;
+		command.vertexOffset = geometry.vertexOffset;
+		command.firstInstance = batch.firstInstance;
+		commandTemplates.push_back(command);
+	}
+
+	records.reserve(instanceCount);
+
+	for (const RenderItem& item : renderItems)
+	{
+		if (!item.primitive->GetGeometry().IsValid())
+			continue;
+
+		uint32_t batchIndex = batchIndices[item.primitive];
+		const BoundingSphere& sphere = item.primitive->GetBoundingSphere();
+
+		DrawRecord record{};
+		record.boundingSphere = glm::vec4(sphere.center, sphere.radius);
+		record.instanceIndex = item.instanceIndex;
+		record.batchIndex = batchIndex;
+		record.firstInstance = batches[batchIndex].firstInstance;
+
+		records.push_back(record);
+	}
+}
+
+void VulkanGpuCulling::Dispatch(VkCommandBuffer commandBuffer, uint32_t frame, const Frustum& frustum, VulkanInstanceBuffer* instanceBuffer)
+{
+	if (records.empty())
+		return;
+
+	FrameBuffers& frameBuffers = frames[frame];
+
+	if (frameBuffers.generation != generation)
+		UploadRecords(frame);
+
+	// The instance buffer is reallocated as the scene grows
+	if (frameBuffers.boundInstanceBuffer != instanceBuffer->Get(frame))
+		WriteDescriptorSets(frame, instanceBuffer->Get(frame));
+
+	VkBufferCopy copyRegion{};
+	copyRegion.size = batches.size() * sizeof(VkDrawIndexedIndirectCommand);
+	vkCmdCopyBuffer(commandBuffer, frameBuffers.commandTemplates->Get(), frameBuffers.commands->Get(), 1, &copyRegion);
+
+	VkMemoryBarrier resetBarrier{};
+	resetBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &resetBarrier, 0, nullptr, 0, nullptr);
+
+	CullConstants constants{};
+	for (int i = 0; i < 6; ++i)
+		constants.planes[i] = glm::vec4(frustum.planeX[i], frustum.planeY[i], frustum.planeZ[i], frustum.planeW[i]);
+	constants.recordCount = static_cast<uint32_t>(records.size());
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &frameBuffers.cullDescriptorSet, 0, nullptr);
+	vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullConstants), &constants);
+
+	vkCmdDispatch(commandBuffer, (constants.recordCount + WorkgroupSize - 1) / WorkgroupSize, 1, 1);
+
+	// Commands are consumed by the indirect draws of the render pass that follows, instance lists by its vertex shader
+	VkMemoryBarrier drawBarrier{};
+	drawBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	drawBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	drawBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 1, &drawBarrier, 0, nullptr, 0, nullptr);
+}
+
+const std::vector<GpuDrawBatch>& VulkanGpuCulling::GetBatches() const
+{
+	return batches;
+}
+
+VkBuffer VulkanGpuCulling::GetDrawCommandBuffer(uint32_t frame) const
+{
+	return frames[frame].commands->Get();
+}
+
+VkDescriptorSet VulkanGpuCulling::GetInstanceDescriptorSet(uint32_t frame) const
+{
+	return frames[frame].instanceDescriptorSet;
+}
+
+void VulkanGpuCulling::CreateDescriptorSetLayout()
+{
+	// Records, instance matrices, commands and the draw instance list, in the order Cull.comp declares them
+	std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
+	for (uint32_t i = 0; i < bindings.size(); ++i)
+	{
+		bindings[i].binding = i;
+		bindings[i].descriptorCount = 1;
+		bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[i].pImmutableSamplers = nullptr;
+		bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+
+	if (vkCreateDescriptorSetLayout(device->GetLogical(), &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS)
+	{
+		std::cerr << "Failed to create culling descriptor set layout" << std::endl;
+	}
+}
+
+void VulkanGpuCulling::CreateComputePipeline()
+{
+	Shader cullShader(device->GetLogical(), "Assets/Shaders/Cull.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(CullConstants);
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+	if (vkCreatePipelineLayout(device->GetLogical(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+	{
+		std::cerr << "Failed to create culling pipeline layout" << std::endl;
+		return;
+	}
+
+	VkComputePipelineCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage = cullShader.GetStageCreateInfo();
+	pipelineInfo.layout = pipelineLayout;
+	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineInfo.basePipelineIndex = -1;
+
+	if (vkCreateComputePipelines(device->GetLogical(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+	{
+		std::cerr << "Failed to create culling pipeline" << std::endl;
+	}
+}
+
+void VulkanGpuCulling::CreateDescriptorSets(VkDescriptorSetLayout instanceDescriptorSetLayout, VkDescriptorPool descriptorPool)
+{
+	// A culling set and an instance set for every frame in flight
+	std::vector<VkDescriptorSetLayout> layouts;
+	for (size_t i = 0; i < frames.size(); ++i)
+	{
+		layouts.push_back(descriptorSetLayout);
+		layouts.push_back(instanceDescriptorSetLayout);
+	}
+
+	std::vector<VkDescriptorSet> descriptorSets(layouts.size());
+
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = descriptorPool;
+	allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+	allocInfo.pSetLayouts = layouts.data();
+
+	if (vkAllocateDescriptorSets(device->GetLogical(), &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+	{
+		std::cerr << "Failed to allocate culling descriptor sets" << std::endl;
+		return;
+	}
+
+	for (size_t i = 0; i < frames.size(); ++i)
+	{
+		frames[i].cullDescriptorSet = descriptorSets[i * 2];
+		frames[i].instanceDescriptorSet = descriptorSets[i * 2 + 1];
+	}
+}
+
+void VulkanGpuCulling::UploadRecords(uint32_t frame)
+{
+	FrameBuffers& frameBuffers = frames[frame];
+
+	// The caller has waited on this slot's fence, so its buffers are free to replace
+	bool reallocated = false;
+
+	if (records.size() > frameBuffers.recordCapacity)
+	{
+		size_t capacity = std::max(records.size(), frameBuffers.recordCapacity * 2);
+
+		if (frameBuffers.mappedRecords)
+			frameBuffers.records->Unmap();
+
+		frameBuffers.records = std::make_unique<VulkanBuffer>(device, capacity * sizeof(DrawRecord), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		frameBuffers.mappedRecords = static_cast<DrawRecord*>(frameBuffers.records->Map());
+		frameBuffers.drawInstances = std::make_unique<VulkanBuffer>(device, capacity * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		frameBuffers.recordCapacity = capacity;
+
+		reallocated = true;
+	}
+
+	if (batches.size() > frameBuffers.batchCapacity)
+	{
+		size_t capacity = std::max(batches.size(), frameBuffers.batchCapacity * 2);
+
+		if (frameBuffers.mappedCommandTemplates)
+			frameBuffers.commandTemplates->Unmap();
+
+		frameBuffers.commandTemplates = std::make_unique<VulkanBuffer>(device, capacity * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		frameBuffers.mappedCommandTemplates = static_cast<VkDrawIndexedIndirectCommand*>(frameBuffers.commandTemplates->Map());
+		frameBuffers.commands = std::make_unique<VulkanBuffer>(device, capacity * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		frameBuffers.batchCapacity = capacity;
+
+		reallocated = true;
+	}
+
+	memcpy(frameBuffers.mappedRecords, records.data(), records.size() * sizeof(DrawRecord));
+	memcpy(frameBuffers.mappedCommandTemplates, commandTemplates.data(), commandTemplates.size() * sizeof(VkDrawIndexedIndirectCommand));
+	frameBuffers.generation = generation;
+
+	// Forces the descriptor sets to be rewritten with the new buffers
+	if (reallocated)
+		frameBuffers.boundInstanceBuffer = VK_NULL_HANDLE;
+}
+
+void VulkanGpuCulling::WriteDescriptorSets(uint32_t frame, VkBuffer instanceBuffer)
+{
+	FrameBuffers& frameBuffers = frames[frame];
+
+	std::array<VkBuffer, 4> buffers = {frameBuffers.records->Get(), instanceBuffer, frameBuffers.commands->Get(), frameBuffers.drawInstances->Get()};
+
+	std::array<VkDescriptorBufferInfo, 4> bufferInfos{};
+	std::array<VkWriteDescriptorSet, 4> descriptorWrites{};
+
+	for (uint32_t i = 0; i < buffers.size(); ++i)
+	{
+		bufferInfos[i].buffer = buffers[i];
+		bufferInfos[i].offset = 0;
+		bufferInfos[i].range = VK_WHOLE_SIZE;
+
+		descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[i].dstSet = frameBuffers.cullDescriptorSet;
+		descriptorWrites[i].dstBinding = i;
+		descriptorWrites[i].dstArrayElement = 0;
+		descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptorWrites[i].descriptorCount = 1;
+		descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+	}
+
+	vkUpdateDescriptorSets(device->GetLogical(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+	WriteInstanceDescriptorSet(device, frameBuffers.instanceDescriptorSet, instanceBuffer, frameBuffers.drawInstances->Get());
+
+	frameBuffers.boundInstanceBuffer = instanceBuffer;
+}
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include <Vulkan/GpuProfiler.h>
+
+#include <iostream>
+
+#include <Vulkan/Device.h>
+#include <Vulkan/Config.h>
+
+using namespace VulkanRenderer;
+
+// Every pass and draw owns a begin and end timestamp, passes come first
+static constexpr uint32_t PassQueryCount = static_cast<uint32_t>(GpuPass::Count) * 2;
+
+VulkanGpuProfiler::VulkanGpuProfiler(VulkanDevice* device, uint32_t maxDraws)
+	: device(device), maxDraws(maxDraws)
+{
+	const VkPhysicalDeviceProperties& properties = device->GetProperties();
+
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(device->GetPhysical(), &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(device->GetPhysical(), &queueFamilyCount, queueFamilies.data());
+
+	uint32_t validBits = queueFamilies[device->graphicsQueueFamily].timestampValidBits;
+
+	timestampPeriod = properties.limits.timestampPeriod;
+	timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+	supported = validBits > 0 && timestampPeriod > 0.0;
+
+	if (!supported)
+	{
+		std::cerr << "GPU timestamps are not supported on the graphics queue" << std::endl;
+		return;
+	}
+
+	CreateQueryPools();
+}
+
+VulkanGpuProfiler::~VulkanGpuProfiler()
+{
+	for (FrameQueries& frame : frames)
+	{
+		if (frame.queryPool != VK_NULL_HANDLE)
+			vkDestroyQueryPool(device->GetLogical(), frame.queryPool, nullptr);
+	}
+}
+
+bool VulkanGpuProfiler::IsSupported() const
+{
+	return supported;
+}
+
+void VulkanGpuProfiler::CreateQueryPools()
+{
+	frames.resize(VulkanConfig::MAX_FRAMES_IN_FLIGHT);
+
+	VkQueryPoolCreateInfo queryPoolInfo{};
+	queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	queryPoolInfo.queryCount = PassQueryCount + maxDraws * 2;
+
+	for (FrameQueries& frame : frames)
+	{
+		if (vkCreateQueryPool(device->GetLogical(), &queryPoolInfo, nullptr, &frame.queryPool) != VK_SUCCESS)
+		{
+			std::cerr << "Failed to create timestamp query pool" << std::endl;
+			supported = false;
+			return;
+		}
+	}
+}
+
+void VulkanGpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+	if (!supported)
+		return;
+
+	currentFrame = frameIndex;
+	FrameQueries& frame = frames[currentFrame];
+
+	// The caller has already waited on this slot's fence, so its previous results are complete
+	if (frame.pending)
+		ReadResults(frame);
+
+	vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, PassQueryCount + maxDraws * 2);
+
+	frame.passesWritten.fill(false);
+	frame.drawNames.clear();
+	frame.pending = true;
+}
+
+void VulkanGpuProfiler::BeginPass(VkCommandBuffer commandBuffer, GpuPass pass)
+{
+	if (!supported)
+		return;
+
+	uint32_t query = static_cast<uint32_t>(pass) * 2;
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frames[currentFrame].queryPool, query);
+}
+
+void VulkanGpuProfiler::EndPass(VkCommandBuffer commandBuffer, GpuPass pass)
+{
+	if (!supported)
+		return;
+
+	FrameQueries& frame = frames[currentFrame];
+
+	uint32_t query = static_cast<uint32_t>(pass) * 2 + 1;
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.queryPool, query);
+
+	frame.passesWritten[static_cast<size_t>(pass)] = true;
+}
+
+bool VulkanGpuProfiler::IsPerDrawTimingEnabled() const
+{
+	return supported && perDrawTimingEnabled;
+}
+
+void VulkanGpuProfiler::SetPerDrawTimingEnabled(bool enabled)
+{
+	perDrawTimingEnabled = enabled;
+}
+
+void VulkanGpuProfiler::BeginDraw(VkCommandBuffer commandBuffer, const std::string& name)
+{
+	if (!IsPerDrawTimingEnabled())
+		return;
+
+	FrameQueries& frame = frames[currentFrame];
+	if (frame.drawNames.size() >= maxDraws)
+		return;
+
+	uint32_t query = PassQueryCount + static_cast<uint32_t>(frame.drawNames.size()) * 2;
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool, query);
+
+	frame.drawNames.push_back(name);
+}
+
+void VulkanGpuProfiler::EndDraw(VkCommandBuffer commandBuffer)
+{
+	if (!IsPerDrawTimingEnabled())
+		return;
+
+	FrameQueries& frame = frames[currentFrame];
+	if (frame.drawNames.empty())
+		return;
+
+	// Draws past the pool capacity were never begun
+	uint32_t query = PassQueryCount + static_cast<uint32_t>(frame.drawNames.size()) * 2 - 1;
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.queryPool, query);
+}
+
+const GpuTimings& VulkanGpuProfiler::GetLastTimings() const
+{
+	return lastTimings;
+}
+
+const char* VulkanGpuProfiler::GetPassName(GpuPass pass)
+{
+	switch (pass)
+	{
+	case GpuPass::Cull:
+		return "Cull";
+	case GpuPass::Opaque:
+		return "Opaque";
+	case GpuPass::Transparent:
+		return "Transparent";
+	case GpuPass::ImGui:
+		return "ImGui";
+	default:
+		return "Unknown";
+	}
+}
+
+void VulkanGpuProfiler::ReadResults(FrameQueries& frame)
+{
+	frame.pending = false;
+
+	GpuTimings timings;
+	uint64_t frameBegin = UINT64_MAX;
+	uint64_t frameEnd = 0;
+
+	for (size_t pass = 0; pass < frame.passesWritten.size(); ++pass)
+	{
+		if (!frame.passesWritten[pass])
+			continue;
+
+		uint64_t timestamps[2];
+		VkResult result = vkGetQueryPoolResults(device->GetLogical(), frame.queryPool, static_cast<uint32_t>(pass) * 2, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		if (result != VK_SUCCESS)
+			return;
+
+		timings.passes[pass] = TicksToMilliseconds(timestamps[0], timestamps[1]);
+		frameBegin = std::min(frameBegin, timestamps[0] & timestampMask);
+		frameEnd = std::max(frameEnd, timestamps[1] & timestampMask);
+	}
+
+	if (frameEnd > frameBegin)
+		timings.total = TicksToMilliseconds(frameBegin, frameEnd);
+
+	if (!frame.drawNames.empty())
+	{
+		std::vector<uint64_t> timestamps(frame.drawNames.size() * 2);
+		VkResult result = vkGetQueryPoolResults(device->GetLogical(), frame.queryPool, PassQueryCount, static_cast<uint32_t>(timestamps.size()), timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+		if (result == VK_SUCCESS)
+		{
+			timings.draws.reserve(frame.drawNames.size());
+			for (size_t i = 0; i < frame.drawNames.size(); ++i)
+				timings.draws.push_back({frame.drawNames[i], TicksToMilliseconds(timestamps[i * 2], timestamps[i * 2 + 1])});
+		}
+	}
+
+	timings.valid = true;
+	lastTimings = std::move(timings);
+}
+
+double VulkanGpuProfiler::TicksToMilliseconds(uint64_t begin, uint64_t end) const
+{
+	uint64_t ticks = ((end & timestampMask) - (begin & timestampMask)) & timestampMask;
+	return static_cast<double>(ticks) * timestampPeriod / 1000000.0;
+}
@@ -49,11 +49,19 @@ namespace VulkanRenderer
 			if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
 				indices.graphicsFamily = i;
 
-			VkBool32 presentSupport = false;
-			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+			// Without a surface nothing is presented, so the graphics queue stands in for present
+			if (surface == VK_NULL_HANDLE)
+			{
+				indices.presentFamily = indices.graphicsFamily;
+			}
+			else
+			{
+				VkBool32 presentSupport = false;
+				vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
 
-			if (presentSupport)
-				indices.presentFamily = i;
+				if (presentSupport)
+					indices.presentFamily = i;
+			}
 
 			if (indices.IsComplete())
 				break;
@@ -108,12 +116,15 @@ namespace VulkanRenderer
 		if (!indices.IsComplete())
 			return 0;
 
-		if (!CheckDeviceExtensionSupport(device))
-			return 0;
+		if (surface != VK_NULL_HANDLE)
+		{
+			if (!CheckDeviceExtensionSupport(device))
+				return 0;
 
-		SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(device, surface);
-		if (swapChainSupport.formats.empty() || swapChainSupport.presentModes.empty())
-			return 0;
+			SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(device, surface);
+			if (swapChainSupport.formats.empty() || swapChainSupport.presentModes.empty())
+				return 0;
+		}
 
 		if (!deviceFeatures.samplerAnisotropy)
 			return 0;
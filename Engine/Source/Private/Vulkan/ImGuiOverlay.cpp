@@ -19,11 +19,12 @@
 #include <ImGui/Inspector.h>
 #include <ImGui/AssetBrowser.h>
 #include <ImGui/AboutWindow.h>
+#include <ImGui/GpuProfilerWindow.h>
 
 namespace VulkanRenderer
 {
-	VulkanImGuiOverlay::VulkanImGuiOverlay(VulkanInstance* instance, VulkanDevice* device, VulkanSwapChain* swapChain, VulkanRenderPass* renderPass, GLFWwindow* glfwWindow, Scene* scene, ModelManager* modelManager)
-		: m_Window(glfwWindow)
+	VulkanImGuiOverlay::VulkanImGuiOverlay(VulkanInstance* instance, VulkanDevice* device, VulkanSwapChain* swapChain, VulkanRenderPass* renderPass, GLFWwindow* glfwWindow, Scene* scene, ModelManager* modelManager, VulkanGpuProfiler* gpuProfiler)
+		: m_Window(glfwWindow), m_Scene(scene)
 	{
 		m_DescriptorPool = std::make_unique<ImGuiDescriptorPool>(device);
 
@@ -61,6 +62,7 @@ namespace VulkanRenderer
 		m_Windows["Inspector"] = std::make_unique<Inspector>(scene, this);
 		m_Windows["Asset Browser"] = std::make_unique<AssetBrowser>();
 		m_Windows["About"] = std::make_unique<AboutWindow>();
+		m_Windows["GPU Profiler"] = std::make_unique<GpuProfilerWindow>(gpuProfiler);
 	}
 	
 	VulkanImGuiOverlay::~VulkanImGuiOverlay()
@@ -111,6 +113,11 @@ namespace VulkanRenderer
 					if (m_Windows.count("Asset Browser"))
 						m_Windows["Asset Browser"]->SetOpen(true);
 				}
+				if (ImGui::MenuItem("GPU Profiler"))
+				{
+					if (m_Windows.count("GPU Profiler"))
+						m_Windows["GPU Profiler"]->SetOpen(true);
+				}
 				ImGui::EndMenu();
 			}
 			if (ImGui::BeginMenu("Help"))
@@ -129,6 +136,8 @@ namespace VulkanRenderer
 		{
 			window->Render();
 		}
+
+		PickObject();
 		
 		Draw(commandBuffer);
 	}
@@ -159,6 +168,37 @@ namespace VulkanRenderer
 		style.WindowBorderSize = 0.0f;
 	}
 	
+	void VulkanImGuiOverlay::PickObject()
+	{
+		ImGuiIO& imGuiIO = ImGui::GetIO();
+		if (imGuiIO.WantCaptureMouse || !ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+			return;
+
+		Camera* camera = m_Scene->GetMainCamera();
+		if (!camera || imGuiIO.DisplaySize.x <= 0.0f || imGuiIO.DisplaySize.y <= 0.0f)
+			return;
+
+		VkExtent2D extent = {static_cast<uint32_t>(imGuiIO.DisplaySize.x), static_cast<uint32_t>(imGuiIO.DisplaySize.y)};
+		glm::mat4 inverseViewProjection = glm::inverse(camera->GetProjectionMatrix(extent) * camera->GetViewMatrix());
+
+		// The projection flips y, so window coordinates map straight onto clip space
+		float x = 2.0f * imGuiIO.MousePos.x / imGuiIO.DisplaySize.x - 1.0f;
+		float y = 2.0f * imGuiIO.MousePos.y / imGuiIO.DisplaySize.y - 1.0f;
+
+		glm::vec4 nearPoint = inverseViewProjection * glm::vec4(x, y, -1.0f, 1.0f);
+		glm::vec4 farPoint = inverseViewProjection * glm::vec4(x, y, 1.0f, 1.0f);
+		nearPoint /= nearPoint.w;
+		farPoint /= farPoint.w;
+
+		glm::vec3 origin = glm::vec3(nearPoint);
+		glm::vec3 ray = glm::vec3(farPoint) - origin;
+		float length = glm::length(ray);
+		if (length <= 0.0f)
+			return;
+
+		SelectObject(m_Scene->RayCast(origin, ray / length, length));
+	}
+
 	void VulkanImGuiOverlay::Draw(VkCommandBuffer commandBuffer)
 	{
 		ImGui::Render();
@@ -1,5 +1,6 @@
 #include <Vulkan/Image.h>
 
+#include <algorithm>
 #include <iostream>
 
 #include <Vulkan/Helpers.h>
@@ -7,11 +8,11 @@
 
 using namespace VulkanRenderer;
 
-VulkanImage::VulkanImage(VulkanDevice* device, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags, VkImageAspectFlags aspectFlags)
-	: device(device), format(format), ownsImage(true)
+VulkanImage::VulkanImage(VulkanDevice* device, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags, VkImageAspectFlags aspectFlags, uint32_t mipLevels, VkComponentMapping components)
+	: device(device), format(format), width(width), height(height), mipLevels(mipLevels), ownsImage(true)
 {
-	CreateImage(width, height, format, VK_IMAGE_TILING_OPTIMAL, usageFlags, propertyFlags, image, memory);
-	CreateImageView(aspectFlags);
+	CreateImage(format, VK_IMAGE_TILING_OPTIMAL, usageFlags, propertyFlags, image, memory);
+	CreateImageView(aspectFlags, components);
 }
 
 VulkanImage::VulkanImage(VulkanDevice* device, VkImage existingImage, VkFormat format, VkImageAspectFlags aspectFlags)
@@ -46,7 +47,21 @@ VkImageView VulkanImage::GetImageView() const
 	return imageView;
 }
 
-void VulkanImage::CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags, VkImage& image, VkDeviceMemory& imageMemory)
+uint32_t VulkanImage::GetMipLevels() const
+{
+	return mipLevels;
+}
+
+bool VulkanImage::CanGenerateMipmaps(VulkanDevice* device, VkFormat format)
+{
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties(device->GetPhysical(), format, &formatProperties);
+
+	VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	return (formatProperties.optimalTilingFeatures & requiredFeatures) == requiredFeatures;
+}
+
+void VulkanImage::CreateImage(VkFormat format, VkImageTiling tiling, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags, VkImage& image, VkDeviceMemory& imageMemory)
 {
 	VkDevice logicalDevice = device->GetLogical();
 
@@ -56,7 +71,7 @@ void VulkanImage::CreateImage(uint32_t width, uint32_t height, VkFormat format,
 	imageInfo.extent.width = width;
 	imageInfo.extent.height = height;
 	imageInfo.extent.depth = 1;
-	imageInfo.mipLevels = 1;
+	imageInfo.mipLevels = mipLevels;
 	imageInfo.arrayLayers = 1;
 	imageInfo.format = format;
 	imageInfo.tiling = tiling;
@@ -88,7 +103,7 @@ void VulkanImage::CreateImage(uint32_t width, uint32_t height, VkFormat format,
 	vkBindImageMemory(logicalDevice, image, imageMemory, 0);
 }
 
-void VulkanImage::CreateImageView(VkImageAspectFlags aspectFlags)
+void VulkanImage::CreateImageView(VkImageAspectFlags aspectFlags, VkComponentMapping components)
 {
 	VkImageViewCreateInfo viewInfo{};
 	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -96,14 +111,11 @@ void VulkanImage::CreateImageView(VkImageAspectFlags aspectFlags)
 	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
 	viewInfo.format = format;
 
-	viewInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
-	viewInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
-	viewInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
-	viewInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+	viewInfo.components = components;
 
 	viewInfo.subresourceRange.aspectMask = aspectFlags;
 	viewInfo.subresourceRange.baseMipLevel = 0;
-	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.levelCount = mipLevels;
 	viewInfo.subresourceRange.baseArrayLayer = 0;
 	viewInfo.subresourceRange.layerCount = 1;
 	
@@ -115,6 +127,13 @@ void VulkanImage::TransitionImageLayout(VkImageLayout newLayout)
 {
 	VkCommandBuffer commandBuffer = device->BeginSingleTimeCommands();
 
+	TransitionImageLayout(commandBuffer, newLayout);
+
+	device->EndSingleTimeCommands(commandBuffer);
+}
+
+void VulkanImage::TransitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout)
+{
 	VkImageMemoryBarrier memoryBarrier{};
 	memoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
 	memoryBarrier.oldLayout = currentLayout;
@@ -123,7 +142,7 @@ void VulkanImage::TransitionImageLayout(VkImageLayout newLayout)
 	memoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 	memoryBarrier.image = image;
 	memoryBarrier.subresourceRange.baseMipLevel = 0;
-	memoryBarrier.subresourceRange.levelCount = 1;
+	memoryBarrier.subresourceRange.levelCount = mipLevels;
 	memoryBarrier.subresourceRange.baseArrayLayer = 0;
 	memoryBarrier.subresourceRange.layerCount = 1;
 
@@ -188,6 +207,85 @@ void VulkanImage::TransitionImageLayout(VkImageLayout newLayout)
 		0, nullptr,
 		1, &memoryBarrier
 	);
+}
 
-	device->EndSingleTimeCommands(commandBuffer);
-}
\ No newline at end of file
+void VulkanImage::GenerateMipmaps(VkCommandBuffer commandBuffer, uint32_t uploadedLevels)
+{
+	VkImageMemoryBarrier memoryBarrier{};
+	memoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	memoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	memoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	memoryBarrier.image = image;
+	memoryBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	memoryBarrier.subresourceRange.baseArrayLayer = 0;
+	memoryBarrier.subresourceRange.layerCount = 1;
+	memoryBarrier.subresourceRange.levelCount = 1;
+
+	int32_t mipWidth = static_cast<int32_t>(std::max(width >> (uploadedLevels - 1), 1u));
+	int32_t mipHeight = static_cast<int32_t>(std::max(height >> (uploadedLevels - 1), 1u));
+
+	for (uint32_t level = uploadedLevels; level < mipLevels; level++)
+	{
+		// The previous level becomes the blit source once its writes land
+		memoryBarrier.subresourceRange.baseMipLevel = level - 1;
+		memoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		memoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
+
+		int32_t nextWidth = std::max(mipWidth / 2, 1);
+		int32_t nextHeight = std::max(mipHeight / 2, 1);
+
+		VkImageBlit blit{};
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.mipLevel = level - 1;
+		blit.srcSubresource.baseArrayLayer = 0;
+		blit.srcSubresource.layerCount = 1;
+		blit.srcOffsets[1] = { mipWidth, mipHeight, 1 };
+		blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.dstSubresource.mipLevel = level;
+		blit.dstSubresource.baseArrayLayer = 0;
+		blit.dstSubresource.layerCount = 1;
+		blit.dstOffsets[1] = { nextWidth, nextHeight, 1 };
+
+		vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+		mipWidth = nextWidth;
+		mipHeight = nextHeight;
+	}
+
+	// Blit sources sit in TRANSFER_SRC, uploaded levels above them and the last generated level are still TRANSFER_DST
+	VkImageMemoryBarrier finalBarriers[3] = { memoryBarrier, memoryBarrier, memoryBarrier };
+	uint32_t finalBarrierCount = 0;
+
+	auto addFinalBarrier = [&](uint32_t baseLevel, uint32_t levelCount, VkImageLayout oldLayout, VkAccessFlags srcAccessMask)
+	{
+		if (levelCount == 0)
+			return;
+
+		VkImageMemoryBarrier& barrier = finalBarriers[finalBarrierCount++];
+		barrier.subresourceRange.baseMipLevel = baseLevel;
+		barrier.subresourceRange.levelCount = levelCount;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = srcAccessMask;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	};
+
+	if (uploadedLevels < mipLevels)
+	{
+		addFinalBarrier(0, uploadedLevels - 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT);
+		addFinalBarrier(uploadedLevels - 1, mipLevels - uploadedLevels, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT);
+		addFinalBarrier(mipLevels - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT);
+	}
+	else
+	{
+		addFinalBarrier(0, mipLevels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT);
+	}
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, finalBarrierCount, finalBarriers);
+
+	currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
@@ -8,9 +8,12 @@ using namespace VulkanRenderer;
 
 VulkanInstance::VulkanInstance(GLFWwindow* window)
 {
-	CreateInstance();
+	CreateInstance(window != nullptr);
 	SetupDebugMessenger();
-	CreateSurface(window);
+
+	// Headless instances have no window and render offscreen only
+	if (window)
+		CreateSurface(window);
 }
 
 VulkanInstance::~VulkanInstance()
@@ -18,7 +21,8 @@ VulkanInstance::~VulkanInstance()
 	if (VulkanConfig::enableValidationLayers)
 		DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
 
-	vkDestroySurfaceKHR(instance, surface, nullptr);
+	if (surface != VK_NULL_HANDLE)
+		vkDestroySurfaceKHR(instance, surface, nullptr);
 	vkDestroyInstance(instance, nullptr);
 }
 
@@ -32,7 +36,7 @@ VkSurfaceKHR VulkanInstance::GetSurface() const
 	return surface;
 }
 
-void VulkanInstance::CreateInstance()
+void VulkanInstance::CreateInstance(bool enableSurface)
 {
 	VulkanConfig::InitializeVulkanConfig();
 
@@ -48,7 +52,7 @@ void VulkanInstance::CreateInstance()
 	createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 	createInfo.pApplicationInfo = &appInfo;
 
-	std::vector<const char*> requiredExtensions = GetRequiredExtensions();
+	std::vector<const char*> requiredExtensions = GetRequiredExtensions(enableSurface);
 	createInfo.enabledExtensionCount = static_cast<uint32_t>(requiredExtensions.size());
 	createInfo.ppEnabledExtensionNames = requiredExtensions.data();
 
@@ -83,13 +87,18 @@ void VulkanInstance::CreateSurface(GLFWwindow* window)
 	std::cerr << "Failed to create window surface" << std::endl;
 }
 
-std::vector<const char*> VulkanInstance::GetRequiredExtensions()
+std::vector<const char*> VulkanInstance::GetRequiredExtensions(bool enableSurface)
 {
-	uint32_t glfwExtensionCount = 0;
-	const char** glfwExtensions;
-	glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+	std::vector<const char*> extensions;
+
+	if (enableSurface)
+	{
+		uint32_t glfwExtensionCount = 0;
+		const char** glfwExtensions;
+		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
-	std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+		extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	}
 
 	if (VulkanConfig::enableValidationLayers)
 		extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
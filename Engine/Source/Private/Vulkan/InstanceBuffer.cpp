@@ -0,0 +1,159 @@
+#include <Vulkan/InstanceBuffer.h>
+
+#include <iostream>
+#include <algorithm>
+#include <array>
+
+#include <Vulkan/Config.h>
+#include <Vulkan/Device.h>
+#include <Vulkan/Buffer.h>
+
+using namespace VulkanRenderer;
+
+// Matrices the buffers start with, they double from there
+static constexpr size_t InitialCapacity = 1024;
+
+VulkanInstanceBuffer::VulkanInstanceBuffer(VulkanDevice* device, VkDescriptorSetLayout descriptorSetLayout, VkDescriptorPool descriptorPool)
+	: device(device)
+{
+	frames.resize(VulkanConfig::MAX_FRAMES_IN_FLIGHT);
+
+	CreateDescriptorSets(descriptorSetLayout, descriptorPool);
+
+	for (uint32_t i = 0; i < frames.size(); ++i)
+	{
+		ReserveDrawInstances(i, InitialCapacity);
+		Reserve(i, InitialCapacity);
+	}
+}
+
+VulkanInstanceBuffer::~VulkanInstanceBuffer()
+{
+	for (FrameBuffer& frame : frames)
+	{
+		if (frame.matrices)
+			frame.buffer->Unmap();
+		if (frame.drawInstances)
+			frame.drawInstanceBuffer->Unmap();
+	}
+}
+
+bool VulkanInstanceBuffer::Reserve(uint32_t frame, size_t count)
+{
+	FrameBuffer& frameBuffer = frames[frame];
+
+	if (count <= frameBuffer.capacity)
+		return false;
+
+	size_t capacity = std::max(InitialCapacity, frameBuffer.capacity);
+	while (capacity < count)
+		capacity *= 2;
+
+	if (frameBuffer.matrices)
+		frameBuffer.buffer->Unmap();
+
+	frameBuffer.buffer = std::make_unique<VulkanBuffer>(device, capacity * sizeof(glm::mat4), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	frameBuffer.matrices = static_cast<glm::mat4*>(frameBuffer.buffer->Map());
+	frameBuffer.capacity = capacity;
+
+	WriteDescriptorSet(frame);
+	return true;
+}
+
+void VulkanInstanceBuffer::ReserveDrawInstances(uint32_t frame, size_t count)
+{
+	FrameBuffer& frameBuffer = frames[frame];
+
+	if (count <= frameBuffer.drawInstanceCapacity)
+		return;
+
+	size_t capacity = std::max(InitialCapacity, frameBuffer.drawInstanceCapacity);
+	while (capacity < count)
+		capacity *= 2;
+
+	if (frameBuffer.drawInstances)
+		frameBuffer.drawInstanceBuffer->Unmap();
+
+	frameBuffer.drawInstanceBuffer = std::make_unique<VulkanBuffer>(device, capacity * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	frameBuffer.drawInstances = static_cast<uint32_t*>(frameBuffer.drawInstanceBuffer->Map());
+	frameBuffer.drawInstanceCapacity = capacity;
+
+	WriteDescriptorSet(frame);
+}
+
+glm::mat4* VulkanInstanceBuffer::GetMatrices(uint32_t frame) const
+{
+	return frames[frame].matrices;
+}
+
+uint32_t* VulkanInstanceBuffer::GetDrawInstances(uint32_t frame) const
+{
+	return frames[frame].drawInstances;
+}
+
+VkBuffer VulkanInstanceBuffer::Get(uint32_t frame) const
+{
+	return frames[frame].buffer->Get();
+}
+
+VkDescriptorSet VulkanInstanceBuffer::GetDescriptorSet(uint32_t frame) const
+{
+	return frames[frame].descriptorSet;
+}
+
+void VulkanInstanceBuffer::CreateDescriptorSets(VkDescriptorSetLayout descriptorSetLayout, VkDescriptorPool descriptorPool)
+{
+	std::vector<VkDescriptorSetLayout> layouts(frames.size(), descriptorSetLayout);
+	std::vector<VkDescriptorSet> descriptorSets(frames.size());
+
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = descriptorPool;
+	allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+	allocInfo.pSetLayouts = layouts.data();
+
+	if (vkAllocateDescriptorSets(device->GetLogical(), &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+	{
+		std::cerr << "Failed to allocate instance descriptor sets" << std::endl;
+		return;
+	}
+
+	for (size_t i = 0; i < frames.size(); ++i)
+		frames[i].descriptorSet = descriptorSets[i];
+}
+
+void VulkanInstanceBuffer::WriteDescriptorSet(uint32_t frame)
+{
+	FrameBuffer& frameBuffer = frames[frame];
+
+	// Both buffers exist once the constructor has reserved them
+	if (frameBuffer.descriptorSet == VK_NULL_HANDLE || !frameBuffer.buffer || !frameBuffer.drawInstanceBuffer)
+		return;
+
+	WriteInstanceDescriptorSet(device, frameBuffer.descriptorSet, frameBuffer.buffer->Get(), frameBuffer.drawInstanceBuffer->Get());
+}
+
+void VulkanRenderer::WriteInstanceDescriptorSet(VulkanDevice* device, VkDescriptorSet descriptorSet, VkBuffer matrixBuffer, VkBuffer drawInstanceBuffer)
+{
+	std::array<VkBuffer, 2> buffers = {matrixBuffer, drawInstanceBuffer};
+
+	std::array<VkDescriptorBufferInfo, 2> bufferInfos{};
+	std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+
+	for (uint32_t i = 0; i < buffers.size(); ++i)
+	{
+		bufferInfos[i].buffer = buffers[i];
+		bufferInfos[i].offset = 0;
+		bufferInfos[i].range = VK_WHOLE_SIZE;
+
+		descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[i].dstSet = descriptorSet;
+		descriptorWrites[i].dstBinding = i;
+		descriptorWrites[i].dstArrayElement = 0;
+		descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptorWrites[i].descriptorCount = 1;
+		descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+	}
+
+	vkUpdateDescriptorSets(device->GetLogical(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
\ No newline at end of file
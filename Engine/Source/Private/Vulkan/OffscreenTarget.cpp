@@ -0,0 +1,128 @@
+#include <Vulkan/OffscreenTarget.h>
+
+#include <iostream>
+#include <array>
+
+#include <Vulkan/Helpers.h>
+#include <Vulkan/Device.h>
+#include <Vulkan/Image.h>
+#include <Vulkan/Buffer.h>
+
+using namespace VulkanRenderer;
+
+VulkanOffscreenTarget::VulkanOffscreenTarget(VulkanDevice* device, VkExtent2D extent)
+	: extent(extent), device(device)
+{
+	CreateImages();
+}
+
+VulkanOffscreenTarget::~VulkanOffscreenTarget()
+{
+	if (framebuffer != VK_NULL_HANDLE)
+		vkDestroyFramebuffer(device->GetLogical(), framebuffer, nullptr);
+
+	delete depthImage;
+	delete colorImage;
+}
+
+VkFramebuffer VulkanOffscreenTarget::GetFramebuffer() const
+{
+	return framebuffer;
+}
+
+void VulkanOffscreenTarget::CreateImages()
+{
+	colorImage = new VulkanImage(device, extent.width, extent.height, imageFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+
+	VkFormat depthFormat = FindDepthFormat(device->GetPhysical());
+	depthImage = new VulkanImage(device, extent.width, extent.height, depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
+	depthImage->TransitionImageLayout(VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+}
+
+void VulkanOffscreenTarget::CreateFramebuffer(VkRenderPass renderPass)
+{
+	std::array<VkImageView, 2> attachments =
+	{
+		colorImage->GetImageView(),
+		depthImage->GetImageView()
+	};
+
+	VkFramebufferCreateInfo framebufferInfo{};
+	framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+	framebufferInfo.renderPass = renderPass;
+	framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+	framebufferInfo.pAttachments = attachments.data();
+	framebufferInfo.width = extent.width;
+	framebufferInfo.height = extent.height;
+	framebufferInfo.layers = 1;
+
+	if (vkCreateFramebuffer(device->GetLogical(), &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS)
+	{
+		std::cerr << "Failed to create offscreen framebuffer" << std::endl;
+	}
+}
+
+bool VulkanOffscreenTarget::ReadPixels(std::vector<uint8_t>& outPixels)
+{
+	VkDeviceSize bufferSize = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+
+	VulkanBuffer readbackBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	VkCommandBuffer commandBuffer = device->BeginSingleTimeCommands();
+
+	// The render pass leaves the color attachment in transfer source layout, make its writes visible to the copy
+	VkImageMemoryBarrier memoryBarrier{};
+	memoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	memoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	memoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	memoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	memoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	memoryBarrier.image = colorImage->Get();
+	memoryBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	memoryBarrier.subresourceRange.baseMipLevel = 0;
+	memoryBarrier.subresourceRange.levelCount = 1;
+	memoryBarrier.subresourceRange.baseArrayLayer = 0;
+	memoryBarrier.subresourceRange.layerCount = 1;
+	memoryBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+	vkCmdPipelineBarrier
+	(
+		commandBuffer,
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		0,
+		0, nullptr,
+		0, nullptr,
+		1, &memoryBarrier
+	);
+
+	VkBufferImageCopy region{};
+	region.bufferOffset = 0;
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.mipLevel = 0;
+	region.imageSubresource.baseArrayLayer = 0;
+	region.imageSubresource.layerCount = 1;
+
+	region.imageOffset = {0, 0, 0};
+	region.imageExtent = {extent.width, extent.height, 1};
+
+	vkCmdCopyImageToBuffer(commandBuffer, colorImage->Get(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer.Get(), 1, &region);
+
+	device->EndSingleTimeCommands(commandBuffer);
+
+	void* data = readbackBuffer.Map();
+	if (!data)
+		return false;
+
+	vmaInvalidateAllocation(device->GetAllocator(), readbackBuffer.GetAllocation(), 0, VK_WHOLE_SIZE);
+
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	outPixels.assign(bytes, bytes + bufferSize);
+
+	readbackBuffer.Unmap();
+
+	return true;
+}
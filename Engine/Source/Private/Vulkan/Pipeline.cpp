@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <array>
+#include <string>
 
 #include <glm/glm.hpp>
 
@@ -11,10 +12,14 @@
 #include <Core/Mesh.h>
 #include <Core/MeshPrimitive.h>
 #include <Core/Camera.h>
+#include <Core/RenderItem.h>
 #include <Vulkan/Device.h>
 #include <Vulkan/SwapChain.h>
 #include <Vulkan/RenderPass.h>
 #include <Vulkan/DescriptorSetLayoutManager.h>
+#include <Vulkan/GpuProfiler.h>
+#include <Vulkan/GeometryArena.h>
+#include <Vulkan/GpuCulling.h>
 
 using namespace VulkanRenderer;
 
@@ -26,7 +31,8 @@ VulkanPipeline::VulkanPipeline(VulkanDevice* device, VulkanRenderPass* renderPas
 
 VulkanPipeline::~VulkanPipeline()
 {
-	vkDestroyPipeline(device->GetLogical(), pipeline, nullptr);
+	for (VkPipeline pipeline : pipelines)
+		vkDestroyPipeline(device->GetLogical(), pipeline, nullptr);
 	vkDestroyPipelineLayout(device->GetLogical(), pipelineLayout, nullptr);
 }
 
@@ -57,16 +63,6 @@ void VulkanPipeline::CreateGraphicsPipeline(VulkanDescriptorSetLayoutManager* la
 	dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
 	dynamicStateInfo.pDynamicStates = dynamicStates.data();
 
-	auto bindingDescription = Vertex::GetBindingDescription();
-	auto attributeDescriptions = Vertex::GetAttributeDescriptions();
-
-	VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputInfo.vertexBindingDescriptionCount = 1;
-	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-	vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-	vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-	
 	VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo{};
 	inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
 	inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
@@ -151,7 +147,7 @@ void VulkanPipeline::CreateGraphicsPipeline(VulkanDescriptorSetLayoutManager* la
 	std::array<VkDescriptorSetLayout, 3> descriptorSetLayouts =
 	{
 		layoutManager->GetCameraDescriptorSetLayout(),
-		layoutManager->GetMeshDescriptorSetLayout(),
+		layoutManager->GetInstanceDescriptorSetLayout(),
 		layoutManager->GetMaterialDescriptorSetLayout()
 	};
 	
@@ -159,7 +155,15 @@ void VulkanPipeline::CreateGraphicsPipeline(VulkanDescriptorSetLayoutManager* la
 	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	pipelineLayoutInfo.setLayoutCount = (uint32_t)descriptorSetLayouts.size();
 	pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
-	pipelineLayoutInfo.pPushConstantRanges = nullptr;
+
+	// Dequantization transform of the primitive being drawn
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(VertexDequantization);
+
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
 	if (vkCreatePipelineLayout(device->GetLogical(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
 	{
@@ -171,7 +175,6 @@ void VulkanPipeline::CreateGraphicsPipeline(VulkanDescriptorSetLayoutManager* la
 	pipelineInfo.stageCount = 2;
 	pipelineInfo.pStages = shaderStages;
 	pipelineInfo.pInputAssemblyState = &inputAssemblyInfo;
-	pipelineInfo.pVertexInputState = &vertexInputInfo;
 	pipelineInfo.pViewportState = &viewportStateInfo;
 	pipelineInfo.pRasterizationState = &rasterizationStateInfo;
 	pipelineInfo.pMultisampleState = &multisamplingStateInfo;
@@ -184,38 +187,136 @@ void VulkanPipeline::CreateGraphicsPipeline(VulkanDescriptorSetLayoutManager* la
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 	pipelineInfo.basePipelineIndex = -1;
 
-	if (vkCreateGraphicsPipelines(device->GetLogical(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+	for (size_t i = 0; i < pipelines.size(); ++i)
 	{
-		std::cerr << "Failed to create graphics pipeline" << std::endl;
+		VertexFormat format = static_cast<VertexFormat>(i);
+
+		auto bindingDescription = GetVertexBindingDescription(format);
+		auto attributeDescriptions = GetVertexAttributeDescriptions(format);
+
+		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertexInputInfo.vertexBindingDescriptionCount = 1;
+		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+		vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+		vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+		pipelineInfo.pVertexInputState = &vertexInputInfo;
+
+		if (vkCreateGraphicsPipelines(device->GetLogical(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipelines[i]) != VK_SUCCESS)
+		{
+			std::cerr << "Failed to create graphics pipeline" << std::endl;
+		}
 	}
 }
 
-void VulkanPipeline::Render(VkCommandBuffer commandBuffer, uint32_t currentFrame, const std::vector<MeshInstance*>& meshInstances, Camera* camera)
+void VulkanPipeline::Render(VkCommandBuffer commandBuffer, uint32_t currentFrame, const std::vector<InstancedDraw>& draws, Camera* camera, VkDescriptorSet instanceDescriptorSet, VulkanGeometryArena* geometryArena, VulkanGpuProfiler* profiler)
 {
-	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+	if (draws.empty())
+		return;
+
+	bool timeDraws = profiler && profiler->IsPerDrawTimingEnabled();
 
-	// Render opaque meshes
-	for (const auto& meshInstance : meshInstances)
+	BindFrameDescriptorSets(commandBuffer, currentFrame, camera, instanceDescriptorSet);
+
+	BindState state;
+
+	for (const InstancedDraw& draw : draws)
 	{
-		std::shared_ptr<const Mesh> mesh = meshInstance->GetMesh();
-		
-		for (size_t i = 0; i < mesh->GetPrimitiveCount(); ++i)
-		{
-			MeshPrimitive* primitive = mesh->GetPrimitive(i);
-			
-			VkBuffer vertexBuffers[] = {primitive->vertexBuffer->Get()};
-			VkDeviceSize offsets[] = {0};
+		MeshPrimitive* primitive = draw.primitive;
+		const GeometryAllocation& geometry = primitive->GetGeometry();
 
-			// Bind vertex and index buffers of mesh
-			vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-			vkCmdBindIndexBuffer(commandBuffer, primitive->indexBuffer->Get(), 0, VK_INDEX_TYPE_UINT16);
+		if (!geometry.IsValid())
+			continue;
 
-			// Bind camera (view & proj matrices) and mesh (model matrix & textures) descriptor sets
-			std::array<VkDescriptorSet, 3> descriptorSets = {camera->descriptorSets[currentFrame], meshInstance->GetUniformDescriptorSets()[currentFrame], primitive->GetMaterialDescriptorSets()[currentFrame]};
-			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data(), 0, nullptr);
+		BindPrimitive(commandBuffer, currentFrame, primitive, geometryArena, state);
 
-			// Draw the mesh
-			vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(primitive->GetIndicesSize()), 1, 0, 0, 0);
-		}
+		if (timeDraws)
+			profiler->BeginDraw(commandBuffer, draw.meshInstance->GetName() + " [" + std::to_string(draw.primitiveIndex) + "] x" + std::to_string(draw.instanceCount));
+
+		vkCmdDrawIndexed(commandBuffer, geometry.indexCount, draw.instanceCount, geometry.firstIndex, geometry.vertexOffset, draw.firstInstance);
+
+		if (timeDraws)
+			profiler->EndDraw(commandBuffer);
 	}
+}
+
+void VulkanPipeline::RenderIndirect(VkCommandBuffer commandBuffer, uint32_t currentFrame, const VulkanGpuCulling* gpuCulling, Camera* camera, VulkanGeometryArena* geometryArena, VulkanGpuProfiler* profiler)
+{
+	const std::vector<GpuDrawBatch>& batches = gpuCulling->GetBatches();
+
+	if (batches.empty())
+		return;
+
+	bool timeDraws = profiler && profiler->IsPerDrawTimingEnabled();
+
+	// The culling pass has its own draw instance list, paired with the scene's matrices
+	BindFrameDescriptorSets(commandBuffer, currentFrame, camera, gpuCulling->GetInstanceDescriptorSet(currentFrame));
+
+	VkBuffer drawCommandBuffer = gpuCulling->GetDrawCommandBuffer(currentFrame);
+
+	BindState state;
+
+	for (uint32_t i = 0; i < batches.size(); ++i)
+	{
+		BindPrimitive(commandBuffer, currentFrame, batches[i].primitive, geometryArena, state);
+
+		// The visible instance count is only known on the GPU, so the name carries the batch's upper bound
+		if (timeDraws)
+			profiler->BeginDraw(commandBuffer, batches[i].meshInstance->GetName() + " [" + std::to_string(batches[i].primitiveIndex) + "] indirect x<=" + std::to_string(batches[i].maxInstanceCount));
+
+		// Batches with nothing visible draw zero instances
+		vkCmdDrawIndexedIndirect(commandBuffer, drawCommandBuffer, i * sizeof(VkDrawIndexedIndirectCommand), 1, sizeof(VkDrawIndexedIndirectCommand));
+
+		if (timeDraws)
+			profiler->EndDraw(commandBuffer);
+	}
+}
+
+void VulkanPipeline::BindFrameDescriptorSets(VkCommandBuffer commandBuffer, uint32_t currentFrame, Camera* camera, VkDescriptorSet instanceDescriptorSet)
+{
+	// Camera (view & proj matrices) and instance (model matrices) sets stay bound for the whole pass
+	std::array<VkDescriptorSet, 2> descriptorSets = {camera->descriptorSets[currentFrame], instanceDescriptorSet};
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data(), 0, nullptr);
+}
+
+void VulkanPipeline::BindPrimitive(VkCommandBuffer commandBuffer, uint32_t currentFrame, MeshPrimitive* primitive, VulkanGeometryArena* geometryArena, BindState& state)
+{
+	if (primitive == state.primitive)
+		return;
+
+	state.primitive = primitive;
+
+	const GeometryAllocation& geometry = primitive->GetGeometry();
+
+	// Pipelines are bound lazily as primitives of each vertex format come up
+	if (primitive->GetVertexFormat() != state.format)
+	{
+		state.format = primitive->GetVertexFormat();
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[static_cast<size_t>(state.format)]);
+	}
+
+	// Primitives share arena blocks, so buffers are only rebound when the block or index type changes
+	if (geometry.block != state.block)
+	{
+		VkBuffer vertexBuffers[] = {geometryArena->GetVertexBuffer(geometry.block)};
+		VkDeviceSize offsets[] = {0};
+
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+	}
+
+	if (geometry.block != state.block || geometry.indexType != state.indexType)
+	{
+		vkCmdBindIndexBuffer(commandBuffer, geometryArena->GetIndexBuffer(geometry.block), 0, geometry.indexType);
+
+		state.block = geometry.block;
+		state.indexType = geometry.indexType;
+	}
+
+	primitive->RefreshMaterialDescriptorSet(currentFrame);
+
+	VkDescriptorSet materialDescriptorSet = primitive->GetMaterialDescriptorSets()[currentFrame];
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 2, 1, &materialDescriptorSet, 0, nullptr);
+
+	vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VertexDequantization), &primitive->GetDequantization());
 }
\ No newline at end of file
@@ -3,15 +3,15 @@
 #include <iostream>
 #include <array>
 
+#include <Vulkan/Helpers.h>
 #include <Vulkan/Device.h>
-#include <Vulkan/SwapChain.h>
 
 using namespace VulkanRenderer;
 
-VulkanRenderPass::VulkanRenderPass(VulkanDevice* device, VulkanSwapChain* swapChain)
-	: device(device), swapChain(swapChain)
+VulkanRenderPass::VulkanRenderPass(VulkanDevice* device, VkFormat colorFormat, VkImageLayout colorFinalLayout)
+	: device(device)
 {
-	CreateRenderPass(swapChain->imageFormat);
+	CreateRenderPass(colorFormat, colorFinalLayout);
 }
 
 VulkanRenderPass::~VulkanRenderPass()
@@ -24,25 +24,14 @@ VkRenderPass VulkanRenderPass::Get() const
 	return renderPass;
 }
 
-void VulkanRenderPass::Begin(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+void VulkanRenderPass::Begin(VkCommandBuffer commandBuffer, VkFramebuffer framebuffer, VkExtent2D extent)
 {
-	VkCommandBufferBeginInfo beginInfo{};
-	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-	beginInfo.pInheritanceInfo = nullptr;
-
-	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
-	{
-		std::cerr << "Failed to begin recording command buffer" << std::endl;
-		return;
-	}
-
 	VkRenderPassBeginInfo renderPassInfo{};
 	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 	renderPassInfo.renderPass = renderPass;
-	renderPassInfo.framebuffer = swapChain->framebuffers[imageIndex];
+	renderPassInfo.framebuffer = framebuffer;
 	renderPassInfo.renderArea.offset = {0, 0};
-	renderPassInfo.renderArea.extent = swapChain->extent;
+	renderPassInfo.renderArea.extent = extent;
 
 	std::array<VkClearValue, 2> clearValues{};
 	clearValues[0].color = {{ 0.0f, 0.0f, 0.0f }};
@@ -56,39 +45,34 @@ void VulkanRenderPass::Begin(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 	VkViewport viewport{};
 	viewport.x = 0.0f;
 	viewport.y = 0.0f;
-	viewport.width = static_cast<float>(swapChain->extent.width);
-	viewport.height = static_cast<float>(swapChain->extent.height);
+	viewport.width = static_cast<float>(extent.width);
+	viewport.height = static_cast<float>(extent.height);
 	viewport.minDepth = 0.0f;
 	viewport.maxDepth = 1.0f;
 	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
 	VkRect2D scissor{};
 	scissor.offset = {0, 0};
-	scissor.extent = swapChain->extent;
+	scissor.extent = extent;
 	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 }
 
 void VulkanRenderPass::End(VkCommandBuffer commandBuffer)
 {
 	vkCmdEndRenderPass(commandBuffer);
-
-	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
-	{
-		std::cerr << "Failed to record command buffer" << std::endl;
-	}
 }
 
-void VulkanRenderPass::CreateRenderPass(VkFormat swapChainImageFormat)
+void VulkanRenderPass::CreateRenderPass(VkFormat colorFormat, VkImageLayout colorFinalLayout)
 {
 	VkAttachmentDescription colorAttachment{};
-	colorAttachment.format = swapChainImageFormat;
+	colorAttachment.format = colorFormat;
 	colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
 	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
 	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	colorAttachment.finalLayout = colorFinalLayout;
 
 	VkAttachmentReference colorAttachmentRef{};
 	colorAttachmentRef.attachment = 0;
@@ -114,12 +98,14 @@ void VulkanRenderPass::CreateRenderPass(VkFormat swapChainImageFormat)
 	subpass.pColorAttachments = &colorAttachmentRef;
 	subpass.pDepthStencilAttachment = &depthAttachmentRef;
 
+	// Frames in flight share the depth image, and headless runs share the color image too, with no semaphore between them.
+	// The previous frame's attachment writes have to finish before this frame's layout transitions and clears.
 	VkSubpassDependency dependency{};
 	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
 	dependency.dstSubpass = 0;
-	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-	dependency.srcAccessMask = 0;
-	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
 	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
 	std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment };
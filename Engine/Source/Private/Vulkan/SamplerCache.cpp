@@ -0,0 +1,75 @@
+#include <Vulkan/SamplerCache.h>
+
+#include <iostream>
+#include <cstring>
+
+#include <Vulkan/Device.h>
+
+#include <Core/Hash.h>
+
+using namespace VulkanRenderer;
+
+VulkanSamplerCache::VulkanSamplerCache(VulkanDevice* device)
+	: device(device)
+{
+}
+
+VulkanSamplerCache::~VulkanSamplerCache()
+{
+	for (const auto& [key, sampler] : samplers)
+		vkDestroySampler(device->GetLogical(), sampler, nullptr);
+}
+
+size_t VulkanSamplerCache::SamplerKeyHash::operator()(const SamplerKey& key) const
+{
+	return static_cast<size_t>(HashBytes(key.data(), key.size()));
+}
+
+VkSampler VulkanSamplerCache::GetSampler(const VkSamplerCreateInfo& createInfo)
+{
+	// Copy field by field into zeroed memory so padding never makes equal create infos differ
+	VkSamplerCreateInfo normalized;
+	std::memset(&normalized, 0, sizeof(normalized));
+	normalized.sType = createInfo.sType;
+	normalized.flags = createInfo.flags;
+	normalized.magFilter = createInfo.magFilter;
+	normalized.minFilter = createInfo.minFilter;
+	normalized.mipmapMode = createInfo.mipmapMode;
+	normalized.addressModeU = createInfo.addressModeU;
+	normalized.addressModeV = createInfo.addressModeV;
+	normalized.addressModeW = createInfo.addressModeW;
+	normalized.mipLodBias = createInfo.mipLodBias;
+	normalized.anisotropyEnable = createInfo.anisotropyEnable;
+	normalized.maxAnisotropy = createInfo.maxAnisotropy;
+	normalized.compareEnable = createInfo.compareEnable;
+	normalized.compareOp = createInfo.compareOp;
+	normalized.minLod = createInfo.minLod;
+	normalized.maxLod = createInfo.maxLod;
+	normalized.borderColor = createInfo.borderColor;
+	normalized.unnormalizedCoordinates = createInfo.unnormalizedCoordinates;
+
+	SamplerKey key;
+	std::memcpy(key.data(), &normalized, sizeof(normalized));
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto it = samplers.find(key);
+	if (it != samplers.end())
+		return it->second;
+
+	VkSampler sampler = VK_NULL_HANDLE;
+	if (vkCreateSampler(device->GetLogical(), &normalized, nullptr, &sampler) != VK_SUCCESS)
+	{
+		std::cerr << "Failed to create sampler" << std::endl;
+		return VK_NULL_HANDLE;
+	}
+
+	samplers.emplace(key, sampler);
+	return sampler;
+}
+
+size_t VulkanSamplerCache::GetSamplerCount() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return samplers.size();
+}
@@ -1,15 +1,36 @@
 #include <Vulkan/Texture.h>
 
+#include <algorithm>
 #include <iostream>
 
 #include <Vulkan/Device.h>
 #include <Vulkan/Image.h>
 #include <Vulkan/Buffer.h>
+#include <Vulkan/UploadBatch.h>
+#include <Vulkan/SamplerCache.h>
+
+#include <Core/MipChain.h>
+#include <Core/TextureCompression.h>
 
 #include <stb_image.h>
 
 using namespace VulkanRenderer;
 
+static VkFormat GetTextureVkFormat(TextureFormat format, bool sRGB)
+{
+	switch (format)
+	{
+	case TextureFormat::BC1:
+		return sRGB ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+	case TextureFormat::BC5:
+		return VK_FORMAT_BC5_UNORM_BLOCK;
+	case TextureFormat::BC7:
+		return sRGB ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+	default:
+		return sRGB ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+	}
+}
+
 VulkanTexture::VulkanTexture(VulkanDevice* device, const std::string& path)
 	: device(device)
 {
@@ -17,16 +38,28 @@ VulkanTexture::VulkanTexture(VulkanDevice* device, const std::string& path)
 	CreateTextureSampler();
 }
 
-VulkanTexture::VulkanTexture(VulkanDevice* device, const unsigned char* pixels, int width, int height, bool sRGB)
+VulkanTexture::VulkanTexture(VulkanDevice* device, const unsigned char* pixels, int width, int height, bool sRGB, VulkanUploadBatch* uploadBatch)
 	: device(device)
 {
-	CreateTextureImage(pixels, width, height, sRGB);
+	TextureInfo info;
+	info.data = pixels;
+	info.width = static_cast<uint32_t>(width);
+	info.height = static_cast<uint32_t>(height);
+	info.sRGB = sRGB;
+
+	CreateTextureImage(info, uploadBatch);
+	CreateTextureSampler();
+}
+
+VulkanTexture::VulkanTexture(VulkanDevice* device, const TextureInfo& info, VulkanUploadBatch* uploadBatch)
+	: device(device)
+{
+	CreateTextureImage(info, uploadBatch);
 	CreateTextureSampler();
 }
 
 VulkanTexture::~VulkanTexture()
 {
-	vkDestroySampler(device->GetLogical(), sampler, nullptr);
 	delete image;
 }
 
@@ -40,13 +73,27 @@ VkSampler VulkanTexture::GetSampler() const
 	return sampler;
 }
 
+VulkanImage* VulkanTexture::Recreate(const TextureInfo& info, VulkanUploadBatch* uploadBatch)
+{
+	VulkanImage* previousImage = image;
+
+	CreateTextureImage(info, uploadBatch);
+	generation++;
+
+	return previousImage;
+}
+
+uint32_t VulkanTexture::GetGeneration() const
+{
+	return generation;
+}
+
 void VulkanTexture::CreateTextureImage(const std::string& path)
 {
-	stbi_set_flip_vertically_on_load(true);
+	stbi_set_flip_vertically_on_load_thread(true);
 
 	int width, height, channels;
 	stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
-	VkDeviceSize imageSize = width * height * 4;
 
 	if (!pixels)
 	{
@@ -54,45 +101,63 @@ void VulkanTexture::CreateTextureImage(const std::string& path)
 		return;
 	}
 
-	VulkanBuffer stagingBuffer(device, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	TextureInfo info;
+	info.data = pixels;
+	info.width = static_cast<uint32_t>(width);
+	info.height = static_cast<uint32_t>(height);
 
-	void* data = stagingBuffer.Map();
-	memcpy(data, pixels, static_cast<size_t>(imageSize));
-	stagingBuffer.Unmap();
+	CreateTextureImage(info, nullptr);
 
 	stbi_image_free(pixels);
-
-	image = new VulkanImage(device, width, height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
-	
-	image->TransitionImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-	CopyBufferToImage(device, stagingBuffer.Get(), image->Get(), static_cast<uint32_t>(width), static_cast<uint32_t>(height));
-	image->TransitionImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 }
 
-void VulkanTexture::CreateTextureImage(const unsigned char* pixels, int width, int height, bool sRGB)
+void VulkanTexture::CreateTextureImage(const TextureInfo& info, VulkanUploadBatch* uploadBatch)
 {
-	VkDeviceSize imageSize = width * height * 4;
+	VkFormat format = GetTextureVkFormat(info.format, info.sRGB);
 
-	VulkanBuffer stagingBuffer(device, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	const uint8_t* data = info.data;
+	uint32_t mipLevels = info.mipLevels;
+	uint32_t imageMipLevels = mipLevels;
+	VkImageUsageFlags usageFlags = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
 
-	void* data = stagingBuffer.Map();
-	memcpy(data, pixels, static_cast<size_t>(imageSize));
-	stagingBuffer.Unmap();
+	// Block formats cannot be blitted, so only uncompressed textures are completed here
+	std::vector<uint8_t> generatedPixels;
+	if (info.format == TextureFormat::RGBA8)
+	{
+		imageMipLevels = GetMipLevelCount(info.width, info.height);
+		mipLevels = std::min(mipLevels, imageMipLevels);
+
+		// Without blit support the missing levels are filtered on the CPU instead
+		if (mipLevels < imageMipLevels && !VulkanImage::CanGenerateMipmaps(device, format))
+		{
+			generatedPixels.assign(data, data + GetMipChainSize(info.width, info.height, 1));
+			GenerateMipChain(generatedPixels, info.width, info.height, info.sRGB);
+
+			data = generatedPixels.data();
+			mipLevels = imageMipLevels;
+		}
+
+		if (mipLevels < imageMipLevels)
+			usageFlags |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	}
 
-	VkFormat format = sRGB ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+	VkDeviceSize imageSize = GetTextureDataSize(info.format, info.width, info.height, mipLevels);
 
-	image = new VulkanImage(device, width, height, format, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+	image = new VulkanImage(device, info.width, info.height, format, usageFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT, imageMipLevels, info.components);
 
-	image->TransitionImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-	CopyBufferToImage(device, stagingBuffer.Get(), image->Get(), static_cast<uint32_t>(width), static_cast<uint32_t>(height));
-	image->TransitionImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	if (uploadBatch)
+	{
+		uploadBatch->UploadImage(image, data, imageSize, info.width, info.height, mipLevels, info.format);
+		return;
+	}
+
+	VulkanUploadBatch localBatch(device, imageSize);
+	localBatch.UploadImage(image, data, imageSize, info.width, info.height, mipLevels, info.format);
+	localBatch.SubmitAndWait();
 }
 
 void VulkanTexture::CreateTextureSampler()
 {
-	VkPhysicalDeviceProperties deviceProperties{};
-	vkGetPhysicalDeviceProperties(device->GetPhysical(), &deviceProperties);
-
 	VkSamplerCreateInfo samplerInfo{};
 	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
 	samplerInfo.magFilter = VK_FILTER_LINEAR;
@@ -101,7 +166,7 @@ void VulkanTexture::CreateTextureSampler()
 	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
 	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
 	samplerInfo.anisotropyEnable = VK_TRUE;
-	samplerInfo.maxAnisotropy = deviceProperties.limits.maxSamplerAnisotropy;
+	samplerInfo.maxAnisotropy = device->GetProperties().limits.maxSamplerAnisotropy;
 	samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
 	samplerInfo.unnormalizedCoordinates = VK_FALSE;
 	samplerInfo.compareEnable = VK_FALSE;
@@ -109,11 +174,8 @@ void VulkanTexture::CreateTextureSampler()
 	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 	samplerInfo.mipLodBias = 0.0f;
 	samplerInfo.minLod = 0.0f;
-	samplerInfo.maxLod = 0.0f;
+	// Unclamped so every texture shares one sampler, sampling still stops at the view's last level
+	samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
 
-	if (vkCreateSampler(device->GetLogical(), &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
-	{
-		std::cerr << "Failed to create texture sampler" << std::endl;
-		return;
-	}
+	sampler = device->GetSamplerCache()->GetSampler(samplerInfo);
 }
\ No newline at end of file
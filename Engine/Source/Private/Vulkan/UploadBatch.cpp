@@ -0,0 +1,205 @@
+#include <Vulkan/UploadBatch.h>
+
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+
+#include <Vulkan/Device.h>
+#include <Vulkan/Buffer.h>
+#include <Vulkan/Image.h>
+
+#include <Core/TextureCompression.h>
+
+using namespace VulkanRenderer;
+
+// Satisfies buffer-to-image copy offset rules for every format we upload
+static constexpr VkDeviceSize StagingAlignment = 16;
+
+VulkanUploadBatch::VulkanUploadBatch(VulkanDevice* device, VkDeviceSize stagingBlockSize)
+	: device(device), stagingBlockSize(stagingBlockSize)
+{
+	VkCommandBufferAllocateInfo allocateInfo{};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandPool = device->GetCommandPool();
+	allocateInfo.commandBufferCount = 1;
+
+	if (vkAllocateCommandBuffers(device->GetLogical(), &allocateInfo, &commandBuffer) != VK_SUCCESS)
+	{
+		std::cerr << "Failed to allocate upload command buffer" << std::endl;
+		return;
+	}
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	VkFenceCreateInfo fenceInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+	if (vkCreateFence(device->GetLogical(), &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+	{
+		std::cerr << "Failed to create upload fence" << std::endl;
+	}
+}
+
+VulkanUploadBatch::~VulkanUploadBatch()
+{
+	// Staging memory and the command buffer must outlive the GPU work that reads them
+	if (submitted)
+		Wait();
+
+	for (StagingBlock& block : stagingBlocks)
+	{
+		block.buffer->Unmap();
+		delete block.buffer;
+	}
+
+	if (fence != VK_NULL_HANDLE)
+		vkDestroyFence(device->GetLogical(), fence, nullptr);
+
+	if (commandBuffer != VK_NULL_HANDLE)
+		vkFreeCommandBuffers(device->GetLogical(), device->GetCommandPool(), 1, &commandBuffer);
+}
+
+VkCommandBuffer VulkanUploadBatch::GetCommandBuffer() const
+{
+	return commandBuffer;
+}
+
+VkBuffer VulkanUploadBatch::Stage(const void* data, VkDeviceSize size, VkDeviceSize& outOffset)
+{
+	StagingBlock* block = stagingBlocks.empty() ? nullptr : &stagingBlocks.back();
+
+	VkDeviceSize alignedOffset = block ? (block->offset + StagingAlignment - 1) & ~(StagingAlignment - 1) : 0;
+
+	if (!block || alignedOffset + size > block->size)
+	{
+		// Uploads larger than a block get a block of their own
+		StagingBlock newBlock;
+		newBlock.size = std::max(size, stagingBlockSize);
+		newBlock.buffer = new VulkanBuffer(device, newBlock.size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		newBlock.mappedData = static_cast<uint8_t*>(newBlock.buffer->Map());
+
+		stagingBlocks.push_back(newBlock);
+		block = &stagingBlocks.back();
+		alignedOffset = 0;
+	}
+
+	memcpy(block->mappedData + alignedOffset, data, static_cast<size_t>(size));
+	block->offset = alignedOffset + size;
+	stagingSize += size;
+
+	outOffset = alignedOffset;
+	return block->buffer->Get();
+}
+
+void VulkanUploadBatch::UploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset)
+{
+	if (size == 0)
+		return;
+
+	VkDeviceSize stagingOffset = 0;
+	VkBuffer stagingBuffer = Stage(data, size, stagingOffset);
+
+	VkBufferCopy copyRegion{};
+	copyRegion.srcOffset = stagingOffset;
+	copyRegion.dstOffset = dstOffset;
+	copyRegion.size = size;
+	vkCmdCopyBuffer(commandBuffer, stagingBuffer, dstBuffer, 1, &copyRegion);
+
+	recorded = true;
+}
+
+void VulkanUploadBatch::UploadImage(VulkanImage* image, const void* data, VkDeviceSize size, uint32_t width, uint32_t height, uint32_t mipLevels, TextureFormat format)
+{
+	VkDeviceSize stagingOffset = 0;
+	VkBuffer stagingBuffer = Stage(data, size, stagingOffset);
+
+	image->TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+	std::vector<VkBufferImageCopy> regions(mipLevels);
+	for (uint32_t level = 0; level < mipLevels; level++)
+	{
+		VkBufferImageCopy& region = regions[level];
+		region.bufferOffset = stagingOffset;
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
+
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = level;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+
+		region.imageOffset = { 0, 0, 0 };
+		region.imageExtent = { width, height, 1 };
+
+		stagingOffset += GetTextureLevelSize(format, width, height);
+		width = std::max(width / 2, 1u);
+		height = std::max(height / 2, 1u);
+	}
+
+	vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, image->Get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels, regions.data());
+
+	if (image->GetMipLevels() > mipLevels)
+		image->GenerateMipmaps(commandBuffer, mipLevels);
+	else
+		image->TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	recorded = true;
+}
+
+VkDeviceSize VulkanUploadBatch::GetStagingSize() const
+{
+	return stagingSize;
+}
+
+bool VulkanUploadBatch::IsEmpty() const
+{
+	return !recorded;
+}
+
+bool VulkanUploadBatch::IsSubmitted() const
+{
+	return submitted;
+}
+
+void VulkanUploadBatch::Submit()
+{
+	if (submitted)
+		return;
+
+	vkEndCommandBuffer(commandBuffer);
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+
+	if (vkQueueSubmit(device->graphicsQueue, 1, &submitInfo, fence) != VK_SUCCESS)
+	{
+		std::cerr << "Failed to submit upload batch" << std::endl;
+		return;
+	}
+
+	submitted = true;
+}
+
+bool VulkanUploadBatch::IsComplete() const
+{
+	return submitted && vkGetFenceStatus(device->GetLogical(), fence) == VK_SUCCESS;
+}
+
+void VulkanUploadBatch::Wait() const
+{
+	if (submitted)
+		vkWaitForFences(device->GetLogical(), 1, &fence, VK_TRUE, UINT64_MAX);
+}
+
+void VulkanUploadBatch::SubmitAndWait()
+{
+	Submit();
+	Wait();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include <Core/Bounds.h>
+
+namespace VulkanRenderer
+{
+	struct Frustum;
+
+	// Dynamic bounding volume hierarchy over caller-owned items.
+	// Leaves hold boxes grown by a margin so small movements cost nothing, larger ones reinsert the leaf and rotate its path back into balance.
+	class AabbTree
+	{
+	public:
+		static constexpr int32_t InvalidProxy = -1;
+
+		AabbTree();
+		~AabbTree();
+
+		int32_t CreateProxy(const BoundingBox& box, uint32_t item);
+		void DestroyProxy(int32_t proxy);
+
+		// Returns true when the box left the proxy's margin and the leaf was reinserted
+		bool MoveProxy(int32_t proxy, const BoundingBox& box);
+
+		uint32_t GetItem(int32_t proxy) const;
+		const BoundingBox& GetFatBox(int32_t proxy) const;
+
+		// Queries append the items of every leaf whose margin box passes, callers refine against exact bounds
+		void QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& outItems) const;
+		void QuerySphere(const glm::vec3& center, float radius, std::vector<uint32_t>& outItems) const;
+		void QueryBox(const BoundingBox& box, std::vector<uint32_t>& outItems) const;
+
+		// Visits leaves the ray reaches, nearest subtrees first. hitTest returns the exact hit distance or a negative value for a miss,
+		// and every hit shortens the ray so farther subtrees are skipped. Returns false when nothing was hit.
+		bool RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, const std::function<float(uint32_t item)>& hitTest, uint32_t& outItem, float& outDistance) const;
+
+		size_t GetProxyCount() const;
+		int32_t GetHeight() const;
+
+	private:
+		struct Node
+		{
+			BoundingBox box;
+			uint32_t item = 0;
+
+			// Parent while in the tree, next free node while on the free list
+			int32_t parent = InvalidProxy;
+			int32_t child1 = InvalidProxy;
+			int32_t child2 = InvalidProxy;
+
+			// Leaves are zero, free nodes are negative
+			int32_t height = -1;
+
+			bool IsLeaf() const
+			{
+				return child1 == InvalidProxy;
+			}
+		};
+
+		std::vector<Node> nodes;
+		int32_t root = InvalidProxy;
+		int32_t freeList = InvalidProxy;
+		size_t proxyCount = 0;
+
+		// Reused by the queries, which is why they are not safe to run concurrently
+		mutable std::vector<int32_t> stack;
+
+		void CollectItems(int32_t node, std::vector<uint32_t>& outItems) const;
+
+		int32_t AllocateNode();
+		void FreeNode(int32_t node);
+
+		void InsertLeaf(int32_t leaf);
+		void RemoveLeaf(int32_t leaf);
+
+		// Single AVL-style rotation at node, returns the node now at its place
+		int32_t Balance(int32_t node);
+	};
+}
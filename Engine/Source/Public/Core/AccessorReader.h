@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <fastgltf/types.hpp>
+
+namespace VulkanRenderer
+{
+	class GltfFile;
+
+	// Float member of an interleaved destination element filled from one accessor
+	struct VertexAttributeTarget
+	{
+		const fastgltf::Accessor* accessor = nullptr;
+
+		// Byte offset of the member within each destination element
+		size_t offset = 0;
+		uint32_t componentCount = 0;
+	};
+
+	// Converts glTF components to float, normalized integers map to [0, 1] or [-1, 1] and everything else keeps its value
+	void ConvertComponents(const void* src, fastgltf::ComponentType componentType, bool normalized, size_t count, float* dst);
+
+	// Converts every target's accessor and interleaves them into count elements stride bytes apart in one sweep over the output.
+	// Elements past the end of a shorter accessor are left untouched.
+	void ReadVertexAttributes(const GltfFile& file, const fastgltf::Asset& asset, const std::vector<VertexAttributeTarget>& targets, size_t count, void* outData, size_t stride);
+
+	// Widens any index component type to 32 bits, outIndices must hold accessor.count entries
+	void ReadIndices(const GltfFile& file, const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, uint32_t* outIndices);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <cfloat>
+
+#include <glm/glm.hpp>
+
+#include <Core/Vertex.h>
+
+namespace VulkanRenderer
+{
+	// Axis aligned box, empty until a point is added
+	struct BoundingBox
+	{
+		glm::vec3 min = glm::vec3(FLT_MAX);
+		glm::vec3 max = glm::vec3(-FLT_MAX);
+
+		bool IsValid() const;
+
+		void Expand(const glm::vec3& point);
+		void Expand(const BoundingBox& box);
+
+		glm::vec3 GetCenter() const;
+		// Half the size along each axis
+		glm::vec3 GetExtents() const;
+
+		float GetSurfaceArea() const;
+
+		bool Contains(const BoundingBox& box) const;
+		bool Intersects(const BoundingBox& box) const;
+		bool IntersectsSphere(const glm::vec3& center, float radius) const;
+
+		// Slab test, inverseDirection is one over each direction component. Rays starting inside hit at distance zero.
+		bool IntersectsRay(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, float& outDistance) const;
+
+		// Box around the transformed box, never smaller than the exact bounds of the transformed contents
+		BoundingBox Transformed(const glm::mat4& matrix) const;
+	};
+
+	// Sphere around the box center, empty while the radius is negative
+	struct BoundingSphere
+	{
+		glm::vec3 center = glm::vec3(0.0f);
+		float radius = -1.0f;
+
+		bool IsValid() const;
+
+		// Radius grows by the largest axis scale, so the sphere still holds the contents under non-uniform scale
+		BoundingSphere Transformed(const glm::mat4& matrix) const;
+	};
+
+	BoundingBox ComputeBounds(const std::vector<Vertex>& vertices);
+
+	// Centered on the box and only as large as the farthest vertex, tighter than the box's own corners
+	BoundingSphere ComputeBoundingSphere(const std::vector<Vertex>& vertices, const BoundingBox& bounds);
+}
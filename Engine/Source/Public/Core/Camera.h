@@ -9,6 +9,7 @@
 
 #include <Core/SceneObject.h>
 #include <Core/Transform.h>
+#include <Core/Frustum.h>
 #include <Vulkan/UniformBuffer.h>
 
 namespace VulkanRenderer
@@ -24,6 +25,10 @@ namespace VulkanRenderer
 		void CreateDescriptorSets(VkDescriptorPool descriptorPool);
 
 		void UpdateUniformBuffer(uint32_t currentImage, VkExtent2D swapChainExtent);
+
+		glm::mat4 GetViewMatrix() const;
+		glm::mat4 GetProjectionMatrix(VkExtent2D swapChainExtent) const;
+		Frustum GetFrustum(VkExtent2D swapChainExtent) const;
 		
 		float fov = 70.0f;
 
@@ -6,17 +6,24 @@
 
 #include <volk.h>
 
+#include <Core/EngineSettings.h>
+#include <Core/FrameTimings.h>
+
 namespace VulkanRenderer
 {
 	class GlfwWindow;
 	class VulkanInstance;
 	class VulkanDevice;
 	class VulkanSwapChain;
+	class VulkanOffscreenTarget;
 	class VulkanRenderPass;
 	class VulkanDescriptorSetLayoutManager;
 	class VulkanPipeline;
 	class VulkanDescriptorPool;
+	class VulkanGeometryArena;
 	class VulkanSync;
+	class VulkanGpuProfiler;
+	class VulkanGpuCulling;
 	class ModelManager;
 	class MeshInstance;
 	class Scene;
@@ -26,24 +33,39 @@ namespace VulkanRenderer
 	class Engine
 	{
 	public:
-		Engine();
+		Engine(const EngineSettings& settings = {});
 		~Engine();
 
 		void FramebufferResized();
 
 		void Run();
 
+		// Draws a fixed number of frames, writing headless output images as configured in the settings
+		void RunFrames(uint32_t frameCount);
+
+		Scene* GetScene() const;
+		ModelManager* GetModelManager() const;
+
+		const FrameTimings& GetLastFrameTimings() const;
+		VulkanGpuProfiler* GetGpuProfiler() const;
+
 	private:
+		EngineSettings settings;
+
 		std::unique_ptr<GlfwWindow> glfwWindow;
 		std::unique_ptr<VulkanInstance> instance;
 		std::unique_ptr<VulkanDevice> device;
 		std::unique_ptr<VulkanSwapChain> swapChain;
+		std::unique_ptr<VulkanOffscreenTarget> offscreenTarget;
 		std::unique_ptr<VulkanRenderPass> renderPass;
 		std::unique_ptr<VulkanDescriptorSetLayoutManager> descriptorSetLayoutManager;
 		std::unique_ptr<VulkanPipeline> opaquePipeline;
 		std::unique_ptr<VulkanPipeline> transparentPipeline;
 		std::unique_ptr<VulkanDescriptorPool> descriptorPool;
+		std::unique_ptr<VulkanGeometryArena> geometryArena;
 		std::unique_ptr<VulkanSync> sync;
+		std::unique_ptr<VulkanGpuProfiler> gpuProfiler;
+		std::unique_ptr<VulkanGpuCulling> gpuCulling;
 
 		std::unique_ptr<VulkanImGuiOverlay> imGuiOverlay;
 		
@@ -52,9 +74,16 @@ namespace VulkanRenderer
 		
 		int currentFrame = 0;
 
+		uint32_t headlessFrameIndex = 0;
+
+		FrameTimings lastFrameTimings;
+
 		bool framebufferResized = false;
 		
 		void DrawFrame();
+		void RecordCommandBuffer(VkCommandBuffer commandBuffer, VkFramebuffer framebuffer, VkExtent2D extent);
 		void RecreateSwapChain();
+
+		void WriteHeadlessImage(uint32_t frameIndex);
 	};
 }
\ No newline at end of file
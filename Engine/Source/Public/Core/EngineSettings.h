@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+namespace VulkanRenderer
+{
+	struct EngineSettings
+	{
+		// Render into an offscreen target with no window, surface or swap chain
+		bool headless = false;
+
+		uint32_t width = 1280;
+		uint32_t height = 720;
+
+		// Number of frames Run draws in headless mode
+		uint32_t frameCount = 1;
+
+		// Headless output image, left empty to skip writing to disk
+		std::string outputPath;
+
+		// Write every frame as <outputPath stem>_<frame>.<extension> instead of only the final frame
+		bool writeImageSequence = false;
+
+		// Sizes the descriptor pool, every primitive allocates sets from it
+		size_t maxMeshCount = 1000;
+
+		// Frustum cull opaque draws in a compute pass and draw them indirectly, ignored when the device cannot start indirect draws at a non-zero instance
+		bool gpuCulling = true;
+
+		// Where cooked models are cached between runs, left empty to always import from source
+		std::string modelCacheDirectory = "Cache/Models";
+
+		// Cook model textures into BC formats, ignored when the device cannot sample them
+		bool compressTextures = true;
+
+		// Keep only coarse mip levels of model textures resident and stream finer ones in by on-screen size
+		bool streamTextures = true;
+
+		// GPU memory streamed textures may occupy in bytes, the coarse levels always stay resident even past it
+		uint64_t textureStreamingBudget = 512ull * 1024 * 1024;
+	};
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+namespace VulkanRenderer
+{
+	// CPU time spent in each phase of Engine::DrawFrame, in milliseconds
+	struct FrameTimings
+	{
+		double sceneIteration = 0.0;
+		double uniformUpdates = 0.0;
+		double sorting = 0.0;
+		double commandRecording = 0.0;
+		double submitPresent = 0.0;
+		double total = 0.0;
+	};
+}
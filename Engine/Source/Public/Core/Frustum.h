@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <Core/Bounds.h>
+
+namespace VulkanRenderer
+{
+	enum class FrustumTest
+	{
+		Outside,
+		Intersects,
+		Inside
+	};
+
+	// View volume as inward-facing planes, stored component by component so four planes are tested per instruction.
+	// The six planes are padded to eight with planes nothing can be outside of.
+	struct Frustum
+	{
+		static constexpr int PlaneCount = 8;
+
+		alignas(16) float planeX[PlaneCount];
+		alignas(16) float planeY[PlaneCount];
+		alignas(16) float planeZ[PlaneCount];
+		alignas(16) float planeW[PlaneCount];
+
+		// Planes of a clip-space view-projection matrix
+		static Frustum FromMatrix(const glm::mat4& viewProjection);
+
+		// Conservative, bounds crossing a plane count as inside
+		bool IntersectsSphere(const BoundingSphere& sphere) const;
+		bool IntersectsBox(const BoundingBox& box) const;
+
+		// Tells fully contained boxes apart so hierarchies can accept whole subtrees without testing them
+		FrustumTest ClassifyBox(const BoundingBox& box) const;
+	};
+}
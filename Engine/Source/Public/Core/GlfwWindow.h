@@ -9,7 +9,7 @@ namespace VulkanRenderer
 	class GlfwWindow
 	{
 	public:
-		GlfwWindow(Engine* engine);
+		GlfwWindow(Engine* engine, int width, int height);
 		~GlfwWindow();
 
 		GLFWwindow* Get() const;
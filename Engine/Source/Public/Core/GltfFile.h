@@ -0,0 +1,78 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <fastgltf/core.hpp>
+#include <fastgltf/types.hpp>
+
+namespace VulkanRenderer
+{
+	class MappedFile;
+
+	// A .glb or .gltf file and every buffer and image file it references by URI, all memory-mapped so accessor and image bytes are read in place
+	class GltfFile
+	{
+	public:
+		GltfFile(const std::filesystem::path& path);
+		~GltfFile();
+
+		GltfFile(const GltfFile&) = delete;
+		GltfFile& operator=(const GltfFile&) = delete;
+
+		bool IsValid() const;
+
+		// Bytes of the .glb or .gltf file itself
+		const uint8_t* GetData() const;
+		size_t GetSize() const;
+
+		// Parses either container and maps the files it references, the GLB binary chunk is left in the mapping instead of being copied out.
+		// Data URIs are the only payloads decoded into memory.
+		fastgltf::Expected<fastgltf::Asset> Load(fastgltf::Parser& parser);
+
+		// Empty when the data is missing, e.g. a referenced file that could not be mapped. Safe to call from any thread once loaded.
+		fastgltf::span<const std::byte> GetBufferData(const fastgltf::Asset& asset, size_t bufferIndex) const;
+		fastgltf::span<const std::byte> GetBufferViewData(const fastgltf::Asset& asset, size_t bufferViewIndex) const;
+		fastgltf::span<const std::byte> GetImageData(const fastgltf::Asset& asset, size_t imageIndex) const;
+
+		struct ReferencedFile
+		{
+			// Relative to the .gltf file's directory
+			std::filesystem::path path;
+			const MappedFile* file = nullptr;
+		};
+
+		// Every distinct buffer and image file that was mapped through a URI
+		std::vector<ReferencedFile> GetReferencedFiles(const fastgltf::Asset& asset) const;
+
+		// Lets fastgltf's accessor tools read buffer views through the mappings
+		struct BufferDataAdapter
+		{
+			const GltfFile* file = nullptr;
+
+			fastgltf::span<const std::byte> operator()(const fastgltf::Asset& asset, std::size_t bufferViewIndex) const;
+		};
+
+		BufferDataAdapter GetBufferDataAdapter() const;
+
+	private:
+		std::filesystem::path directory;
+		std::unique_ptr<MappedFile> file;
+
+		// Files referenced by URI, by buffer and image index
+		std::vector<std::unique_ptr<MappedFile>> bufferFiles;
+		std::vector<std::unique_ptr<MappedFile>> imageFiles;
+
+		// Bytes behind every custom buffer id handed to the parser, the GLB binary chunk or a decoded data URI
+		std::vector<fastgltf::span<const std::byte>> customBuffers;
+		std::vector<std::unique_ptr<std::byte[]>> decodedData;
+
+		fastgltf::span<const std::byte> GetSourceData(const fastgltf::DataSource& source, const MappedFile* sourceFile) const;
+		std::unique_ptr<MappedFile> MapUri(const fastgltf::URI& uri) const;
+
+		static fastgltf::BufferInfo MapBuffer(uint64_t size, void* userPointer);
+	};
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace VulkanRenderer
+{
+	// 64-bit non-cryptographic hash in the style of XXH64, fast enough to fingerprint large source files
+	uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+	uint64_t HashString(const std::string& string, uint64_t seed = 0);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+namespace VulkanRenderer
+{
+	// Writes tightly packed RGBA8 pixels as a binary PPM, dropping the alpha channel
+	bool WriteImagePPM(const std::filesystem::path& path, const std::vector<uint8_t>& rgbaPixels, uint32_t width, uint32_t height);
+}
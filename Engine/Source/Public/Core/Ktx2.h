@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <Vulkan/Texture.h>
+
+namespace VulkanRenderer
+{
+	enum class Ktx2Supercompression : uint32_t
+	{
+		None = 0,
+		BasisLZ = 1,
+		Zstandard = 2,
+		ZLIB = 3
+	};
+
+	struct Ktx2Level
+	{
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+
+		// Size of the level once its supercompression is undone
+		size_t uncompressedSize = 0;
+	};
+
+	// Header and level index of a KTX2 container, levels point into the parsed bytes and are ordered largest first
+	struct Ktx2Image
+	{
+		uint32_t vkFormat = 0;
+
+		uint32_t width = 0;
+		uint32_t height = 0;
+
+		Ktx2Supercompression supercompression = Ktx2Supercompression::None;
+
+		std::vector<Ktx2Level> levels;
+	};
+
+	bool IsKtx2(const uint8_t* data, size_t size);
+
+	// Accepts 2D images without array layers or cube faces
+	bool ReadKtx2(const uint8_t* data, size_t size, Ktx2Image& outImage);
+
+	// Appends levelSize bytes of the level's payload to outBytes, inflating Zstandard supercompressed levels.
+	// Levels whose stored or uncompressed size disagrees with levelSize are rejected before anything is allocated,
+	// as are Basis Universal and ZLIB payloads.
+	bool AppendKtx2Level(const Ktx2Image& image, uint32_t level, size_t levelSize, std::vector<uint8_t>& outBytes);
+
+	// Maps the container's VkFormat to a format textures can be created with, false for anything else
+	bool GetKtx2TextureFormat(uint32_t vkFormat, TextureFormat& outFormat);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <filesystem>
+#include <cstdint>
+#include <cstddef>
+
+namespace VulkanRenderer
+{
+	// Read-only memory mapping of a whole file, pages are faulted in by the OS on first access
+	class MappedFile
+	{
+	public:
+		MappedFile(const std::filesystem::path& path);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool IsValid() const;
+
+		const uint8_t* GetData() const;
+		size_t GetSize() const;
+
+	private:
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+
+#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+#else
+		int fileDescriptor = -1;
+#endif
+	};
+}
@@ -20,21 +20,17 @@ namespace VulkanRenderer
 	class Mesh
 	{
 	public:
-		Mesh(VulkanDevice* device, VkDescriptorSetLayout uniformDescriptorSetLayout);
+		Mesh(VulkanDevice* device);
 		~Mesh();
 
 		size_t GetPrimitiveCount() const;
 		MeshPrimitive* GetPrimitive(size_t index) const;
 		
-		VkDescriptorSetLayout GetUniformDescriptorSetLayout() const;
-		
 		void AddPrimitive(std::unique_ptr<MeshPrimitive> meshPrimitive);
 
 	private:
 		VulkanDevice* device;
 		
 		std::vector<std::unique_ptr<MeshPrimitive>> primitives;
-
-		VkDescriptorSetLayout uniformDescriptorSetLayout;
 	};
 }
\ No newline at end of file
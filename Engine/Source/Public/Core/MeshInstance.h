@@ -1,41 +1,25 @@
 #pragma once
 
 #include <memory>
-#include <vector>
 #include <string>
 
-#include <volk.h>
-
 #include <Core/SceneObject.h>
 #include <Core/Transform.h>
 
 namespace VulkanRenderer
 {
-	class VulkanDevice;
-	class VulkanUniformBuffer;
 	class Mesh;
 	
+	// World matrices live in the scene's instance buffer, so an instance is only its mesh and transform
 	class MeshInstance : public SceneObject
 	{
 	public:
-		MeshInstance(const std::string& name, std::shared_ptr<Mesh> mesh, VulkanDevice* device, VkDescriptorPool descriptorPool);
+		MeshInstance(const std::string& name, std::shared_ptr<Mesh> mesh);
 		~MeshInstance();
 
-		std::shared_ptr<const Mesh> GetMesh() const;
-		const std::vector<VkDescriptorSet>& GetUniformDescriptorSets() const;
-		
-		void UpdateUniformBuffer(uint32_t currentImage);
+		const Mesh& GetMesh() const;
 
 	private:
-		VulkanDevice* device;
-
-		std::vector<VkDescriptorSet> uniformDescriptorSets;
-
-		std::vector<VulkanUniformBuffer> uniformBuffers;
-		
 		std::shared_ptr<Mesh> mesh;
-
-		void CreateUniformBuffers();
-		void CreateUniformDescriptorSets(VkDescriptorPool descriptorPool);
 	};
 }
\ No newline at end of file
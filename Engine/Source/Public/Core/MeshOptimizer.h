@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace VulkanRenderer
+{
+	struct Vertex;
+
+	// Merges bitwise identical vertices and rewrites the indices to point at the survivors
+	void WeldVertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+	// Reorders triangles for the post-transform vertex cache using Forsyth's linear-speed algorithm
+	void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+	// Reorders cache-friendly clusters of triangles so outward-facing ones are drawn first, keeping the cache order inside each cluster
+	void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices);
+
+	// Reorders vertices by first use in the index buffer and drops unreferenced ones
+	void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+	// Runs every stage above in order, indices must describe a triangle list
+	void OptimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+}
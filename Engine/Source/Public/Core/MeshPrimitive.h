@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <vector>
 #include <memory>
 
@@ -8,22 +9,47 @@
 
 #include <volk.h>
 
+#include <Vulkan/GeometryArena.h>
+#include <Core/Vertex.h>
+#include <Core/Bounds.h>
+
 namespace VulkanRenderer
 {
 	class VulkanDevice;
 	class VulkanTexture;
-	class VulkanBuffer;
 	class VulkanUniformBuffer;
-	struct Vertex;
+	class VulkanUploadBatch;
+
+	// Geometry already packed in its GPU layout, e.g. straight out of a memory-mapped model cache
+	struct EncodedGeometry
+	{
+		VertexFormat vertexFormat = VertexFormat::Float;
+		VertexDequantization dequantization;
+
+		const void* vertexData = nullptr;
+		uint32_t vertexCount = 0;
+
+		const void* indexData = nullptr;
+		VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+		uint32_t indexCount = 0;
+
+		// Object space bounds of the positions
+		BoundingBox bounds;
+		BoundingSphere boundingSphere;
+	};
+
+	// Narrows indices to 16 bits when every vertex can be addressed with them
+	VkIndexType EncodeIndices(const std::vector<uint32_t>& indices, size_t vertexCount, std::vector<uint8_t>& outData);
 
 	struct MeshPrimitiveInfo
 	{
 		std::vector<Vertex> vertices;
-		std::vector<uint16_t> indices;
+		// Stored as 32-bit, uploaded as 16-bit when every index fits
+		std::vector<uint32_t> indices;
 
-		glm::vec4 baseColorFactor;
-		float metallicFactor;
-		float roughnessFactor;
+		glm::vec4 baseColorFactor = glm::vec4(1.0f);
+		float metallicFactor = 1.0f;
+		float roughnessFactor = 1.0f;
 
 		std::shared_ptr<VulkanTexture> baseColorTexture;
 		std::shared_ptr<VulkanTexture> metallicRoughnessTexture;
@@ -31,27 +57,38 @@ namespace VulkanRenderer
 
 		bool enableTransparency = false;
 		bool doubleSided = false;
+
+		// Uploaded as is instead of vertices and indices when set, must stay valid until the upload is recorded
+		const EncodedGeometry* encodedGeometry = nullptr;
 	};
 
 	class MeshPrimitive
 	{
 	public:
-		MeshPrimitive(VulkanDevice* device, VkDescriptorSetLayout materialDescriptorSetLayout, VkDescriptorPool descriptorPool, const MeshPrimitiveInfo& info);
+		// Records the buffer uploads into the batch when given, otherwise uploads and waits immediately
+		MeshPrimitive(VulkanDevice* device, VulkanGeometryArena* geometryArena, VkDescriptorSetLayout materialDescriptorSetLayout, VkDescriptorPool descriptorPool, const MeshPrimitiveInfo& info, VulkanUploadBatch* uploadBatch = nullptr);
 		~MeshPrimitive();
 		
 		const size_t GetIndicesSize() const;
 
+		const GeometryAllocation& GetGeometry() const;
+
+		VertexFormat GetVertexFormat() const;
+		const VertexDequantization& GetDequantization() const;
+		const BoundingBox& GetBounds() const;
+		const BoundingSphere& GetBoundingSphere() const;
+
 		VkDescriptorImageInfo GetBaseColorDescriptorInfo() const;
 		VkDescriptorImageInfo GetMetallicRoughnessDescriptorInfo() const;
 		VkDescriptorImageInfo GetNormalDescriptorInfo() const;
 
 		const std::vector<VkDescriptorSet>& GetMaterialDescriptorSets() const;
 
+		// Rewrites this frame's set if a streamed texture changed its image since it was last written
+		void RefreshMaterialDescriptorSet(uint32_t currentFrame);
+
 		bool GetTransparencyEnabled() const;
 		
-		VulkanBuffer* vertexBuffer;
-		VulkanBuffer* indexBuffer;
-
 		glm::vec4 baseColorFactor;
 		float metallicFactor;
 		float roughnessFactor;
@@ -60,24 +97,38 @@ namespace VulkanRenderer
 		std::shared_ptr<VulkanTexture> metallicRoughnessTexture;
 		std::shared_ptr<VulkanTexture> normalTexture;
 
+		// Scratch for Scene::BuildInstancedDraws, drawIndex only belongs to the current build while drawStamp matches the scene's
+		uint64_t drawStamp = 0;
+		uint32_t drawIndex = 0;
+
 	private:
 		VulkanDevice* device;
 
-		bool transparencyEnabled = false;
+		VulkanGeometryArena* geometryArena;
+		GeometryAllocation geometry;
 
-		size_t indicesSize;
+		VertexFormat vertexFormat = VertexFormat::Float;
+		VertexDequantization dequantization;
+		BoundingBox bounds;
+		BoundingSphere boundingSphere;
+
+		bool transparencyEnabled = false;
 
 		VkDescriptorSetLayout materialDescriptorSetLayout;
 
 		std::vector<VkDescriptorSet> materialDescriptorSets;
+		std::vector<std::array<uint32_t, 3>> materialTextureGenerations;
 		
 		VulkanUniformBuffer* materialFactorsUniformBuffer;
 		
 		void CreateMaterialFactorsUniformBuffer();
 		
-		void CreateVertexBuffer(const std::vector<Vertex>& vertices);
-		void CreateIndexBuffer(const std::vector<uint16_t>& indices);
+		void CreateGeometry(const MeshPrimitiveInfo& info, VulkanUploadBatch* uploadBatch);
+		void UploadGeometry(const EncodedGeometry& encoded, VulkanUploadBatch* uploadBatch);
 		
 		void CreateMaterialDescriptorSets(VkDescriptorPool descriptorPool);
+		void WriteMaterialDescriptorSet(uint32_t frame);
+
+		std::array<uint32_t, 3> GetTextureGenerations() const;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace VulkanRenderer
+{
+	// Levels in a full chain down to 1x1
+	uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+
+	// Bytes of the first levelCount RGBA8 levels packed back to back
+	size_t GetMipChainSize(uint32_t width, uint32_t height, uint32_t levelCount);
+
+	// Appends every smaller level to the RGBA8 base level with a 2x2 box filter, sRGB color is averaged in linear space
+	void GenerateMipChain(std::vector<uint8_t>& inOutPixels, uint32_t width, uint32_t height, bool sRGB);
+}
@@ -1,19 +1,40 @@
 #pragma once
 
 #include <unordered_map>
+#include <memory>
 #include <string>
+#include <vector>
 
-#include <fastgltf/core.hpp>
-#include <fastgltf/types.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 namespace VulkanRenderer
 {
+	class VulkanTexture;
+	class Mesh;
+
+	// Node of the model's default scene, children index into Model::nodes
+	struct ModelNode
+	{
+		std::string name;
+
+		glm::vec3 position = glm::vec3(0.0f);
+		glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		glm::vec3 scale = glm::vec3(1.0f);
+
+		int32_t meshIndex = -1;
+
+		std::vector<uint32_t> children;
+	};
+
 	struct Model
 	{
 		std::string name;
-		fastgltf::Asset gltfAsset;
-		
+
+		std::vector<ModelNode> nodes;
+		std::vector<uint32_t> rootNodes;
+
 		std::unordered_map<size_t, std::shared_ptr<VulkanTexture>> textures;
 		std::vector<std::shared_ptr<Mesh>> meshes;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include <Core/Model.h>
+#include <Core/MeshPrimitive.h>
+#include <Vulkan/Texture.h>
+
+namespace VulkanRenderer
+{
+	class MappedFile;
+
+	// Pixels of one glTF texture with mipLevels levels packed back to back, empty when the texture has no usable image
+	struct CookedTexture
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipLevels = 1;
+		bool sRGB = false;
+
+		TextureFormat format = TextureFormat::RGBA8;
+		TextureType type = TextureType::Unknown;
+
+		// Identifies identical GPU textures across models, zero never matches
+		uint64_t contentHash = 0;
+
+		const uint8_t* pixels = nullptr;
+		size_t size = 0;
+	};
+
+	struct CookedPrimitive
+	{
+		EncodedGeometry geometry;
+
+		glm::vec4 baseColorFactor = glm::vec4(1.0f);
+		float metallicFactor = 1.0f;
+		float roughnessFactor = 1.0f;
+
+		// glTF texture indices, -1 uses the fallback texture
+		int32_t baseColorTexture = -1;
+		int32_t metallicRoughnessTexture = -1;
+		int32_t normalTexture = -1;
+
+		bool enableTransparency = false;
+		bool doubleSided = false;
+	};
+
+	struct CookedMesh
+	{
+		uint32_t firstPrimitive = 0;
+		uint32_t primitiveCount = 0;
+	};
+
+	// Everything needed to upload a model, payload pointers reference memory owned by whoever produced it
+	struct CookedModel
+	{
+		std::vector<ModelNode> nodes;
+		std::vector<uint32_t> rootNodes;
+
+		std::vector<CookedTexture> textures;
+		std::vector<CookedMesh> meshes;
+		std::vector<CookedPrimitive> primitives;
+	};
+
+	// Identity of one file a cooked model was built from
+	struct ModelFileStamp
+	{
+		uint64_t size = 0;
+		int64_t writeTime = 0;
+		uint64_t contentHash = 0;
+	};
+
+	// A buffer or image file referenced by URI, its path is relative to the source file's directory
+	struct ModelDependencyStamp
+	{
+		std::string path;
+		ModelFileStamp file;
+	};
+
+	struct ModelSourceStamp
+	{
+		ModelFileStamp file;
+		std::vector<ModelDependencyStamp> dependencies;
+	};
+
+	// On-disk cache of cooked models, keyed by source path with the size, time and content hash of the source and every file it references stored inside
+	class ModelCache
+	{
+	public:
+		ModelCache(const std::filesystem::path& directory);
+
+		std::filesystem::path GetCachePath(const std::filesystem::path& sourcePath) const;
+
+		// Maps the cooked file if it matches the source and its dependencies, outModel then points into the returned mapping
+		std::unique_ptr<MappedFile> Open(const std::filesystem::path& sourcePath, CookedModel& outModel) const;
+
+		// Writes through a temporary file so concurrent readers never see a partial cache entry
+		bool Write(const std::filesystem::path& sourcePath, const std::vector<uint8_t>& cookedBytes) const;
+
+		// Size and write time only, the content hash is filled in by the caller
+		static bool GetFileStamp(const std::filesystem::path& path, ModelFileStamp& outStamp);
+
+		static void Serialize(const CookedModel& model, const ModelSourceStamp& stamp, std::vector<uint8_t>& outBytes);
+		static bool Deserialize(const uint8_t* data, size_t size, CookedModel& outModel, ModelSourceStamp& outStamp);
+
+	private:
+		std::filesystem::path directory;
+	};
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <unordered_map>
+
+#include <Core/Vertex.h>
+#include <Core/MeshPrimitive.h>
+#include <Core/ModelCache.h>
+#include <Vulkan/Texture.h>
+
+namespace VulkanRenderer
+{
+	struct Model;
+	class VulkanUploadBatch;
+	class MappedFile;
+	struct TextureStreamingSource;
+
+	enum class ModelLoadState
+	{
+		Queued,
+		Parsing,
+		Decoding,
+		Uploading,
+		Completed,
+		Failed,
+		Cancelled
+	};
+
+	// Shared handle to a model load, every caller asking for the same name while it is in flight gets the same request
+	class ModelLoadRequest
+	{
+	public:
+		ModelLoadRequest(const std::string& name, const std::filesystem::path& path);
+		~ModelLoadRequest();
+
+		const std::string& GetName() const;
+		const std::filesystem::path& GetPath() const;
+
+		ModelLoadState GetState() const;
+		static const char* GetStateName(ModelLoadState state);
+
+		// Fraction of parse, decode and upload work finished so far
+		float GetProgress() const;
+
+		bool IsDone() const;
+
+		// Takes effect at the next job boundary, the model is never published once cancelled
+		void Cancel();
+		bool IsCancelled() const;
+
+		// Only set once the load has completed and the model is resident
+		std::shared_ptr<Model> GetModel() const;
+
+	private:
+		friend class ModelManager;
+
+		std::string name;
+		std::filesystem::path path;
+
+		std::atomic<ModelLoadState> state{ModelLoadState::Queued};
+		std::atomic<bool> cancelled{false};
+
+		std::atomic<uint32_t> completedSteps{0};
+		std::atomic<uint32_t> totalSteps{1};
+
+		std::future<void> importTask;
+
+		// Written by the import task, read on the render thread once it has finished
+		std::shared_ptr<Model> model;
+
+		// Views into the mapped cache file on a warm start, or into the freshly cooked bytes otherwise
+		CookedModel cooked;
+		std::unique_ptr<MappedFile> cacheFile;
+		std::vector<uint8_t> cookedBytes;
+
+		// Takes over cacheFile, or a copy of the texture payloads in cookedBytes, when textures are streamed since their finer levels are read long after the load
+		std::shared_ptr<TextureStreamingSource> streamingSource;
+
+		// Upload cursors advanced by ModelManager::Update
+		size_t nextTexture = 0;
+		size_t nextMesh = 0;
+
+		// Submitted batches stay alive until their fence signals
+		std::vector<std::unique_ptr<VulkanUploadBatch>> uploadBatches;
+
+		// Textures this load uploaded by content hash, only shared with other models once resident
+		std::unordered_map<uint64_t, std::shared_ptr<VulkanTexture>> createdTextures;
+	};
+}
@@ -4,6 +4,8 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <string>
+#include <vector>
+#include <filesystem>
 
 #include <Vulkan/Texture.h>
 
@@ -20,40 +22,103 @@ namespace VulkanRenderer
 {
 	class VulkanDevice;
 	class VulkanTexture;
+	class VulkanUploadBatch;
+	class VulkanGeometryArena;
 	class Transform;
 	class Mesh;
 	class MeshInstance;
+	class ThreadPool;
 	struct MeshInfo;
+	struct MeshPrimitiveInfo;
 	struct Model;
+	struct CookedModel;
+	struct CookedPrimitive;
+	class ModelLoadRequest;
+	class ModelCache;
+	class TextureStreamer;
+	class GltfFile;
 	
 	class ModelManager
 	{
 	public:
-		ModelManager(VulkanDevice* device, VkDescriptorSetLayout uniformDescriptorSetLayout, VkDescriptorSetLayout materialDescriptorSetLayout, VkDescriptorPool descriptorPool);
+		ModelManager(VulkanDevice* device, VulkanGeometryArena* geometryArena, VkDescriptorSetLayout materialDescriptorSetLayout, VkDescriptorPool descriptorPool);
 		~ModelManager();
 
 		const std::unordered_map<std::string, std::shared_ptr<Model>>& GetModels();
 		
 		std::shared_ptr<Model> GetModel(const std::string& name);
 		
+		// Blocks until the model is resident
 		std::shared_ptr<Model> LoadModel(const std::string& name, const std::filesystem::path& path);
-		
-		void LoadTextures(std::shared_ptr<Model>& model);
+
+		// Parses and decodes on worker threads, Update finishes the upload on the render thread
+		std::shared_ptr<ModelLoadRequest> LoadModelAsync(const std::string& name, const std::filesystem::path& path);
+
+		const std::vector<std::shared_ptr<ModelLoadRequest>>& GetPendingLoads() const;
+
+		// Finalizes finished imports within a per-frame time budget, call once per frame on the render thread
+		void Update();
+
+		// Cooked models are written to and mapped from this directory, an empty path disables the cache. Set before loading.
+		void SetCacheDirectory(const std::filesystem::path& directory);
+
+		// Cooks textures into BC formats when the device can sample them, cached models with uncompressed textures are then reimported. Set before loading.
+		void SetTextureCompression(bool enabled);
+
+		// Keeps only the coarse levels of model textures resident and streams finer ones in as they are needed, within budget bytes. Set before loading.
+		void SetTextureStreaming(bool enabled, VkDeviceSize budget);
+
+		// Null unless streaming is enabled
+		TextureStreamer* GetTextureStreamer() const;
+
+		// Builds a mesh from generated geometry, primitives without textures use the fallback texture
+		std::shared_ptr<Mesh> CreateMesh(const std::vector<MeshPrimitiveInfo>& primitiveInfos);
 
 	private:
 		VulkanDevice* device;
+		VulkanGeometryArena* geometryArena;
 		
-		VkDescriptorSetLayout uniformDescriptorSetLayout;
 		VkDescriptorSetLayout materialDescriptorSetLayout;
 
 		VkDescriptorPool descriptorPool;
 		
 		std::unordered_map<std::string, std::shared_ptr<Model>> models;
 
+		std::vector<std::shared_ptr<ModelLoadRequest>> pendingLoads;
+
 		std::shared_ptr<VulkanTexture> fallbackTexture;
+
+		// Resident textures by content hash, entries expire with the last model using them
+		std::unordered_map<uint64_t, std::weak_ptr<VulkanTexture>> textureCache;
+
+		std::unique_ptr<ThreadPool> threadPool;
+
+		std::unique_ptr<ModelCache> modelCache;
+
+		std::unique_ptr<TextureStreamer> textureStreamer;
+
+		bool compressTextures = false;
 		
 		std::shared_ptr<VulkanTexture> CreateFallbackTexture(glm::vec4 color);
 		
-		bool DecodeImage(const fastgltf::Asset& asset, const fastgltf::Image& image, std::vector<uint8_t>& outPixels, int& outWidth, int& outHeight, int& outChannels);
+		// Reads geometry, material factors and texture coordinates, safe to run on any thread
+		void ProcessPrimitive(const GltfFile& file, const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, MeshPrimitiveInfo& outInfo);
+		void CookPrimitive(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, const MeshPrimitiveInfo& info, CookedPrimitive& outPrimitive);
+		void AssignTextures(const Model& model, const CookedPrimitive& primitive, MeshPrimitiveInfo& outInfo);
+
+		static void ReadNodes(const fastgltf::Asset& asset, CookedModel& outModel);
+
+		// Maps a cached model or parses, decodes and cooks the source, then hands over to FinalizeLoad
+		void ImportModel(ModelLoadRequest& request);
+		void BeginUpload(ModelLoadRequest& request);
+
+		// A budget of zero finalizes everything in one call
+		void FinalizeLoad(ModelLoadRequest& request, double budgetMilliseconds);
+
+		void CreateTexture(ModelLoadRequest& request, size_t textureIndex, VulkanUploadBatch* uploadBatch);
+		
+		bool DecodeImage(const GltfFile& file, const fastgltf::Asset& asset, size_t imageIndex, ImageData& outImage);
+		// Keeps the stored levels of block compressed containers, RGBA8 ones only keep their base level
+		bool DecodeKtx2(const uint8_t* data, size_t size, ImageData& outImage);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+namespace VulkanRenderer
+{
+	class MeshInstance;
+	class MeshPrimitive;
+
+	// A single primitive of a mesh instance, merged with others of the same primitive into instanced draws
+	struct RenderItem
+	{
+		MeshInstance* meshInstance = nullptr;
+		MeshPrimitive* primitive = nullptr;
+		uint32_t primitiveIndex = 0;
+
+		// Slot of the instance's world matrix in the scene's instance buffer
+		uint32_t instanceIndex = 0;
+	};
+
+	// Visible instances of one primitive drawn with a single instanced call.
+	// Their instance indices sit at firstInstance onwards in the frame's draw instance list, which the vertex shader reads through gl_InstanceIndex.
+	struct InstancedDraw
+	{
+		MeshPrimitive* primitive = nullptr;
+
+		// First instance of the group, names the draw in the profiler
+		MeshInstance* meshInstance = nullptr;
+		uint32_t primitiveIndex = 0;
+
+		uint32_t firstInstance = 0;
+		uint32_t instanceCount = 0;
+	};
+}
\ No newline at end of file
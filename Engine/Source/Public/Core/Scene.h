@@ -10,10 +10,10 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/quaternion.hpp>
 
-#include <fastgltf/core.hpp>
-#include <fastgltf/types.hpp>
-#include <fastgltf/tools.hpp>
+#include <Core/RenderItem.h>
+#include <Core/Bounds.h>
 
 namespace VulkanRenderer
 {
@@ -22,29 +22,79 @@ namespace VulkanRenderer
 	class MeshInstance;
 	class ModelManager;
 	class Mesh;
+	class MeshPrimitive;
 	class Camera;
 	class Transform;
+	class TransformStore;
 	struct Model;
+	struct ModelNode;
+	struct Frustum;
+	class AabbTree;
+	class VulkanInstanceBuffer;
 
 	class Scene
 	{
 	public:
-		Scene(VulkanDevice* device, ModelManager* modelManager, VkDescriptorSetLayout cameraDescriptorSetLayout, VkDescriptorPool descriptorPool);
+		Scene(VulkanDevice* device, ModelManager* modelManager, VkDescriptorSetLayout cameraDescriptorSetLayout, VkDescriptorSetLayout instanceDescriptorSetLayout, VkDescriptorPool descriptorPool);
 		~Scene();
 
 		const std::vector<std::unique_ptr<SceneObject>>& GetObjects() const;
 		std::vector<std::unique_ptr<SceneObject>>& GetObjectsMutable();
 
+		// Typed views of the objects, filled in by the Create* functions so per-frame code never has to cast
+		const std::vector<MeshInstance*>& GetMeshInstances() const;
+		const std::vector<Camera*>& GetCameras() const;
+
+		// Kept across frames and extended as mesh instances are created, one item per primitive
+		const std::vector<RenderItem>& GetOpaqueRenderItems() const;
+		const std::vector<RenderItem>& GetTransparentRenderItems() const;
+
+		// Items whose world bounds touch the frustum, rebuilt by CullRenderItems into storage kept across frames
+		const std::vector<RenderItem>& GetVisibleOpaqueRenderItems() const;
+		const std::vector<RenderItem>& GetVisibleTransparentRenderItems() const;
+
+		// Instances the spatial index found in view during the last CullRenderItems, also filled when opaque culling runs on the GPU
+		const std::vector<MeshInstance*>& GetVisibleMeshInstances() const;
+
+		// Walks the spatial index for instances in view, then tests their primitives one by one.
+		// Opaque items can be left to a GPU culling pass, the visible opaque list then stays empty.
+		void CullRenderItems(const Frustum& frustum, bool cullOpaque = true);
+
+		// Mesh instances whose world bounds touch the volume, appended to outInstances
+		void QueryBox(const BoundingBox& box, std::vector<MeshInstance*>& outInstances) const;
+		void QuerySphere(const glm::vec3& center, float radius, std::vector<MeshInstance*>& outInstances) const;
+
+		// Nearest mesh instance whose primitive bounds the ray hits, nullptr when there is none
+		MeshInstance* RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float* outDistance = nullptr) const;
+
+		// Back to front over the visible items, in place so steady-state frames do not allocate
+		void SortTransparentRenderItems(const glm::vec3& cameraPosition);
+
+		// Merges visible items of the same primitive into instanced draws and writes their instance indices to the frame's draw instance list.
+		// Opaque draws gather every visible instance of a primitive, transparent ones only merge neighbours so the back to front order holds.
+		void BuildInstancedDraws(int currentFrame);
+
+		const std::vector<InstancedDraw>& GetOpaqueDraws() const;
+		const std::vector<InstancedDraw>& GetTransparentDraws() const;
+
 		Camera* GetMainCamera() const;
 		void SetMainCamera(Camera* camera);
 		
 		SceneObject* CreateSceneObject(const std::string& name, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, Transform* parent);
 		Camera* CreateCamera(const std::string& name, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, Transform* parent);
+		MeshInstance* CreateMeshInstance(const std::string& name, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, Transform* parent, std::shared_ptr<Mesh> mesh);
 
 		SceneObject* InstantiateModel(const std::string& name, const Transform& transform);
 		
+		// One parent-before-child pass over the transform store, only transforms moved since the last call are recomputed.
+		// Mesh instances among them are refit in the spatial index.
+		void UpdateTransforms();
+		// Writes the world matrices that changed since this frame slot was last used, and the camera uniforms
 		void UpdateUniformBuffers(int currentFrame, VkExtent2D swapChainExtent);
 
+		// World matrices by mesh instance index, what render items' instanceIndex refers to
+		VulkanInstanceBuffer* GetInstanceBuffer() const;
+
 	private:
 		VulkanDevice* device;
 		
@@ -54,13 +104,62 @@ namespace VulkanRenderer
 
 		ModelManager* modelManager;
 
+		// Declared before the objects so their transforms detach from it before it is destroyed
+		std::unique_ptr<TransformStore> transformStore;
+
 		std::vector<std::unique_ptr<SceneObject>> objects;
+		std::vector<MeshInstance*> meshInstances;
+		std::vector<Camera*> cameras;
+
+		std::vector<RenderItem> opaqueRenderItems;
+		std::vector<RenderItem> transparentRenderItems;
+
+		std::vector<RenderItem> visibleOpaqueRenderItems;
+		std::vector<RenderItem> visibleTransparentRenderItems;
+		std::vector<MeshInstance*> visibleMeshInstances;
+
+		std::vector<InstancedDraw> opaqueDraws;
+		std::vector<InstancedDraw> transparentDraws;
+
+		// Scratch for grouping, primitives carry their draw index for the build whose stamp they hold.
+		// itemDraws is the draw each visible opaque item joined.
+		uint64_t drawStamp = 0;
+		std::vector<uint32_t> itemDraws;
+
+		// Where each mesh instance sits in the spatial index and render lists, by index into meshInstances
+		struct MeshInstanceRecord
+		{
+			// Union of the primitive bounds in object space
+			BoundingBox localBounds;
+			int32_t proxy = -1;
+
+			uint32_t firstOpaqueItem = 0;
+			uint32_t opaqueItemCount = 0;
+			uint32_t firstTransparentItem = 0;
+			uint32_t transparentItemCount = 0;
+		};
+
+		std::vector<MeshInstanceRecord> meshInstanceRecords;
+
+		// Mesh instance index by transform handle, UINT32_MAX for other objects
+		std::vector<uint32_t> transformMeshInstances;
+
+		std::unique_ptr<AabbTree> spatialIndex;
+
+		std::unique_ptr<VulkanInstanceBuffer> instanceBuffer;
+
+		// Mesh instances whose matrix each frame slot's buffer is missing, frames in flight are written one at a time
+		std::vector<std::vector<uint32_t>> pendingInstanceMatrices;
+
+		// Scratch for the queries, kept so culling does not allocate every frame
+		mutable std::vector<uint32_t> queryItems;
+
 		std::unordered_set<std::string> objectNames;
 
 		Camera* mainCamera = nullptr;
 
-		void InstantiateModelNode(const std::shared_ptr<Model>& model, const fastgltf::Node& node, Transform* parent);
-		
-		MeshInstance* CreateMeshInstance(const std::string& name, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, Transform* parent, std::shared_ptr<Mesh> mesh);
+		BoundingBox GetWorldBounds(uint32_t meshInstanceIndex) const;
+
+		void InstantiateModelNode(const std::shared_ptr<Model>& model, const ModelNode& node, Transform* parent);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <volk.h>
+
+#include <Vulkan/Texture.h>
+
+namespace VulkanRenderer
+{
+	// Bytes of one mip level, block formats round the size up to whole 4x4 blocks
+	size_t GetTextureLevelSize(TextureFormat format, uint32_t width, uint32_t height);
+
+	// Bytes of the first levelCount levels packed back to back
+	size_t GetTextureDataSize(TextureFormat format, uint32_t width, uint32_t height, uint32_t levelCount);
+
+	// BC1 for opaque and BC7 for translucent color, BC5 for the two channels normal and metallic-roughness maps use
+	TextureFormat ChooseCompressedFormat(TextureType type, const uint8_t* pixels, uint32_t width, uint32_t height);
+
+	// Compresses every level of an RGBA8 mip chain, the channels kept depend on the texture type
+	void CompressTexture(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t levelCount, TextureType type, TextureFormat format, std::vector<uint8_t>& outData);
+
+	// View swizzle that presents compressed channels where the shaders expect them
+	VkComponentMapping GetTextureComponentMapping(TextureType type, TextureFormat format);
+}
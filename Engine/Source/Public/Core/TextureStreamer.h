@@ -0,0 +1,108 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <future>
+#include <cstdint>
+
+#include <volk.h>
+
+#include <Vulkan/Texture.h>
+
+namespace VulkanRenderer
+{
+	class VulkanDevice;
+	class VulkanImage;
+	class VulkanUploadBatch;
+	class MeshInstance;
+	class Camera;
+	class MappedFile;
+	class ThreadPool;
+
+	// Keeps the mapped cache file, or the copied texture payloads of a cold import, alive for as long as a model's levels can be streamed
+	struct TextureStreamingSource
+	{
+		TextureStreamingSource();
+		~TextureStreamingSource();
+
+		std::unique_ptr<MappedFile> file;
+		std::vector<uint8_t> bytes;
+	};
+
+	// Starts textures with only their small tail levels resident and streams finer levels in as they cover more of the screen,
+	// dropping levels from the least needed textures again when the resident total would exceed the budget
+	class TextureStreamer
+	{
+	public:
+		TextureStreamer(VulkanDevice* device, VkDeviceSize budget);
+		~TextureStreamer();
+
+		// The levels a texture should be created with before registering it
+		static TextureInfo GetInitialInfo(const TextureInfo& info);
+
+		// info describes the full chain, its data must stay valid for as long as source is alive
+		void Register(const std::shared_ptr<VulkanTexture>& texture, const TextureInfo& info, std::shared_ptr<TextureStreamingSource> source);
+
+		// Picks levels from the screen size of the visible instances and swaps in finished reads, call once per frame on the render thread before recording draws
+		void Update(const std::vector<MeshInstance*>& meshInstances, const Camera* camera, VkExtent2D extent);
+
+		VkDeviceSize GetBudget() const;
+		VkDeviceSize GetResidentSize() const;
+		size_t GetTextureCount() const;
+
+	private:
+		struct StreamedTexture
+		{
+			std::weak_ptr<VulkanTexture> texture;
+			// Only dereferenced while texture has not expired
+			VulkanTexture* texturePointer = nullptr;
+			TextureInfo info;
+			std::shared_ptr<TextureStreamingSource> source;
+
+			uint32_t tailLevel = 0;
+			uint32_t residentLevel = 0;
+			uint32_t targetLevel = 0;
+
+			// Largest on-screen size in pixels this frame, zero when nothing using the texture is drawn
+			float screenSize = 0.0f;
+
+			// Levels from readLevel down copied out of the source by a worker
+			std::future<void> read;
+			std::vector<uint8_t> readData;
+			uint32_t readLevel = 0;
+		};
+
+		struct RetiredImage
+		{
+			VulkanImage* image = nullptr;
+			uint32_t updatesLeft = 0;
+		};
+
+		VulkanDevice* device;
+		VkDeviceSize budget;
+		VkDeviceSize residentSize = 0;
+
+		// Indexed by VulkanTexture::streamingSlot
+		std::vector<std::unique_ptr<StreamedTexture>> textures;
+
+		// Scratch for ordering textures by screen size, kept so steady-state updates do not allocate
+		std::vector<StreamedTexture*> byScreenSize;
+
+		std::vector<RetiredImage> retiredImages;
+		std::vector<std::unique_ptr<VulkanUploadBatch>> uploadBatches;
+
+		std::unique_ptr<ThreadPool> readPool;
+
+		void ReleaseRetired();
+		void RemoveExpired();
+		void ApplyFinishedReads();
+		void MeasureScreenSizes(const std::vector<MeshInstance*>& meshInstances, const Camera* camera, VkExtent2D extent);
+		void PlanLevels();
+		void StartReads();
+
+		void StartRead(StreamedTexture& streamed, uint32_t level);
+
+		static TextureInfo GetLevelInfo(const TextureInfo& info, uint32_t level);
+		static VkDeviceSize GetLevelsSize(const TextureInfo& info, uint32_t level);
+	};
+}
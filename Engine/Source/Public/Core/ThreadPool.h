@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+
+namespace VulkanRenderer
+{
+	class ThreadPool
+	{
+	public:
+		// A thread count of zero uses one worker per hardware thread
+		ThreadPool(size_t threadCount = 0);
+		~ThreadPool();
+
+		size_t GetThreadCount() const;
+
+		std::future<void> Submit(std::function<void()> task);
+
+		// Runs func for every index in [0, count) on the workers and the calling thread, returning once all have finished.
+		// Safe to call from inside a task since the caller keeps claiming work instead of blocking on queued helpers.
+		void ParallelFor(size_t count, const std::function<void(size_t)>& func);
+
+	private:
+		std::vector<std::thread> workers;
+		std::queue<std::packaged_task<void()>> tasks;
+
+		std::mutex mutex;
+		std::condition_variable condition;
+
+		bool stopping = false;
+
+		void WorkerLoop();
+	};
+}
@@ -1,13 +1,16 @@
 #pragma once
 
 #include <vector>
+#include <cstdint>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 namespace VulkanRenderer
 {
 	class SceneObject;
+	class TransformStore;
 
 	class Transform
 	{
@@ -15,26 +18,53 @@ namespace VulkanRenderer
 		Transform();
 		Transform(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
 		~Transform();
+
+		Transform(const Transform&) = delete;
+		Transform& operator=(const Transform&) = delete;
+
+		// Moves the local TRS into the store, which owns it and the cached world matrix from then on.
+		// Transforms that are never attached, like the ones handed to Scene::InstantiateModel, keep their own TRS.
+		void Attach(TransformStore* newStore);
+
+		// Handle within the attached store, TransformStore::InvalidHandle while detached
+		uint32_t GetHandle() const;
 		
 		void SetParent(Transform* transform);
 		Transform* GetParent() const;
 
 		const std::vector<Transform*>& GetChildren() const;
 
+		glm::vec3 GetPosition() const;
+		void SetPosition(const glm::vec3& newPosition);
+
+		glm::quat GetRotation() const;
+		void SetRotation(const glm::quat& newRotation);
+
+		glm::vec3 GetScale() const;
+		void SetScale(const glm::vec3& newScale);
+
+		void SetLocal(const glm::vec3& newPosition, const glm::quat& newRotation, const glm::vec3& newScale);
+
 		glm::mat4 GetLocalMatrix() const;
+
+		// Cached by the store once attached, only a transform moved since the last TransformStore::Update walks up its ancestors here
 		glm::mat4 GetWorldMatrix() const;
 
+		SceneObject* owner = nullptr;
+
+	private:
+		TransformStore* store = nullptr;
+		uint32_t handle = UINT32_MAX;
+
+		// Used only while detached
 		glm::vec3 position;
 		glm::quat rotation;
 		glm::vec3 scale;
 
-		SceneObject* owner = nullptr;
-
-	private:
 		Transform* parent = nullptr;
 		std::vector<Transform*> children;
 		
 		void AddChild(Transform* child);
 		void RemoveChild(Transform* child);
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace VulkanRenderer
+{
+	// Local TRS and world matrices of every scene transform in structure-of-arrays form.
+	// Slots are kept sorted by depth so one forward pass sees every parent before its children, handles stay stable across the reordering.
+	class TransformStore
+	{
+	public:
+		static constexpr uint32_t InvalidHandle = UINT32_MAX;
+
+		TransformStore();
+		~TransformStore();
+
+		uint32_t Add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+		void Remove(uint32_t handle);
+
+		// InvalidHandle makes the transform a root
+		void SetParent(uint32_t handle, uint32_t parentHandle);
+
+		glm::vec3 GetPosition(uint32_t handle) const;
+		glm::quat GetRotation(uint32_t handle) const;
+		glm::vec3 GetScale(uint32_t handle) const;
+
+		void SetPosition(uint32_t handle, const glm::vec3& position);
+		void SetRotation(uint32_t handle, const glm::quat& rotation);
+		void SetScale(uint32_t handle, const glm::vec3& scale);
+		void SetLocal(uint32_t handle, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+
+		glm::mat4 GetLocalMatrix(uint32_t handle) const;
+
+		// Cached from the last Update, recomputed through the ancestors only while this transform or one of them is still pending
+		glm::mat4 GetWorldMatrix(uint32_t handle) const;
+
+		// Re-sorts if the hierarchy changed, then recomposes every moved transform and its descendants four at a time
+		void Update();
+
+		size_t GetCount() const;
+
+		// Handles whose world matrix the last Update recomputed, including descendants of moved transforms
+		const std::vector<uint32_t>& GetMovedHandles() const;
+
+	private:
+		static constexpr uint32_t InvalidSlot = UINT32_MAX;
+
+		std::vector<float> positionX;
+		std::vector<float> positionY;
+		std::vector<float> positionZ;
+
+		std::vector<float> rotationX;
+		std::vector<float> rotationY;
+		std::vector<float> rotationZ;
+		std::vector<float> rotationW;
+
+		std::vector<float> scaleX;
+		std::vector<float> scaleY;
+		std::vector<float> scaleZ;
+
+		std::vector<uint32_t> parentSlots;
+		std::vector<glm::mat4> worldMatrices;
+
+		// Set when the local TRS or parent changed, spread to descendants during Update
+		std::vector<uint8_t> dirty;
+
+		// Slot to handle and back, removed slots keep InvalidHandle until the next sort drops them
+		std::vector<uint32_t> slotHandles;
+		std::vector<uint32_t> handleSlots;
+		std::vector<uint32_t> freeHandles;
+
+		// First slot of each depth followed by the slot count, valid while the order is
+		std::vector<size_t> levelStarts;
+
+		std::vector<uint32_t> movedHandles;
+
+		bool orderChanged = false;
+		bool anyDirty = false;
+		size_t count = 0;
+
+		void MarkDirty(uint32_t slot);
+		bool IsPending(uint32_t slot) const;
+
+		glm::mat4 ComposeLocalMatrix(uint32_t slot) const;
+		glm::mat4 ComputeWorldMatrix(uint32_t slot) const;
+
+		void SortByDepth();
+
+		void ComposeWorldMatrix(uint32_t slot);
+		void ComposeWorldMatrices4(uint32_t slot);
+	};
+}
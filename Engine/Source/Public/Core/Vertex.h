@@ -1,6 +1,8 @@
 #pragma once
 
 #include <array>
+#include <vector>
+#include <cstdint>
 
 #include <volk.h>
 
@@ -23,4 +25,44 @@ namespace VulkanRenderer
 
 		static std::array<VkVertexInputAttributeDescription, 4> GetAttributeDescriptions();
 	};
+
+	// GPU side vertex layouts, MeshPrimitive picks the smallest one that can represent its vertices
+	enum class VertexFormat
+	{
+		Float,
+		Quantized,
+		QuantizedSharedTexCoord,
+		Count
+	};
+
+	// Positions as unorm16 within the primitive bounds, texcoords as half floats
+	struct QuantizedVertex
+	{
+		uint16_t position[4];
+		uint16_t baseColorTexCoord[2];
+		uint16_t metallicRoughnessTexCoord[2];
+		uint16_t normalTexCoord[2];
+	};
+
+	// Same as QuantizedVertex when every material texture samples the same texcoord set
+	struct QuantizedSharedTexCoordVertex
+	{
+		uint16_t position[4];
+		uint16_t texCoord[2];
+	};
+
+	// Maps quantized positions back to object space, pushed per primitive
+	struct VertexDequantization
+	{
+		glm::vec4 positionOffset = glm::vec4(0.0f);
+		glm::vec4 positionScale = glm::vec4(1.0f);
+	};
+
+	uint32_t GetVertexStride(VertexFormat format);
+
+	VkVertexInputBindingDescription GetVertexBindingDescription(VertexFormat format);
+	std::array<VkVertexInputAttributeDescription, 4> GetVertexAttributeDescriptions(VertexFormat format);
+
+	// Picks the most compact format the vertices survive and packs them into outData
+	VertexFormat EncodeVertices(const std::vector<Vertex>& vertices, std::vector<uint8_t>& outData, VertexDequantization& outDequantization);
 }
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <ImGui/ImGuiWindow.h>
+
+namespace VulkanRenderer
+{
+	class VulkanGpuProfiler;
+
+	class GpuProfilerWindow : public ImGuiWindow
+	{
+	public:
+		GpuProfilerWindow(VulkanGpuProfiler* profiler, bool open = false);
+
+	protected:
+		void OnRender() override;
+
+		VulkanGpuProfiler* m_Profiler = nullptr;
+
+		int m_MaxDrawsShown = 32;
+	};
+}
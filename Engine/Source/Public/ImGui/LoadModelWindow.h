@@ -13,7 +13,9 @@ namespace VulkanRenderer
 
 	protected:
 		void OnRender() override;
+
+		void RenderPendingLoads();
 		
 		ModelManager* m_ModelManager = nullptr;
 	};
-}
\ No newline at end of file
+}
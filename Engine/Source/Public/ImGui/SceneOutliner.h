@@ -19,7 +19,7 @@ namespace VulkanRenderer
 	protected:
 		void OnRender() override;
 		
-		void SceneOutliner::DrawSceneNode(SceneObject* object);
+		void DrawSceneNode(SceneObject* object);
 
 		Scene* m_Scene = nullptr;
 		VulkanImGuiOverlay* m_Overlay = nullptr;
@@ -13,16 +13,16 @@ namespace VulkanRenderer
 		~VulkanDescriptorSetLayoutManager();
 
 		VkDescriptorSetLayout GetCameraDescriptorSetLayout() const;
-		VkDescriptorSetLayout GetMeshDescriptorSetLayout() const;
+		VkDescriptorSetLayout GetInstanceDescriptorSetLayout() const;
 		VkDescriptorSetLayout GetMaterialDescriptorSetLayout() const;
 
 	private:
 		void CreateCameraDescriptorSetLayout();
-		void CreateMeshDescriptorSetLayout();
+		void CreateInstanceDescriptorSetLayout();
 		void CreateMaterialDescriptorSetLayout();
 
 		VkDescriptorSetLayout cameraDescriptorSetLayout;
-		VkDescriptorSetLayout meshDescriptorSetLayout;
+		VkDescriptorSetLayout instanceDescriptorSetLayout;
 		VkDescriptorSetLayout materialDescriptorSetLayout;
 
 		VulkanDevice* device;
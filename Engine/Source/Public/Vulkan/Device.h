@@ -12,6 +12,8 @@
 
 namespace VulkanRenderer
 {
+	class VulkanSamplerCache;
+
 	class VulkanDevice
 	{
 	public:
@@ -26,8 +28,22 @@ namespace VulkanRenderer
 		VkDevice GetLogical() const;
 		VkPhysicalDevice GetPhysical() const;
 
+		// Queried once when the physical device is selected
+		const VkPhysicalDeviceProperties& GetProperties() const;
+
+		// Shared by every texture, samplers are destroyed with the device
+		VulkanSamplerCache* GetSamplerCache() const;
+
 		VmaAllocator GetAllocator() const;
 
+		// BC1-BC7 sampled images, enabled whenever the physical device supports them
+		bool SupportsTextureCompressionBC() const;
+
+		// Non-zero firstInstance in indirect draws, which GPU-driven culling draws with
+		bool SupportsDrawIndirectFirstInstance() const;
+
+		VkCommandPool GetCommandPool() const;
+
 		std::vector<VkCommandBuffer> commandBuffers;
 
 		VkQueue graphicsQueue;
@@ -38,14 +54,20 @@ namespace VulkanRenderer
 	private:
 		VkDevice logicalDevice;
 		VkPhysicalDevice physicalDevice;
+		VkPhysicalDeviceProperties properties{};
 
 		VkInstance instance;
 		VkSurfaceKHR surface;
 
 		VmaAllocator allocator;
 
+		bool textureCompressionBC = false;
+		bool drawIndirectFirstInstance = false;
+
 		VkCommandPool commandPool;
 
+		VulkanSamplerCache* samplerCache = nullptr;
+
 		void SelectPhysicalDevice();
 		void CreateLogicalDevice();
 
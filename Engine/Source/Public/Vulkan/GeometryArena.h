@@ -0,0 +1,79 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <cstdint>
+
+#include <volk.h>
+
+namespace VulkanRenderer
+{
+	class VulkanDevice;
+	class VulkanBuffer;
+	class VulkanUploadBatch;
+
+	// A primitive's slice of the shared vertex and index buffers
+	struct GeometryAllocation
+	{
+		uint32_t block = UINT32_MAX;
+
+		VkDeviceSize vertexByteOffset = 0;
+		VkDeviceSize vertexByteSize = 0;
+		VkDeviceSize indexByteOffset = 0;
+		VkDeviceSize indexByteSize = 0;
+
+		// Values for vkCmdDrawIndexed
+		int32_t vertexOffset = 0;
+		uint32_t firstIndex = 0;
+		uint32_t indexCount = 0;
+
+		VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+
+		bool IsValid() const { return block != UINT32_MAX; }
+	};
+
+	// Suballocates every primitive's geometry out of a few large device-local vertex and index buffers
+	class VulkanGeometryArena
+	{
+	public:
+		VulkanGeometryArena(VulkanDevice* device, VkDeviceSize vertexBlockSize = 64 * 1024 * 1024, VkDeviceSize indexBlockSize = 32 * 1024 * 1024);
+		~VulkanGeometryArena();
+
+		// Reserves space and records the copies into the batch, vertices are aligned to their stride and indices to their size
+		GeometryAllocation Allocate(VulkanUploadBatch* uploadBatch, const void* vertices, VkDeviceSize vertexStride, uint32_t vertexCount, const void* indices, VkIndexType indexType, uint32_t indexCount);
+		void Free(const GeometryAllocation& allocation);
+
+		VkBuffer GetVertexBuffer(uint32_t block) const;
+		VkBuffer GetIndexBuffer(uint32_t block) const;
+
+		size_t GetBlockCount() const;
+
+	private:
+		// First-fit free list of byte ranges keyed by offset
+		struct RangeAllocator
+		{
+			std::map<VkDeviceSize, VkDeviceSize> freeRanges;
+
+			bool Allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset);
+			void Free(VkDeviceSize offset, VkDeviceSize size);
+		};
+
+		struct Block
+		{
+			VulkanBuffer* vertexBuffer = nullptr;
+			VulkanBuffer* indexBuffer = nullptr;
+
+			RangeAllocator vertexRanges;
+			RangeAllocator indexRanges;
+		};
+
+		VulkanDevice* device;
+
+		VkDeviceSize vertexBlockSize;
+		VkDeviceSize indexBlockSize;
+
+		std::vector<Block> blocks;
+
+		uint32_t CreateBlock(VkDeviceSize vertexSize, VkDeviceSize indexSize);
+	};
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include <volk.h>
+
+namespace VulkanRenderer
+{
+	class VulkanDevice;
+	class VulkanBuffer;
+	class VulkanInstanceBuffer;
+	class MeshInstance;
+	class MeshPrimitive;
+	struct RenderItem;
+	struct Frustum;
+
+	// Instances of one primitive, drawn with a single indirect instanced draw.
+	// Each batch owns one indirect command and a range of the draw instance list large enough for all of its instances.
+	struct GpuDrawBatch
+	{
+		MeshPrimitive* primitive = nullptr;
+
+		// First instance of the batch and the primitive's index in its mesh, only used to name the draw when profiling
+		MeshInstance* meshInstance = nullptr;
+		uint32_t primitiveIndex = 0;
+
+		uint32_t firstInstance = 0;
+		uint32_t maxInstanceCount = 0;
+	};
+
+	// Frustum culls render items in a compute pass, appending survivors to their batch's instance range and bumping its instance count.
+	// Draw records only change when the items do, so a steady frame costs one dispatch plus one indirect draw per batch.
+	class VulkanGpuCulling
+	{
+	public:
+		VulkanGpuCulling(VulkanDevice* device, VkDescriptorSetLayout instanceDescriptorSetLayout, VkDescriptorPool descriptorPool);
+		~VulkanGpuCulling();
+
+		// Regroups the items into batches when the list has grown since the last call, the scene only ever appends to it
+		void SetRenderItems(const std::vector<RenderItem>& renderItems);
+
+		// Resets the frame's commands and culls every record against the frustum, must be recorded outside a render pass
+		void Dispatch(VkCommandBuffer commandBuffer, uint32_t frame, const Frustum& frustum, VulkanInstanceBuffer* instanceBuffer);
+
+		const std::vector<GpuDrawBatch>& GetBatches() const;
+
+		// One VkDrawIndexedIndirectCommand per batch
+		VkBuffer GetDrawCommandBuffer(uint32_t frame) const;
+
+		// Instance layout set over the scene's matrices and this pass's draw instance list
+		VkDescriptorSet GetInstanceDescriptorSet(uint32_t frame) const;
+
+	private:
+		// Matches DrawRecord in Cull.comp
+		struct alignas(16) DrawRecord
+		{
+			glm::vec4 boundingSphere;
+			uint32_t instanceIndex;
+			uint32_t batchIndex;
+			uint32_t firstInstance;
+			uint32_t padding;
+		};
+
+		struct FrameBuffers
+		{
+			std::unique_ptr<VulkanBuffer> records;
+			std::unique_ptr<VulkanBuffer> drawInstances;
+
+			// Commands with no instances, copied over the drawn ones before every dispatch
+			std::unique_ptr<VulkanBuffer> commandTemplates;
+			std::unique_ptr<VulkanBuffer> commands;
+
+			DrawRecord* mappedRecords = nullptr;
+			VkDrawIndexedIndirectCommand* mappedCommandTemplates = nullptr;
+			size_t recordCapacity = 0;
+			size_t batchCapacity = 0;
+
+			// Records are uploaded again whenever they were rebuilt since this frame slot last ran
+			uint64_t generation = 0;
+
+			VkDescriptorSet cullDescriptorSet = VK_NULL_HANDLE;
+			VkDescriptorSet instanceDescriptorSet = VK_NULL_HANDLE;
+			VkBuffer boundInstanceBuffer = VK_NULL_HANDLE;
+		};
+
+		VulkanDevice* device;
+
+		VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+		VkPipeline pipeline = VK_NULL_HANDLE;
+
+		std::vector<FrameBuffers> frames;
+
+		std::vector<DrawRecord> records;
+		std::vector<VkDrawIndexedIndirectCommand> commandTemplates;
+		std::vector<GpuDrawBatch> batches;
+
+		size_t builtItemCount = 0;
+		uint64_t generation = 0;
+
+		void CreateDescriptorSetLayout();
+		void CreateComputePipeline();
+		void CreateDescriptorSets(VkDescriptorSetLayout instanceDescriptorSetLayout, VkDescriptorPool descriptorPool);
+
+		void UploadRecords(uint32_t frame);
+		void WriteDescriptorSets(uint32_t frame, VkBuffer instanceBuffer);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+
+#include <volk.h>
+
+namespace VulkanRenderer
+{
+	class VulkanDevice;
+
+	enum class GpuPass
+	{
+		Cull,
+		Opaque,
+		Transparent,
+		ImGui,
+		Count
+	};
+
+	struct GpuDrawTiming
+	{
+		std::string name;
+		double milliseconds = 0.0;
+	};
+
+	// GPU time of one completed frame, in milliseconds
+	struct GpuTimings
+	{
+		std::array<double, static_cast<size_t>(GpuPass::Count)> passes{};
+		double total = 0.0;
+
+		std::vector<GpuDrawTiming> draws;
+
+		bool valid = false;
+	};
+
+	class VulkanGpuProfiler
+	{
+	public:
+		VulkanGpuProfiler(VulkanDevice* device, uint32_t maxDraws = 4096);
+		~VulkanGpuProfiler();
+
+		bool IsSupported() const;
+
+		// Reads back the results this frame slot produced last time and resets its queries, must be recorded outside a render pass
+		void BeginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+		void BeginPass(VkCommandBuffer commandBuffer, GpuPass pass);
+		void EndPass(VkCommandBuffer commandBuffer, GpuPass pass);
+
+		bool IsPerDrawTimingEnabled() const;
+		void SetPerDrawTimingEnabled(bool enabled);
+
+		void BeginDraw(VkCommandBuffer commandBuffer, const std::string& name);
+		void EndDraw(VkCommandBuffer commandBuffer);
+
+		// Results lag the current frame by the number of frames in flight
+		const GpuTimings& GetLastTimings() const;
+
+		static const char* GetPassName(GpuPass pass);
+
+	private:
+		struct FrameQueries
+		{
+			VkQueryPool queryPool = VK_NULL_HANDLE;
+
+			std::array<bool, static_cast<size_t>(GpuPass::Count)> passesWritten{};
+			std::vector<std::string> drawNames;
+
+			bool pending = false;
+		};
+
+		VulkanDevice* device;
+
+		std::vector<FrameQueries> frames;
+		uint32_t currentFrame = 0;
+
+		uint32_t maxDraws;
+
+		// Nanoseconds per timestamp tick
+		double timestampPeriod = 0.0;
+		uint64_t timestampMask = 0;
+
+		bool supported = false;
+		bool perDrawTimingEnabled = false;
+
+		GpuTimings lastTimings;
+
+		void CreateQueryPools();
+		void ReadResults(FrameQueries& frame);
+
+		double TicksToMilliseconds(uint64_t begin, uint64_t end) const;
+	};
+}
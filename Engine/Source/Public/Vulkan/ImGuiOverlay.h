@@ -8,7 +8,7 @@
 #include <ImGui/ImGuiWindow.h>
 
 #include <volk.h>
-#include <glfw/glfw3.h>
+#include <GLFW/glfw3.h>
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -24,11 +24,12 @@ namespace VulkanRenderer
 	class SceneObject;
 	class Scene;
 	class ModelManager;
+	class VulkanGpuProfiler;
 	
 	class VulkanImGuiOverlay
 	{
 	public:
-		VulkanImGuiOverlay(VulkanInstance* instance, VulkanDevice* device, VulkanSwapChain* swapChain, VulkanRenderPass* renderPass, GLFWwindow* glfwWindow, Scene* scene, ModelManager* modelManager);
+		VulkanImGuiOverlay(VulkanInstance* instance, VulkanDevice* device, VulkanSwapChain* swapChain, VulkanRenderPass* renderPass, GLFWwindow* glfwWindow, Scene* scene, ModelManager* modelManager, VulkanGpuProfiler* gpuProfiler);
 		~VulkanImGuiOverlay();
 
 		SceneObject* GetSelectedObject() const;
@@ -41,6 +42,8 @@ namespace VulkanRenderer
 	private:
 		GLFWwindow* m_Window;
 
+		Scene* m_Scene;
+
 		std::unique_ptr<ImGuiDescriptorPool> m_DescriptorPool;
 
 		SceneObject* m_SelectedObject = nullptr;
@@ -48,6 +51,9 @@ namespace VulkanRenderer
 		std::unordered_map<std::string, std::unique_ptr<ImGuiWindow>> m_Windows;
 		
 		void NewFrame();
+
+		// Selects the mesh instance under the cursor on a click that no window took
+		void PickObject();
 		void Draw(VkCommandBuffer commandBuffer);
 	};
 }
\ No newline at end of file
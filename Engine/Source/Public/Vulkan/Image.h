@@ -9,22 +9,34 @@ namespace VulkanRenderer
 	class VulkanImage
 	{
 	public:
-		VulkanImage(VulkanDevice* device, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags, VkImageAspectFlags aspectFlags);
+		VulkanImage(VulkanDevice* device, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1, VkComponentMapping components = {});
 		VulkanImage(VulkanDevice* device, VkImage existingImage, VkFormat format, VkImageAspectFlags aspectFlags);
 		~VulkanImage();
 
 		VkImage Get() const;
 		VkImageView GetImageView() const;
+		uint32_t GetMipLevels() const;
 
-		void CreateImageView(VkImageAspectFlags aspectFlags);
+		// Linear blits between levels need both blit usages and linear filtering in optimal tiling
+		static bool CanGenerateMipmaps(VulkanDevice* device, VkFormat format);
+
+		void CreateImageView(VkImageAspectFlags aspectFlags, VkComponentMapping components = {});
 
 		void TransitionImageLayout(VkImageLayout newLayout);
+		void TransitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout);
+
+		// Expects the first uploadedLevels levels in TRANSFER_DST, blits the rest down from the last one and leaves the whole chain shader readable
+		void GenerateMipmaps(VkCommandBuffer commandBuffer, uint32_t uploadedLevels);
 
 	private:
 		VkImage image;
 		VkImageLayout currentLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 		VkFormat format;
 
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipLevels = 1;
+
 		VkImageView imageView;
 		VkDeviceMemory memory;
 
@@ -32,6 +44,6 @@ namespace VulkanRenderer
 
 		bool ownsImage;
 
-		void CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags, VkImage& image, VkDeviceMemory& imageMemory);
+		void CreateImage(VkFormat format, VkImageTiling tiling, VkImageUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags, VkImage& image, VkDeviceMemory& imageMemory);
 	};
 }
\ No newline at end of file
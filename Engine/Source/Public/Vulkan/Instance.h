@@ -23,10 +23,10 @@ namespace VulkanRenderer
 
 		VkDebugUtilsMessengerEXT debugMessenger = VK_NULL_HANDLE;
 
-		void CreateInstance();
+		void CreateInstance(bool enableSurface);
 		void CreateSurface(GLFWwindow* window);
 
-		std::vector<const char*> GetRequiredExtensions();
+		std::vector<const char*> GetRequiredExtensions(bool enableSurface);
 
 		void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
 
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include <glm/glm.hpp>
+
+#include <volk.h>
+
+namespace VulkanRenderer
+{
+	class VulkanDevice;
+	class VulkanBuffer;
+
+	// Points a set of the instance layout at world matrices and a draw instance list, GPU culling pairs the scene's matrices with a list of its own
+	void WriteInstanceDescriptorSet(VulkanDevice* device, VkDescriptorSet descriptorSet, VkBuffer matrixBuffer, VkBuffer drawInstanceBuffer);
+
+	// World matrices of every mesh instance in one host-visible storage buffer per frame in flight, bound once per pass.
+	// Instanced draws look their matrices up through a per-frame list of instance indices, so no instance needs buffers or descriptor sets of its own.
+	class VulkanInstanceBuffer
+	{
+	public:
+		VulkanInstanceBuffer(VulkanDevice* device, VkDescriptorSetLayout descriptorSetLayout, VkDescriptorPool descriptorPool);
+		~VulkanInstanceBuffer();
+
+		// Grows the frame's buffer to hold at least count matrices. Returns true when it was reallocated, which loses its contents.
+		// Only safe once the frame's previous submission has completed.
+		bool Reserve(uint32_t frame, size_t count);
+
+		// Same for the list of instance indices the frame's draws read, which is rewritten every frame
+		void ReserveDrawInstances(uint32_t frame, size_t count);
+
+		glm::mat4* GetMatrices(uint32_t frame) const;
+		uint32_t* GetDrawInstances(uint32_t frame) const;
+
+		VkBuffer Get(uint32_t frame) const;
+		VkDescriptorSet GetDescriptorSet(uint32_t frame) const;
+
+	private:
+		struct FrameBuffer
+		{
+			std::unique_ptr<VulkanBuffer> buffer;
+			glm::mat4* matrices = nullptr;
+			size_t capacity = 0;
+
+			std::unique_ptr<VulkanBuffer> drawInstanceBuffer;
+			uint32_t* drawInstances = nullptr;
+			size_t drawInstanceCapacity = 0;
+
+			VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+		};
+
+		VulkanDevice* device;
+
+		std::vector<FrameBuffer> frames;
+
+		void CreateDescriptorSets(VkDescriptorSetLayout descriptorSetLayout, VkDescriptorPool descriptorPool);
+		void WriteDescriptorSet(uint32_t frame);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+#include <volk.h>
+
+namespace VulkanRenderer
+{
+	class VulkanDevice;
+	class VulkanImage;
+
+	class VulkanOffscreenTarget
+	{
+	public:
+		VulkanOffscreenTarget(VulkanDevice* device, VkExtent2D extent);
+		~VulkanOffscreenTarget();
+
+		VkFramebuffer GetFramebuffer() const;
+
+		void CreateFramebuffer(VkRenderPass renderPass);
+
+		// Copies the color attachment back to the host as tightly packed RGBA8 rows
+		bool ReadPixels(std::vector<uint8_t>& outPixels);
+
+		VkExtent2D extent;
+
+		VkFormat imageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+	private:
+		VulkanImage* colorImage = nullptr;
+		VulkanImage* depthImage = nullptr;
+
+		VkFramebuffer framebuffer = VK_NULL_HANDLE;
+
+		VulkanDevice* device;
+
+		void CreateImages();
+	};
+}
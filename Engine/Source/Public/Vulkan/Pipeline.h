@@ -2,9 +2,12 @@
 
 #include <vector>
 #include <memory>
+#include <array>
 
 #include <volk.h>
 
+#include <Core/Vertex.h>
+
 namespace VulkanRenderer
 {
 	class VulkanDevice;
@@ -13,6 +16,11 @@ namespace VulkanRenderer
 	class MeshInstance;
 	class Mesh;
 	class Camera;
+	class VulkanGpuProfiler;
+	class VulkanGeometryArena;
+	class VulkanGpuCulling;
+	class MeshPrimitive;
+	struct InstancedDraw;
 	
 	enum class PipelineType
 	{
@@ -28,12 +36,29 @@ namespace VulkanRenderer
 
 		void SetDescriptorPool(VkDescriptorPool pool);
 		
-		void Render(VkCommandBuffer commandBuffer, uint32_t currentFrame, const std::vector<MeshInstance*>& mesheInstances, Camera* camera);
+		// One instanced draw per entry, reading instance indices from the draw instance list bound with the instance set
+		void Render(VkCommandBuffer commandBuffer, uint32_t currentFrame, const std::vector<InstancedDraw>& draws, Camera* camera, VkDescriptorSet instanceDescriptorSet, VulkanGeometryArena* geometryArena, VulkanGpuProfiler* profiler = nullptr);
+
+		// One indirect instanced draw per batch, consuming the commands and instance lists the culling pass wrote this frame
+		void RenderIndirect(VkCommandBuffer commandBuffer, uint32_t currentFrame, const VulkanGpuCulling* gpuCulling, Camera* camera, VulkanGeometryArena* geometryArena, VulkanGpuProfiler* profiler = nullptr);
 
 	private:
+		// What is bound so far while recording a pass, so consecutive draws only rebind what differs
+		struct BindState
+		{
+			VertexFormat format = VertexFormat::Count;
+			uint32_t block = UINT32_MAX;
+			VkIndexType indexType = VK_INDEX_TYPE_MAX_ENUM;
+			MeshPrimitive* primitive = nullptr;
+		};
+
 		void CreateGraphicsPipeline(VulkanDescriptorSetLayoutManager* layoutManager);
 
-		VkPipeline pipeline;
+		void BindFrameDescriptorSets(VkCommandBuffer commandBuffer, uint32_t currentFrame, Camera* camera, VkDescriptorSet instanceDescriptorSet);
+		void BindPrimitive(VkCommandBuffer commandBuffer, uint32_t currentFrame, MeshPrimitive* primitive, VulkanGeometryArena* geometryArena, BindState& state);
+
+		// One pipeline per vertex format, they only differ in vertex input state
+		std::array<VkPipeline, static_cast<size_t>(VertexFormat::Count)> pipelines{};
 		VkPipelineLayout pipelineLayout;
 		
 		VkDescriptorPool descriptorPool;
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <unordered_map>
+
+#include <volk.h>
+
+namespace VulkanRenderer
+{
+	class VulkanDevice;
+
+	// Deduplicates samplers by their create info, samplers live until the cache is destroyed
+	class VulkanSamplerCache
+	{
+	public:
+		VulkanSamplerCache(VulkanDevice* device);
+		~VulkanSamplerCache();
+
+		// pNext chains are not part of the key and must be null
+		VkSampler GetSampler(const VkSamplerCreateInfo& createInfo);
+
+		size_t GetSamplerCount() const;
+
+	private:
+		using SamplerKey = std::array<uint8_t, sizeof(VkSamplerCreateInfo)>;
+
+		struct SamplerKeyHash
+		{
+			size_t operator()(const SamplerKey& key) const;
+		};
+
+		VulkanDevice* device;
+
+		std::unordered_map<SamplerKey, VkSampler, SamplerKeyHash> samplers;
+		mutable std::mutex mutex;
+	};
+}
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
 
 #include <volk.h>
 
@@ -9,6 +10,7 @@ namespace VulkanRenderer
 {
 	class VulkanDevice;
 	class VulkanImage;
+	class VulkanUploadBatch;
 
 	enum class TextureType
 	{
@@ -19,30 +21,77 @@ namespace VulkanRenderer
 		Occlusion
 	};
 	
+	// Layout of texture data in memory and on the GPU, block formats store 4x4 texel blocks
+	enum class TextureFormat : uint32_t
+	{
+		RGBA8,
+		BC1,
+		BC5,
+		BC7,
+		Count
+	};
+
+	// Texture data with every mip level packed back to back
+	struct TextureInfo
+	{
+		const uint8_t* data = nullptr;
+
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipLevels = 1;
+
+		TextureFormat format = TextureFormat::RGBA8;
+		bool sRGB = true;
+
+		// Maps stored channels to the ones shaders sample, identity by default
+		VkComponentMapping components{};
+	};
+
+	// Decoded pixels, or pre-built block compressed levels packed back to back
 	struct ImageData
 	{
 		std::vector<uint8_t> pixels;
 		int width = 0, height = 0, channels = 0;
+
+		uint32_t mipLevels = 1;
+		TextureFormat format = TextureFormat::RGBA8;
+
+		// Hash of the encoded source bytes, zero when unknown
+		uint64_t contentHash = 0;
 	};
 	
 	class VulkanTexture
 	{
 	public:
 		VulkanTexture(VulkanDevice* device, const std::string& path);
-		VulkanTexture(VulkanDevice* device, const unsigned char* pixels, int width, int height, bool sRGB = true);
+		// Records the upload into the batch when given, otherwise uploads and waits immediately
+		VulkanTexture(VulkanDevice* device, const unsigned char* pixels, int width, int height, bool sRGB = true, VulkanUploadBatch* uploadBatch = nullptr);
+		// RGBA8 textures missing levels of the full chain get them generated on upload, block formats are uploaded as given
+		VulkanTexture(VulkanDevice* device, const TextureInfo& info, VulkanUploadBatch* uploadBatch = nullptr);
 		~VulkanTexture();
 
 		VkImageView GetImageView() const;
 		VkSampler GetSampler() const;
 
+		// Swaps in an image built from info and returns the previous one, which must stay alive until no frame in flight samples it
+		VulkanImage* Recreate(const TextureInfo& info, VulkanUploadBatch* uploadBatch);
+
+		// Bumped whenever the image view changes so descriptor sets know to rewrite it
+		uint32_t GetGeneration() const;
+
+		// Index of the texture's record in the texture streamer, -1 when it is not streamed. Only the streamer writes it.
+		int32_t streamingSlot = -1;
+
 	private:
-		VulkanImage* image;
+		VulkanImage* image = nullptr;
+		uint32_t generation = 0;
+		// Owned by the device's sampler cache
 		VkSampler sampler;
 
 		VulkanDevice* device;
 
 		void CreateTextureImage(const std::string& path);
-		void CreateTextureImage(const unsigned char* pixels, int width, int height, bool sRGB);
+		void CreateTextureImage(const TextureInfo& info, VulkanUploadBatch* uploadBatch);
 		void CreateTextureSampler();
 	};
 }
\ No newline at end of file
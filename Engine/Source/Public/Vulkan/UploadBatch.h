@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+
+#include <volk.h>
+
+#include <Vulkan/Texture.h>
+
+namespace VulkanRenderer
+{
+	class VulkanDevice;
+	class VulkanBuffer;
+	class VulkanImage;
+
+	// Records many staging copies and layout transitions into one command buffer that is submitted once and tracked by a fence
+	class VulkanUploadBatch
+	{
+	public:
+		VulkanUploadBatch(VulkanDevice* device, VkDeviceSize stagingBlockSize = 32 * 1024 * 1024);
+		~VulkanUploadBatch();
+
+		VkCommandBuffer GetCommandBuffer() const;
+
+		void UploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+
+		// Transitions the image to transfer destination, copies the pixels and leaves it ready for sampling
+		// data holds mipLevels levels back to back, any further levels of the image are blitted down from the last one
+		void UploadImage(VulkanImage* image, const void* data, VkDeviceSize size, uint32_t width, uint32_t height, uint32_t mipLevels = 1, TextureFormat format = TextureFormat::RGBA8);
+
+		// Total staging memory used by the recorded uploads
+		VkDeviceSize GetStagingSize() const;
+
+		bool IsEmpty() const;
+		bool IsSubmitted() const;
+
+		void Submit();
+		bool IsComplete() const;
+		void Wait() const;
+
+		void SubmitAndWait();
+
+	private:
+		struct StagingBlock
+		{
+			VulkanBuffer* buffer = nullptr;
+			uint8_t* mappedData = nullptr;
+			VkDeviceSize size = 0;
+			VkDeviceSize offset = 0;
+		};
+
+		VulkanDevice* device;
+
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		VkFence fence = VK_NULL_HANDLE;
+
+		std::vector<StagingBlock> stagingBlocks;
+		VkDeviceSize stagingBlockSize;
+		VkDeviceSize stagingSize = 0;
+
+		bool recorded = false;
+		bool submitted = false;
+
+		// Copies data into staging memory, returning the buffer and offset to copy from
+		VkBuffer Stage(const void* data, VkDeviceSize size, VkDeviceSize& outOffset);
+	};
+}
@@ -0,0 +1,21 @@
+project "zstd"
+	kind "StaticLib"
+	language "C"
+	staticruntime "Off"
+
+	targetdir ("%{wks.location}/out/bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("%{wks.location}/out/obj/" .. outputdir .. "/%{prj.name}")
+
+	-- Only the decompressor is vendored, the x86-64 Huffman assembly is replaced by its C fallback
+	defines { "ZSTD_DISABLE_ASM" }
+
+	files
+	{
+		"lib/**.h",
+		"lib/**.c"
+	}
+
+	includedirs
+	{
+		"lib"
+	}
@@ -24,7 +24,8 @@ project "Engine"
 		"Vendor/glm",
 		"Vendor/stb",
 		"Vendor/fastgltf/include",
-		"Vendor/imgui"
+		"Vendor/imgui",
+		"Vendor/zstd/lib"
 	}
 
-	links { "glfw", "fastgltf", "imgui" }
+	links { "glfw", "fastgltf", "imgui", "zstd" }
@@ -23,9 +23,11 @@ group "Dependencies"
 	include "Engine/Vendor/glfw"
 	include "Engine/Vendor/fastgltf"
 	include "Engine/vendor/imgui"
+	include "Engine/Vendor/zstd"
 group ""
 
 group "VulkanRenderer"
 	include "Engine"
 	include "App"
+	include "Benchmark"
 group ""